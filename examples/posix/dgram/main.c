@@ -0,0 +1,210 @@
+/*****************************************************************************
+* Product: Batched datagram receive over loopback, POSIX
+* Last updated for version 5.8.2
+* Last updated on  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+*****************************************************************************/
+#include "qpc.h"
+#include "qf_fdwatch.h" /* file-descriptor watcher of the POSIX port */
+#include "qf_dgram.h"   /* batched datagram receiver of the POSIX port */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+Q_DEFINE_THIS_FILE
+
+enum DgramSignals {
+    RX_READY_SIG = Q_USER_SIG, /* the socket became readable */
+    DGRAM_SIG,                 /* a datagram has been received */
+    IDLE_TIMEOUT_SIG,          /* no datagrams for a while */
+    MAX_SIG
+};
+
+enum {
+    N_DGRAMS     = 200000U, /* datagrams sent by the sender thread */
+    PAYLOAD_SIZE = 64U,     /* payload size of the datagrams */
+    RX_BATCH     = 32U,     /* datagrams received per recvmmsg() */
+    IDLE_TICKS   = 50U      /* idle ticks after which the test ends */
+};
+
+/* the Sink active object ..................................................*/
+typedef struct {
+    QActive super;
+    QFdWatch rxWatch;  /* readiness of the socket */
+    QDgramRx rx;       /* batched receiver */
+    QTimeEvt idleEvt;  /* the test is over when no data arrives */
+    uint32_t nRecv;    /* # datagrams received */
+    uint32_t nCalls;   /* # recvmmsg() calls made */
+    uint32_t nextSeq;  /* the next expected sequence number */
+    uint32_t nOutOfSeq;/* # datagrams received out of sequence */
+} Sink;
+
+static Sink l_sink;
+static int l_rxSock;
+static int l_txSock;
+static struct sockaddr_in l_addr;
+
+static QState Sink_initial(Sink * const me, QEvt const * const e);
+static QState Sink_active(Sink * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static QState Sink_initial(Sink * const me, QEvt const * const e) {
+    (void)e;
+    Q_ALLEGE(QFdWatch_add(&me->rxWatch, l_rxSock, QF_FD_READ));
+    QTimeEvt_armX(&me->idleEvt, 5U*IDLE_TICKS, 0U);
+    return Q_TRAN(&Sink_active);
+}
+/*..........................................................................*/
+static QState Sink_active(Sink * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case RX_READY_SIG: {
+            /* one batch per readiness report, so that the received
+            * datagrams get processed before the next batch arrives
+            */
+            if (QDGRAMRX_RECV(&me->rx, me) > 0) {
+                ++me->nCalls;
+            }
+            QFdWatch_rearm(&me->rxWatch); /* level-triggered watch */
+            status = Q_HANDLED();
+            break;
+        }
+        case DGRAM_SIG: {
+            QDgramEvt const *dg = (QDgramEvt const *)e;
+            uint32_t seq;
+            Q_ASSERT((dg->len == PAYLOAD_SIZE) && (!dg->isTrunc));
+            memcpy(&seq, &dg->payload[0], sizeof(seq));
+            if (seq != me->nextSeq) {
+                ++me->nOutOfSeq;
+            }
+            me->nextSeq = seq + 1U;
+            ++me->nRecv;
+            QTimeEvt_rearm(&me->idleEvt, IDLE_TICKS);
+            status = Q_HANDLED();
+            break;
+        }
+        case IDLE_TIMEOUT_SIG: {
+            printf("received %u of %u datagrams (%u out of sequence)\n"
+                   "recvmmsg() calls: %u, datagrams per call: %.1f\n",
+                   (unsigned)me->nRecv, (unsigned)N_DGRAMS,
+                   (unsigned)me->nOutOfSeq, (unsigned)me->nCalls,
+                   (me->nCalls != 0U)
+                       ? (double)me->nRecv / (double)me->nCalls : 0.0);
+            QF_stop();
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+
+/* the sender thread .......................................................*/
+static void *sender(void *par) {
+    uint8_t buf[PAYLOAD_SIZE];
+    uint32_t seq;
+
+    (void)par;
+    memset(buf, 0, sizeof(buf));
+    usleep(100000U); /* let the Sink start watching the socket */
+    for (seq = 0U; seq < N_DGRAMS; ++seq) {
+        memcpy(buf, &seq, sizeof(seq));
+        (void)sendto(l_txSock, buf, sizeof(buf), 0,
+                     (struct sockaddr const *)&l_addr, sizeof(l_addr));
+        if ((seq & 0x3FU) == 0U) {
+            usleep(50U); /* pace the sender, UDP has no flow control */
+        }
+    }
+    return (void *)0;
+}
+
+/* QF callbacks ............................................................*/
+void QF_onStartup(void) {
+    pthread_t thread;
+    QF_setTickRate(100U);
+    Q_ALLEGE(pthread_create(&thread, (pthread_attr_t *)0, &sender,
+                            (void *)0) == 0);
+    pthread_detach(thread);
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+    QF_TICK_X(0U, (void *)0);
+}
+/*..........................................................................*/
+void Q_onAssert(char const *module, int loc) {
+    fprintf(stderr, "Assertion failed in %s, loc %d\n", module, loc);
+    exit(-1);
+}
+
+/*..........................................................................*/
+int main() {
+    static QEvt const *sinkQueueSto[4U*RX_BATCH];
+    static QF_MPOOL_EL(uint8_t[sizeof(QDgramEvt) + PAYLOAD_SIZE])
+        dgramPoolSto[4U*RX_BATCH];
+    socklen_t len = (socklen_t)sizeof(l_addr);
+    int rcvBuf = 4*1024*1024;
+
+    /* the receiving socket is bound to an ephemeral loopback port */
+    l_rxSock = socket(AF_INET, SOCK_DGRAM, 0);
+    Q_ALLEGE(l_rxSock >= 0);
+    (void)setsockopt(l_rxSock, SOL_SOCKET, SO_RCVBUF,
+                     &rcvBuf, sizeof(rcvBuf));
+    memset(&l_addr, 0, sizeof(l_addr));
+    l_addr.sin_family = AF_INET;
+    l_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    Q_ALLEGE(bind(l_rxSock, (struct sockaddr *)&l_addr, len) == 0);
+    Q_ALLEGE(getsockname(l_rxSock, (struct sockaddr *)&l_addr, &len) == 0);
+    l_txSock = socket(AF_INET, SOCK_DGRAM, 0);
+    Q_ALLEGE(l_txSock >= 0);
+
+    QF_init();
+    QF_poolInit(dgramPoolSto, sizeof(dgramPoolSto), sizeof(dgramPoolSto[0]));
+
+    QActive_ctor(&l_sink.super, Q_STATE_CAST(&Sink_initial));
+    QFdWatch_ctor(&l_sink.rxWatch, &l_sink.super, RX_READY_SIG, QF_FDW_LEVEL);
+    QDgramRx_ctor(&l_sink.rx, l_rxSock, &l_sink.super, DGRAM_SIG,
+                  sizeof(dgramPoolSto[0]), RX_BATCH);
+    QTimeEvt_ctorX(&l_sink.idleEvt, &l_sink.super, IDLE_TIMEOUT_SIG, 0U);
+
+    QACTIVE_START(&l_sink.super, 1U,
+                  sinkQueueSto, Q_DIM(sinkQueueSto),
+                  (void *)0, 0U, (QEvt *)0);
+
+    return QF_run();
+}
@@ -0,0 +1,391 @@
+/*****************************************************************************
+* Product: Warm restart example, POSIX
+* Last updated for version 5.8.2
+* Last updated on  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+*****************************************************************************/
+#include "qpc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef QF_PERSIST
+
+#include "qf_persist.h"
+
+#include <pthread.h>
+#include <sys/stat.h>  /* for mkdir() */
+#include <unistd.h>    /* for _exit() */
+
+Q_DEFINE_THIS_FILE
+
+enum PersistSignals {
+    DATA_SIG = Q_USER_SIG, /* the next data item from the producer */
+    FLIP_SIG,              /* the Counter flipped its state */
+    TICK_SIG,              /* the periodic time event of the Counter */
+    MAX_SIG
+};
+
+enum {
+    N_DATA     = 100000U,  /* the data items counted in the whole test */
+    FLIP_EVERY = 100U,     /* the data items between the state flips */
+    PERIOD_MS  = 10U,      /* the period of the snapshots */
+    CRASH_AFTER = 8U       /* the data items from the snapshot to crash */
+};
+
+typedef struct {
+    QEvt super;
+    uint32_t n;            /* the data item or the number of the flip */
+} SeqEvt;
+
+/* the Counter active object ...............................................*/
+typedef struct {           /* the extended state of the Counter */
+    uint32_t next;         /* the next data item expected */
+    uint64_t sum;          /* the sum of all the data items counted */
+    uint32_t flips;        /* the flips between the even and odd state */
+    uint32_t nDup;         /* the data items received again (ignored) */
+    uint32_t nGaps;        /* the data items skipped (must never happen) */
+    uint32_t ticks;        /* the ticks of the time event */
+} CounterState;
+
+typedef struct {
+    QActive super;
+    QTimeEvt timeEvt;
+    CounterState st;
+} Counter;
+
+static QState Counter_initial (Counter * const me, QEvt const * const e);
+static QState Counter_counting(Counter * const me, QEvt const * const e);
+static QState Counter_even    (Counter * const me, QEvt const * const e);
+static QState Counter_odd     (Counter * const me, QEvt const * const e);
+static bool Counter_flip(Counter * const me, QEvt const * const e);
+
+/* the Monitor active object ...............................................*/
+typedef struct {           /* the extended state of the Monitor */
+    uint32_t last;         /* the number of the last flip received */
+    uint32_t nLost;        /* the flips lost in the crash */
+    uint32_t nDup;         /* the flips received again (must never happen) */
+} MonitorState;
+
+typedef struct {
+    QActive super;
+    MonitorState st;
+} Monitor;
+
+static QState Monitor_initial (Monitor * const me, QEvt const * const e);
+static QState Monitor_watching(Monitor * const me, QEvt const * const e);
+
+static Counter l_counter;
+static Monitor l_monitor;
+static uint32_t l_crashAt; /* the data item to crash at (0 for none) */
+static uint32_t l_first;   /* the first data item of the producer */
+
+static void *producer(void *arg);
+static bool check(char const *when);
+
+/*..........................................................................*/
+static QState Counter_initial(Counter * const me, QEvt const * const e) {
+    (void)e;
+    me->st.next = 1U;
+    QTimeEvt_armX(&me->timeEvt, 1U, 1U);
+    return Q_TRAN(&Counter_even);
+}
+/*..........................................................................*/
+static QState Counter_counting(Counter * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case DATA_SIG: {
+            uint32_t n = ((SeqEvt const *)e)->n;
+            if (n < me->st.next) { /* requeued and then produced again */
+                ++me->st.nDup;
+            }
+            else {
+                if (n > me->st.next) {
+                    ++me->st.nGaps;
+                }
+                me->st.sum += n;
+                if (n + CRASH_AFTER == l_crashAt) {
+                    QF_persistSnapshot(); /* see NOTE2 */
+                }
+                if (n == l_crashAt) { /* in the middle of the dispatch */
+                    printf("crash at the data item %u\n", (unsigned)n);
+                    fflush(stdout);
+                    _exit(3);
+                }
+                me->st.next = n + 1U;
+                if (n == N_DATA) {
+                    QF_stop();
+                }
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        case TICK_SIG: {
+            ++me->st.ticks;
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+/*..........................................................................*/
+static QState Counter_even(Counter * const me, QEvt const * const e) {
+    QState status;
+    if (Counter_flip(me, e)) {
+        status = Q_TRAN(&Counter_odd);
+    }
+    else {
+        status = Q_SUPER(&Counter_counting);
+    }
+    return status;
+}
+/*..........................................................................*/
+static QState Counter_odd(Counter * const me, QEvt const * const e) {
+    QState status;
+    if (Counter_flip(me, e)) {
+        status = Q_TRAN(&Counter_even);
+    }
+    else {
+        status = Q_SUPER(&Counter_counting);
+    }
+    return status;
+}
+
+/*..........................................................................*/
+/* count the data item completing FLIP_EVERY items and notify the Monitor */
+static bool Counter_flip(Counter * const me, QEvt const * const e) {
+    bool isFlip = (e->sig == (QSignal)DATA_SIG)
+                  && (((SeqEvt const *)e)->n == me->st.next)
+                  && ((me->st.next % FLIP_EVERY) == 0U);
+    if (isFlip) {
+        SeqEvt *flip;
+        (void)Counter_counting(me, e);
+        ++me->st.flips;
+        /* not posted again when the journal is replayed */
+        flip = Q_NEW(SeqEvt, FLIP_SIG);
+        flip->n = me->st.flips;
+        QACTIVE_POST(&l_monitor.super, &flip->super, me);
+    }
+    return isFlip;
+}
+
+/*..........................................................................*/
+static QState Monitor_initial(Monitor * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    return Q_TRAN(&Monitor_watching);
+}
+/*..........................................................................*/
+static QState Monitor_watching(Monitor * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case FLIP_SIG: {
+            uint32_t n = ((SeqEvt const *)e)->n;
+            if (n <= me->st.last) { /* posted again by the replay? */
+                ++me->st.nDup;
+            }
+            else {
+                /* the flips posted after the snapshot of the Monitor and
+                * still in its queue at the crash are lost (NOTE3 in
+                * qf_persist.c)
+                */
+                me->st.nLost += n - me->st.last - 1U;
+                me->st.last = n;
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+
+/*..........................................................................*/
+/* the data items from a p-thread outside QF, see NOTE1 */
+static void *producer(void *arg) {
+    uint32_t n = l_first;
+    (void)arg;
+    while (n <= N_DATA) {
+        SeqEvt *e;
+        Q_NEW_X(e, SeqEvt, 4U, DATA_SIG);
+        if (e == (SeqEvt *)0) {
+            sched_yield();
+        }
+        else {
+            e->n = n;
+            if (QACTIVE_POST_X(&l_counter.super, &e->super, 4U, arg)) {
+                ++n;
+            }
+            else {
+                sched_yield();
+            }
+        }
+    }
+    return (void *)0;
+}
+/*..........................................................................*/
+static bool check(char const *when) {
+    uint32_t n = l_counter.st.next - 1U; /* the data items counted */
+    bool isOdd = (l_counter.super.super.state.fun
+                  == Q_STATE_CAST(&Counter_odd));
+    bool ok = (l_counter.st.sum == ((uint64_t)n * (n + 1U)) / 2U)
+              && (l_counter.st.flips == n / FLIP_EVERY)
+              && (isOdd == ((l_counter.st.flips & 1U) != 0U))
+              && (l_counter.st.nGaps == 0U)
+              && (l_monitor.st.nDup == 0U)
+              && (l_monitor.st.last <= l_counter.st.flips);
+
+    printf("%s: counted %u, sum %llu, flips %u (%s), ticks %u, "
+           "duplicates %u, flips lost %u, %s\n",
+           when, (unsigned)n, (unsigned long long)l_counter.st.sum,
+           (unsigned)l_counter.st.flips, isOdd ? "odd" : "even",
+           (unsigned)l_counter.st.ticks, (unsigned)l_counter.st.nDup,
+           (unsigned)l_monitor.st.nLost, ok ? "OK" : "INCONSISTENT");
+    return ok;
+}
+
+/* QF callbacks ............................................................*/
+void QF_onStartup(void) {
+    QF_setTickRate(100U);
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+    QF_TICK_X(0U, (void *)0);
+}
+/*..........................................................................*/
+void Q_onAssert(char const *module, int loc) {
+    fprintf(stderr, "Assertion failed in %s, loc %d\n", module, loc);
+    exit(-1);
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    static QEvt const *counterQueueSto[64];
+    static QEvt const *monitorQueueSto[32];
+    static QF_MPOOL_EL(SeqEvt) poolSto[128];
+    static char const * const prio2name[] = { "", "Monitor", "Counter" };
+    pthread_t thread;
+    bool ok;
+    uint_fast8_t p;
+
+    l_crashAt = (argc > 1) ? (uint32_t)strtoul(argv[1], (char **)0, 10)
+                           : 0U;
+
+    QF_init();
+    QF_poolInit(poolSto, sizeof(poolSto), sizeof(poolSto[0]));
+
+    (void)mkdir("qpw", 0755); /* the files of the AOs (may exist) */
+    QF_persistInit("qpw", PERIOD_MS);
+    QF_PERSIST_FUN(Counter_counting);
+    QF_PERSIST_FUN(Counter_even);
+    QF_PERSIST_FUN(Counter_odd);
+    QF_PERSIST_FUN(Monitor_watching);
+
+    QActive_ctor(&l_monitor.super, Q_STATE_CAST(&Monitor_initial));
+    QActive_persist(&l_monitor.super, &l_monitor.st,
+                    sizeof(l_monitor.st), 1024U);
+    QActive_ctor(&l_counter.super, Q_STATE_CAST(&Counter_initial));
+    QTimeEvt_ctorX(&l_counter.timeEvt, &l_counter.super, TICK_SIG, 0U);
+    QActive_persist(&l_counter.super, &l_counter.st,
+                    sizeof(l_counter.st), 16384U);
+    QActive_persistTimeEvt(&l_counter.super, &l_counter.timeEvt);
+
+    /* restored from the files here, if they hold valid snapshots */
+    QACTIVE_START(&l_monitor.super, 1U,
+                  monitorQueueSto, Q_DIM(monitorQueueSto),
+                  (void *)0, 0U, (QEvt *)0);
+    QACTIVE_START(&l_counter.super, 2U,
+                  counterQueueSto, Q_DIM(counterQueueSto),
+                  (void *)0, 0U, (QEvt *)0);
+
+    for (p = 1U; p <= 2U; ++p) {
+        QPersistStats stats;
+        (void)QF_persistGetStats(p, &stats);
+        if (stats.isWarm) {
+            printf("%s: warm restart, %u events replayed, %u requeued, "
+                   "%u us\n", prio2name[p], (unsigned)stats.nReplayed,
+                   (unsigned)stats.nRequeued, (unsigned)stats.restoreUs);
+        }
+        else {
+            printf("%s: cold start\n", prio2name[p]);
+        }
+    }
+
+    ok = check("restored");
+    l_first = l_counter.st.next; /* resume after the items counted */
+    if (ok && (l_first <= N_DATA)) {
+        Q_ALLEGE(pthread_create(&thread, (pthread_attr_t *)0,
+                                &producer, (void *)0) == 0);
+        (void)QF_run();
+        ok = check("finished");
+    }
+    if (ok && (l_first > N_DATA)) {
+        printf("nothing left to count, remove qpw/ for a cold start\n");
+    }
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+#else /* QF_PERSIST not defined */
+
+int main() {
+    printf("build the QP port and this example with QF_PERSIST "
+           "(see the Makefile)\n");
+    return 1;
+}
+
+#endif /* QF_PERSIST */
+
+/*****************************************************************************
+* NOTE1:
+* The producer resumes after the last data item counted before the crash,
+* which the Counter restored by replaying its journal. The items that were
+* still waiting in the queue of the Counter at its last snapshot are also
+* requeued by the restore, so some items arrive twice and the Counter
+* ignores the duplicates by their numbers. A gap in the numbers, a flip
+* received twice by the Monitor (posted again by the replay) or the state
+* not matching the number of flips would mean that the restore is broken.
+*
+* NOTE2:
+* The Counter requests a snapshot CRASH_AFTER data items before the crash,
+* so the restore replays the last CRASH_AFTER items from the journal and
+* then requeues the items that the producer had managed to post since the
+* snapshot (usually some, depending on the scheduling of the threads).
+*/
@@ -0,0 +1,155 @@
+/*****************************************************************************
+* Product: Active object ping-pong benchmark, POSIX
+* Last updated for version 5.8.2
+* Last updated on  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+*****************************************************************************/
+#include "qpc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum PingPongSignals {
+    PING_SIG = Q_USER_SIG, /* the ball bounced between the AOs of a pair */
+    MAX_SIG
+};
+
+enum {
+    N_PAIRS   = 4U,       /* pairs of AOs bouncing their own ball */
+    N_BOUNCES = 100000U   /* bounces per pair */
+};
+
+/* the Player active object ................................................*/
+typedef struct {
+    QActive super;
+    QActive *peer;     /* the other player of the pair */
+    uint32_t nHits;    /* # times the ball was received */
+} Player;
+
+/* the players are adjacent in memory, so without the SMP layout the
+* neighboring AOs of different pairs share cache lines
+*/
+static Player l_player[2U*N_PAIRS];
+static uint_fast8_t l_nDone; /* pairs that have finished (AO threads) */
+
+static QEvt const l_pingEvt = { (QSignal)PING_SIG, 0U, 0U };
+
+static QState Player_initial(Player * const me, QEvt const * const e);
+static QState Player_active(Player * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static QState Player_initial(Player * const me, QEvt const * const e) {
+    (void)e;
+    return Q_TRAN(&Player_active);
+}
+/*..........................................................................*/
+static QState Player_active(Player * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case PING_SIG: {
+            ++me->nHits;
+            if (me->nHits < N_BOUNCES) {
+                QACTIVE_POST(me->peer, &l_pingEvt, me);
+            }
+            else if (__atomic_add_fetch(&l_nDone, 1U, __ATOMIC_ACQ_REL)
+                     == N_PAIRS)
+            {
+                QF_stop(); /* the last pair has finished */
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+
+/* QF callbacks ............................................................*/
+void QF_onStartup(void) {
+    uint_fast8_t p;
+    QF_setTickRate(0U); /* no clock tick needed, see NOTE07 in qf_port.c */
+    for (p = 0U; p < N_PAIRS; ++p) { /* serve the balls */
+        QACTIVE_POST(&l_player[2U*p].super, &l_pingEvt, (void *)0);
+    }
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+}
+/*..........................................................................*/
+void Q_onAssert(char const *module, int loc) {
+    fprintf(stderr, "Assertion failed in %s, loc %d\n", module, loc);
+    exit(-1);
+}
+
+/*..........................................................................*/
+int main() {
+    static QEvt const *queueSto[2U*N_PAIRS][4];
+    struct timespec t0;
+    struct timespec t1;
+    double sec;
+    uint_fast8_t n;
+
+    QF_init();
+
+    for (n = 0U; n < 2U*N_PAIRS; ++n) {
+        QActive_ctor(&l_player[n].super, Q_STATE_CAST(&Player_initial));
+        l_player[n].peer = &l_player[n ^ 1U].super;
+    }
+    for (n = 0U; n < 2U*N_PAIRS; ++n) {
+        QACTIVE_START(&l_player[n].super, n + 1U,
+                      queueSto[n], Q_DIM(queueSto[n]),
+                      (void *)0, 0U, (QEvt *)0);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    (void)QF_run();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    sec = (double)(t1.tv_sec - t0.tv_sec)
+          + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    printf("layout: %s, sizeof(QActive)=%u, sizeof(Player)=%u\n",
+#ifdef QF_CACHE_ALIGNED
+           "SMP",
+#else
+           "dense",
+#endif
+           (unsigned)sizeof(QActive), (unsigned)sizeof(Player));
+    printf("%u pairs x %u bounces in %.3f s: %.0f posts/s\n",
+           (unsigned)N_PAIRS, (unsigned)N_BOUNCES, sec,
+           (double)N_PAIRS * (double)N_BOUNCES / sec);
+    return 0;
+}
@@ -0,0 +1,479 @@
+/*****************************************************************************
+* Product: Real-time latency validation tool (cyclictest-style), POSIX
+* Last updated for version 5.8.2
+* Last updated on  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+*****************************************************************************/
+#include "qpc.h"
+#ifdef QF_TICK_JITTER
+    #include "qf_jitter.h" /* tick jitter measured inside QF */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>  /* for getopt() */
+
+Q_DEFINE_THIS_FILE
+
+enum RtLatSignals {
+    SAMPLE_SIG = Q_USER_SIG, /* periodic time event of the Sampler */
+    PROBE_SIG,               /* time-stamped probe from the prober thread */
+    WORK_SIG,                /* periodic time event of a Worker (rate 0) */
+    HOUSEKEEP_SIG,           /* periodic time event of a Worker (rate 1) */
+    MAX_SIG
+};
+
+enum {
+    MAX_WORKERS = 8U,        /* the Workers with the time events */
+    HOUSEKEEP_HZ = 100U      /* the rate 1 ticked from QF_onClockTick() */
+};
+
+typedef struct {             /* latency histogram with 1us buckets */
+    uint32_t *bucket;        /* nBuckets counters */
+    uint32_t nOver;          /* # samples beyond the last bucket */
+    uint32_t n;              /* # samples */
+    int64_t min;             /* [ns] */
+    int64_t max;             /* [ns] */
+    int64_t sum;             /* [ns] */
+} Histo;
+
+typedef struct {
+    QEvt super;
+    int64_t stamp;           /* CLOCK_MONOTONIC when posted [ns] */
+} ProbeEvt;
+
+/* the Sampler active object ...............................................*/
+typedef struct {
+    QActive super;
+    QTimeEvt timeEvt;        /* periodic, every tick */
+    uint32_t nTicks;         /* # samples taken */
+} Sampler;
+
+static Sampler l_sampler;
+static QActive * const AO_Sampler = &l_sampler.super;
+
+/* the Worker active objects ...............................................*/
+typedef struct {
+    QActive super;
+    QTimeEvt workEvt;        /* every few ticks of rate 0 */
+    QTimeEvt housekeepEvt;   /* every tick of rate 1 */
+    uint32_t period;         /* the period of the workEvt [ticks] */
+} Worker;
+
+static Worker l_worker[MAX_WORKERS];
+
+/* options of the run */
+static uint32_t l_hz       = 1000U; /* -t: tick rate [Hz] */
+static uint32_t l_sec      = 10U;   /* -d: duration [s] */
+static uint32_t l_probeUs  = 1000U; /* -i: interval of the probes [us] */
+static uint32_t l_nLoad    = 0U;    /* -l: # CPU hog threads */
+static uint32_t l_loadMB   = 0U;    /* -m: memory-pressure working set */
+static uint32_t l_nBuckets = 1000U; /* -h: # 1us histogram buckets */
+static uint32_t l_nWorkers = 0U;    /* -w: # Workers with time events */
+static uint32_t l_workUs   = 20U;   /* processing of a Worker event [us] */
+static int      l_rtFlags  = 0;     /* -p/-s: the real-time profile */
+
+static int64_t l_tickBase; /* when the tick timer was started [ns] */
+static Histo l_tickLat;     /* the tick lateness against the ideal grid */
+static Histo l_deliveryLat; /* the posting-to-dispatch latency of probes */
+static bool volatile l_isRunning;
+
+static QState Sampler_initial(Sampler * const me, QEvt const * const e);
+static QState Sampler_active(Sampler * const me, QEvt const * const e);
+static QState Worker_initial(Worker * const me, QEvt const * const e);
+static QState Worker_active(Worker * const me, QEvt const * const e);
+
+/*..........................................................................*/
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+/*..........................................................................*/
+static void Histo_init(Histo * const me) {
+    memset(me, 0, sizeof(*me));
+    me->bucket = calloc(l_nBuckets, sizeof(uint32_t));
+    Q_ASSERT(me->bucket != (uint32_t *)0);
+    me->min = INT64_MAX;
+    me->max = INT64_MIN;
+}
+/*..........................................................................*/
+static void Histo_add(Histo * const me, int64_t const ns) {
+    int64_t us = (ns > 0) ? (ns / 1000) : 0; /* clock granularity */
+    if (us < (int64_t)l_nBuckets) {
+        ++me->bucket[us];
+    }
+    else {
+        ++me->nOver;
+    }
+    if (me->min > ns) {
+        me->min = ns;
+    }
+    if (me->max < ns) {
+        me->max = ns;
+    }
+    me->sum += ns;
+    ++me->n;
+}
+
+/*..........................................................................*/
+static QState Sampler_initial(Sampler * const me, QEvt const * const e) {
+    (void)e;
+    QActive_subscribe(&me->super, PROBE_SIG); /* not used, for the dict */
+    return Q_TRAN(&Sampler_active);
+}
+/*..........................................................................*/
+static QState Sampler_active(Sampler * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case Q_ENTRY_SIG: {
+            QTimeEvt_armX(&me->timeEvt, 1U, 1U); /* every tick */
+            status = Q_HANDLED();
+            break;
+        }
+        case SAMPLE_SIG: {
+            if (me->nTicks == l_sec * l_hz) { /* replayed after the end? */
+                status = Q_HANDLED();
+                break;
+            }
+            /* the lateness against the ideal time of the tick, which is
+            * a whole number of periods after the timer was started
+            */
+            ++me->nTicks;
+            Histo_add(&l_tickLat, now_ns() - (l_tickBase
+                + (int64_t)me->nTicks * (1000000000LL / (int64_t)l_hz)));
+            if (me->nTicks == l_sec * l_hz) {
+                QTimeEvt_disarm(&me->timeEvt);
+                l_isRunning = false;
+                QF_stop();
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        case PROBE_SIG: {
+            Histo_add(&l_deliveryLat,
+                      now_ns() - Q_EVT_CAST(ProbeEvt)->stamp);
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+
+/*..........................................................................*/
+static QState Worker_initial(Worker * const me, QEvt const * const e) {
+    (void)e;
+    return Q_TRAN(&Worker_active);
+}
+/*..........................................................................*/
+static QState Worker_active(Worker * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case Q_ENTRY_SIG: {
+            QTimeEvt_armX(&me->workEvt, me->period, me->period);
+            QTimeEvt_armX(&me->housekeepEvt, 1U, 1U);
+            status = Q_HANDLED();
+            break;
+        }
+        case WORK_SIG:        /* intentionally fall through */
+        case HOUSEKEEP_SIG: { /* the processing of the Worker */
+            int64_t end = now_ns() + (int64_t)l_workUs * 1000;
+            while (now_ns() < end) {
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+
+/* the synthetic load ......................................................*/
+static void *cpu_hog(void *arg) {
+    uint32_t volatile x = (uint32_t)(uintptr_t)arg;
+    while (l_isRunning) {
+        x = x * 1664525U + 1013904223U; /* burn the CPU */
+    }
+    return (void *)0;
+}
+/*..........................................................................*/
+static void *mem_hog(void *arg) {
+    size_t size = (size_t)l_loadMB << 20;
+    uint8_t *mem = malloc(size);
+    (void)arg;
+    if (mem == (uint8_t *)0) { /* e.g., over RLIMIT_MEMLOCK with mlockall */
+        fprintf(stderr, "no memory for the memory pressure\n");
+        return (void *)0;
+    }
+    while (l_isRunning) {
+        memset(mem, (int)(now_ns() & 0xFF), size); /* thrash the caches */
+    }
+    free(mem);
+    return (void *)0;
+}
+/*..........................................................................*/
+static void *prober(void *arg) {
+    struct timespec next;
+    (void)arg;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (l_isRunning) {
+        ProbeEvt *pe;
+        next.tv_nsec += (long)l_probeUs * 1000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, 0);
+
+        Q_NEW_X(pe, ProbeEvt, 1U, PROBE_SIG);
+        if (pe != (ProbeEvt *)0) {
+            pe->stamp = now_ns();
+            QACTIVE_POST_X(AO_Sampler, &pe->super, 1U, (void *)0);
+        }
+    }
+    return (void *)0;
+}
+
+/*..........................................................................*/
+static void Histo_print(char const * const name, Histo const * const me) {
+    printf("# %-9s Min: %7.1f Avg: %7.1f Max: %7.1f Overflows: %u"
+           " Samples: %u [us]\n", name,
+           (me->n != 0U) ? (double)me->min / 1000.0 : 0.0,
+           (me->n != 0U) ? (double)me->sum / (double)me->n / 1000.0 : 0.0,
+           (me->n != 0U) ? (double)me->max / 1000.0 : 0.0,
+           me->nOver, me->n);
+}
+/*..........................................................................*/
+static void report(void) {
+    uint32_t us;
+    uint_fast8_t fail = QF_getRtFailures();
+
+    printf("# rtlat: %u Hz tick, %u s, probe every %u us, "
+           "%u CPU hogs, %u MB memory pressure\n",
+           l_hz, l_sec, l_probeUs, l_nLoad, l_loadMB);
+    printf("# RT profile: %s, failures:%s%s%s%s%s\n",
+           (l_rtFlags != 0) ? "on" : "off",
+           (fail == 0U) ? " none" : "",
+           ((fail & QF_RT_MLOCK) != 0U) ? " mlock" : "",
+           ((fail & QF_RT_PREFAULT) != 0U) ? " prefault" : "",
+           ((fail & QF_RT_PI_MUTEX) != 0U) ? " pi-mutex" : "",
+           ((fail & QF_RT_FIFO) != 0U) ? " sched-fifo" : "");
+    printf("# Histogram (us, tick lateness, event delivery)\n");
+    for (us = 0U; us < l_nBuckets; ++us) {
+        if ((l_tickLat.bucket[us] != 0U)
+            || (l_deliveryLat.bucket[us] != 0U))
+        {
+            printf("%06u %06u %06u\n", us,
+                   l_tickLat.bucket[us], l_deliveryLat.bucket[us]);
+        }
+    }
+    Histo_print("Tick", &l_tickLat);
+    Histo_print("Delivery", &l_deliveryLat);
+    printf("# Tick overruns: %u\n", (unsigned)QF_getTickOverruns(0U));
+
+#ifdef QF_TICK_JITTER /* the jitter inside QF, see NOTE7 in qf_port.h */
+    {
+        uint_fast8_t rate;
+        for (rate = 0U; rate < QF_MAX_TICK_RATE; ++rate) {
+            QJitterHisto late;
+            QJitterHisto delay;
+            uint_fast8_t i;
+
+            QF_getTickJitter(rate, &late, &delay);
+            printf("# QF rate %u (%u Hz)\n", (unsigned)rate,
+                   (rate == 0U) ? l_hz : HOUSEKEEP_HZ);
+            printf("#  <=us   lateness   te-delay\n");
+            for (i = 0U; i < QF_JITTER_BUCKETS; ++i) {
+                if ((late.bucket[i] != 0U) || (delay.bucket[i] != 0U)) {
+                    printf("%7u%s %10u %10u\n", 1U << i,
+                           (i == QF_JITTER_BUCKETS - 1U) ? "+" : " ",
+                           late.bucket[i], delay.bucket[i]);
+                }
+            }
+            printf("# QF-Late%u  N: %u Avg: %.1f P99: %u Max: %.1f [us]\n",
+                   (unsigned)rate, late.n,
+                   (late.n != 0U) ? (double)late.sumNs / late.n / 1e3 : 0.0,
+                   QJitterHisto_percentile(&late, 99U),
+                   (double)late.maxNs / 1e3);
+            printf("# QF-Delay%u N: %u Avg: %.1f P99: %u Max: %.1f [us]\n",
+                   (unsigned)rate, delay.n,
+                   (delay.n != 0U) ? (double)delay.sumNs / delay.n / 1e3
+                                   : 0.0,
+                   QJitterHisto_percentile(&delay, 99U),
+                   (double)delay.maxNs / 1e3);
+        }
+        QF_traceTickJitter(); /* the QS summary (with Q_SPY) */
+    }
+#endif
+}
+
+/* QF callbacks ............................................................*/
+void QF_onStartup(void) {
+    QF_setTickRate(HOUSEKEEP_HZ); /* QF_onClockTick() ticks the rate 1 */
+    QF_setTickRateX(0U, l_hz);   /* timerfd-driven tick */
+    l_tickBase = now_ns();       /* the timer has just been started */
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+    QF_TICK_X(1U, (void *)0); /* the housekeeping rate */
+}
+/*..........................................................................*/
+void Q_onAssert(char const *module, int loc) {
+    fprintf(stderr, "Assertion failed in %s, loc %d\n", module, loc);
+    exit(-1);
+}
+
+/*..........................................................................*/
+static int aoPrio(uint_fast8_t const prio) { /* the priority mapping */
+    return 80 + (int)prio; /* the AOs just below the ISR-like threads */
+}
+
+/*..........................................................................*/
+int main(int argc, char *argv[]) {
+    static QSubscrList subscrSto[MAX_SIG];
+    static QF_MPOOL_EL(ProbeEvt) poolSto[64];
+    static QEvt const *queueSto[64];
+    pthread_t thread[64];
+    pthread_attr_t attr;
+    uint32_t n;
+    uint32_t nThreads = 0U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:d:i:l:m:h:w:psS")) != -1) {
+        switch (opt) {
+            case 't': l_hz       = (uint32_t)atoi(optarg); break;
+            case 'd': l_sec      = (uint32_t)atoi(optarg); break;
+            case 'i': l_probeUs  = (uint32_t)atoi(optarg); break;
+            case 'l': l_nLoad    = (uint32_t)atoi(optarg); break;
+            case 'm': l_loadMB   = (uint32_t)atoi(optarg); break;
+            case 'h': l_nBuckets = (uint32_t)atoi(optarg); break;
+            case 'p': l_rtFlags |= QF_RT_MLOCK | QF_RT_PREFAULT
+                                   | QF_RT_PI_MUTEX | QF_RT_FIFO; break;
+            case 's': l_rtFlags |= QF_RT_STRICT; break;
+            case 'w': l_nWorkers = (uint32_t)atoi(optarg); break;
+            case 'S': /* the stress scenario of the release reports */
+                l_sec      = 30U;
+                l_nLoad    = 2U * (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+                l_loadMB   = 256U;
+                l_nWorkers = 4U;
+                l_rtFlags |= QF_RT_MLOCK | QF_RT_PREFAULT
+                             | QF_RT_PI_MUTEX | QF_RT_FIFO;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t tick-Hz] [-d seconds]"
+                    " [-i probe-us] [-l cpu-hogs] [-m pressure-MB]"
+                    " [-h buckets] [-w workers] [-p(rofile RT)]"
+                    " [-s(trict RT)] [-S(tress scenario)]\n",
+                    argv[0]);
+                return -1;
+        }
+    }
+    if ((l_hz == 0U) || (l_probeUs == 0U) || (l_nBuckets == 0U)
+        || (l_nLoad > Q_DIM(thread) - 2U) || (l_nWorkers > MAX_WORKERS))
+    {
+        fprintf(stderr, "invalid options\n");
+        return -1;
+    }
+
+    if (l_rtFlags != 0) { /* apply the real-time profile before QF_init() */
+        static QFRtProfile profile;
+        profile.flags    = (uint8_t)l_rtFlags;
+        profile.isrPrio  = 0;              /* the top SCHED_FIFO priority */
+        profile.aoPrio   = &aoPrio;
+        profile.stkSize  = 64U * 1024U;    /* all locked with QF_RT_MLOCK */
+        profile.heapSize = 4U * 1024U * 1024U;
+        QF_setRtProfile(&profile);
+    }
+
+    Histo_init(&l_tickLat);
+    Histo_init(&l_deliveryLat);
+
+    QF_init();
+    QF_psInit(subscrSto, Q_DIM(subscrSto));
+    QF_poolInit(poolSto, sizeof(poolSto), sizeof(poolSto[0]));
+
+    QActive_ctor(&l_sampler.super, Q_STATE_CAST(&Sampler_initial));
+    QTimeEvt_ctorX(&l_sampler.timeEvt, &l_sampler.super, SAMPLE_SIG, 0U);
+    for (n = 0U; n < l_nWorkers; ++n) {
+        QActive_ctor(&l_worker[n].super, Q_STATE_CAST(&Worker_initial));
+        QTimeEvt_ctorX(&l_worker[n].workEvt, &l_worker[n].super,
+                       WORK_SIG, 0U);
+        QTimeEvt_ctorX(&l_worker[n].housekeepEvt, &l_worker[n].super,
+                       HOUSEKEEP_SIG, 1U);
+        l_worker[n].period = n + 2U; /* 2, 3, 4, ... ticks */
+    }
+
+    /* the load and the prober at the default priority, with small stacks
+    * (the default stacks of 8MB would all be locked with QF_RT_MLOCK)
+    */
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 64U * 1024U);
+    l_isRunning = true;
+    for (n = 0U; n < l_nLoad; ++n) {
+        Q_ALLEGE(pthread_create(&thread[nThreads++], &attr, &cpu_hog,
+                                (void *)(uintptr_t)n) == 0);
+    }
+    if (l_loadMB != 0U) {
+        Q_ALLEGE(pthread_create(&thread[nThreads++], &attr, &mem_hog,
+                                (void *)0) == 0);
+    }
+
+    for (n = 0U; n < l_nWorkers; ++n) { /* below the Sampler */
+        static QEvt const *workerQueueSto[MAX_WORKERS][64];
+        QACTIVE_START(&l_worker[n].super, n + 1U,
+                      workerQueueSto[n], Q_DIM(workerQueueSto[n]),
+                      (void *)0, 0U, (QEvt *)0);
+    }
+    QACTIVE_START(AO_Sampler, MAX_WORKERS + 1U, queueSto, Q_DIM(queueSto),
+                  (void *)0, 0U, (QEvt *)0);
+    Q_ALLEGE(pthread_create(&thread[nThreads++], &attr, &prober,
+                            (void *)0) == 0);
+    pthread_attr_destroy(&attr);
+
+    (void)QF_run(); /* until the Sampler has taken all samples */
+
+    for (n = 0U; n < nThreads; ++n) {
+        pthread_join(thread[n], (void **)0);
+    }
+    report();
+    return 0;
+}
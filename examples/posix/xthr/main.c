@@ -0,0 +1,328 @@
+/*****************************************************************************
+* Product: Extended threads test and benchmark, POSIX
+* Last updated for version 5.8.2
+* Last updated on  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+*****************************************************************************/
+#include "qpc.h"
+#include "qf_xthr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum XthrSignals {
+    DATA_SIG = Q_USER_SIG, /* data for the receiver thread */
+    TIMEOUT_SIG,           /* the period of the feeder */
+    MAX_SIG
+};
+
+enum {
+    N_SWITCHES = 200000U, /* semaphore round trips of ping and pong */
+    N_LOCKS    = 1000U,   /* mutex locks by each of the two lockers */
+    N_DATA     = 10U,     /* events received with and without timeout */
+    N_TESTS    = 5U       /* the threads reporting their results */
+};
+
+/* the priorities of the AO and of the extended threads */
+enum {
+    FEEDER_PRIO = 1U,
+    PING_PRIO,
+    PONG_PRIO,
+    LOCKER1_PRIO,
+    LOCKER2_PRIO,
+    RECEIVER_PRIO,
+    SLEEPER_PRIO
+};
+
+typedef struct {
+    QEvt super;
+    uint32_t seq;      /* the sequence number of the event */
+} DataEvt;
+
+/* the Feeder active object ................................................*/
+typedef struct {
+    QActive super;
+    QTimeEvt timeEvt;  /* the period of posting to the receiver */
+    uint32_t nPosted;  /* # data events posted to the receiver */
+} Feeder;
+
+static QState Feeder_initial(Feeder * const me, QEvt const * const e);
+static QState Feeder_feeding(Feeder * const me, QEvt const * const e);
+static QState Feeder_canceling(Feeder * const me, QEvt const * const e);
+
+/* the extended threads ....................................................*/
+static void Ping_run(QXThread * const me);
+static void Pong_run(QXThread * const me);
+static void Locker_run(QXThread * const me);
+static void Receiver_run(QXThread * const me);
+static void Sleeper_run(QXThread * const me);
+
+static Feeder l_feeder;
+static QXThread l_ping;       /* carrier 0 */
+static QXThread l_pong;       /* carrier 0 */
+static QXThread l_locker1;    /* carrier 1 */
+static QXThread l_locker2;    /* carrier 2 */
+static QXThread l_receiver;   /* carrier 1 */
+static QXThread l_sleeper;    /* carrier 2 */
+
+static QXSemaphore l_semPing;
+static QXSemaphore l_semPong;
+static QXMutex l_mutex;
+static uint32_t l_shared;     /* protected by l_mutex */
+static uint8_t  l_inside;     /* a locker is inside the critical section */
+static double l_nsPerSwitch;  /* measured by the ping thread */
+
+static uint_fast8_t l_nDone;   /* threads that have finished the test */
+static uint_fast8_t l_nFailed; /* checks that have failed */
+
+static void check(bool const ok, char const *what);
+static void done(char const *name);
+static double nsNow(void);
+
+/*..........................................................................*/
+static QState Feeder_initial(Feeder * const me, QEvt const * const e) {
+    (void)e;
+    QTimeEvt_armX(&me->timeEvt, 2U, 2U);
+    return Q_TRAN(&Feeder_feeding);
+}
+/*..........................................................................*/
+static QState Feeder_feeding(Feeder * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case TIMEOUT_SIG: {
+            DataEvt *d = Q_NEW(DataEvt, DATA_SIG);
+            d->seq = me->nPosted;
+            QXTHREAD_POST_X(&l_receiver, &d->super, 0U, me);
+            ++me->nPosted;
+            if (me->nPosted == 2U*N_DATA) {
+                status = Q_TRAN(&Feeder_canceling);
+            }
+            else {
+                status = Q_HANDLED();
+            }
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+/*..........................................................................*/
+static QState Feeder_canceling(Feeder * const me, QEvt const * const e) {
+    QState status;
+    switch (e->sig) {
+        case TIMEOUT_SIG: {
+            /* wake up the sleeper from its long delay */
+            if (QXThread_delayCancel(&l_sleeper)) {
+                (void)QTimeEvt_disarm(&me->timeEvt);
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        default: {
+            status = Q_SUPER(&QHsm_top);
+            break;
+        }
+    }
+    return status;
+}
+
+/*..........................................................................*/
+/* semaphore ping-pong with the pong thread in the same carrier */
+static void Ping_run(QXThread * const me) {
+    uint32_t switches = QXThread_getSwitches(0U);
+    double t = nsNow();
+    uint32_t n;
+
+    (void)me;
+    for (n = 0U; n < N_SWITCHES; ++n) {
+        QXSemaphore_signal(&l_semPong);
+        check(QXSemaphore_wait(&l_semPing, QXTHREAD_NO_TIMEOUT, 0U),
+              "semaphore wait");
+    }
+    t = nsNow() - t;
+    switches = QXThread_getSwitches(0U) - switches;
+    l_nsPerSwitch = t / (double)switches;
+    check(switches >= 2U*N_SWITCHES, "switches in carrier 0");
+    done("semaphore ping-pong");
+}
+/*..........................................................................*/
+static void Pong_run(QXThread * const me) {
+    (void)me;
+    for (;;) {
+        (void)QXSemaphore_wait(&l_semPong, QXTHREAD_NO_TIMEOUT, 0U);
+        QXSemaphore_signal(&l_semPing);
+    }
+}
+/*..........................................................................*/
+/* mutex contention of two threads in different carriers */
+static void Locker_run(QXThread * const me) {
+    uint32_t n;
+    for (n = 0U; n < N_LOCKS; ++n) {
+        QXMutex_lock(&l_mutex);
+        check(l_inside == 0U, "mutual exclusion");
+        l_inside = 1U;
+        ++l_shared;
+        if ((n % 100U) == 0U) { /* hold the mutex for a while */
+            (void)QXThread_delay(1U, 0U);
+        }
+        l_inside = 0U;
+        QXMutex_unlock(&l_mutex);
+    }
+    done((me == &l_locker1) ? "mutex locker 1" : "mutex locker 2");
+}
+/*..........................................................................*/
+/* queue of the thread without and with a timeout */
+static void Receiver_run(QXThread * const me) {
+    QEvt const *e;
+    uint32_t n;
+
+    (void)me;
+    for (n = 0U; n < 2U*N_DATA; ++n) {
+        e = QXThread_queueGet((n < N_DATA) ? QXTHREAD_NO_TIMEOUT : 20U,
+                              0U);
+        check((e != (QEvt const *)0) && (e->sig == (QSignal)DATA_SIG)
+              && (((DataEvt const *)e)->seq == n), "queue get");
+        if (e != (QEvt const *)0) {
+            QF_gc(e); /* the thread must recycle the events */
+        }
+    }
+    /* the feeder posts no more events, so this must time out */
+    e = QXThread_queueGet(5U, 0U);
+    check(e == (QEvt const *)0, "queue get timeout");
+    done("queue get");
+}
+/*..........................................................................*/
+/* delay expiring and delay canceled by the feeder */
+static void Sleeper_run(QXThread * const me) {
+    (void)me;
+    check(QXThread_delay(2U, 0U), "delay");
+    check(!QXThread_delay(10000U, 0U), "delay cancel");
+    done("delay");
+}
+
+/*..........................................................................*/
+static void check(bool const ok, char const *what) {
+    if (!ok) {
+        (void)__atomic_add_fetch(&l_nFailed, 1U, __ATOMIC_RELAXED);
+        fprintf(stderr, "check failed: %s\n", what);
+    }
+}
+/*..........................................................................*/
+static void done(char const *name) {
+    printf("%s: done\n", name);
+    if (__atomic_add_fetch(&l_nDone, 1U, __ATOMIC_ACQ_REL) == N_TESTS) {
+        QF_stop(); /* the last test has finished */
+    }
+}
+/*..........................................................................*/
+static double nsNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/* QF callbacks ............................................................*/
+void QF_onStartup(void) {
+    QF_setTickRate(100U); /* 10ms ticks for the delays and timeouts */
+}
+/*..........................................................................*/
+void QF_onCleanup(void) {
+}
+/*..........................................................................*/
+void QF_onClockTick(void) {
+    QF_TICK_X(0U, (void *)0);
+}
+/*..........................................................................*/
+void Q_onAssert(char const *module, int loc) {
+    fprintf(stderr, "Assertion failed in %s, loc %d\n", module, loc);
+    exit(-1);
+}
+
+/*..........................................................................*/
+int main() {
+    static QEvt const *feederQueueSto[4];
+    static QEvt const *receiverQueueSto[2U*N_DATA];
+    static QF_MPOOL_EL(DataEvt) poolSto[2U*N_DATA];
+
+    QF_init();
+    QF_poolInit(poolSto, sizeof(poolSto), sizeof(poolSto[0]));
+
+    QXSemaphore_init(&l_semPing, 0U);
+    QXSemaphore_init(&l_semPong, 0U);
+    QXMutex_init(&l_mutex, LOCKER2_PRIO); /* the ceiling of the lockers */
+
+    QXThread_ctor(&l_ping, &Ping_run, 0U);
+    QXThread_ctor(&l_pong, &Pong_run, 0U);
+    QXThread_ctor(&l_locker1, &Locker_run, 0U);
+    QXThread_setCarrier(&l_locker1, 1U);
+    QXThread_ctor(&l_locker2, &Locker_run, 0U);
+    QXThread_setCarrier(&l_locker2, 2U);
+    QXThread_ctor(&l_receiver, &Receiver_run, 0U);
+    QXThread_setCarrier(&l_receiver, 1U);
+    QXThread_ctor(&l_sleeper, &Sleeper_run, 0U);
+    QXThread_setCarrier(&l_sleeper, 2U);
+
+    QActive_ctor(&l_feeder.super, Q_STATE_CAST(&Feeder_initial));
+    QTimeEvt_ctorX(&l_feeder.timeEvt, &l_feeder.super, TIMEOUT_SIG, 0U);
+
+    QACTIVE_START(&l_feeder.super, FEEDER_PRIO,
+                  feederQueueSto, Q_DIM(feederQueueSto),
+                  (void *)0, 0U, (QEvt *)0);
+    QXTHREAD_START(&l_ping.super, PING_PRIO,
+                   (QEvt const **)0, 0U, (void *)0, 0U, (QEvt *)0);
+    QXTHREAD_START(&l_pong.super, PONG_PRIO,
+                   (QEvt const **)0, 0U, (void *)0, 0U, (QEvt *)0);
+    QXTHREAD_START(&l_locker1.super, LOCKER1_PRIO,
+                   (QEvt const **)0, 0U, (void *)0, 0U, (QEvt *)0);
+    QXTHREAD_START(&l_locker2.super, LOCKER2_PRIO,
+                   (QEvt const **)0, 0U, (void *)0, 0U, (QEvt *)0);
+    QXTHREAD_START(&l_receiver.super, RECEIVER_PRIO,
+                   receiverQueueSto, Q_DIM(receiverQueueSto),
+                   (void *)0, 0U, (QEvt *)0);
+    QXTHREAD_START(&l_sleeper.super, SLEEPER_PRIO,
+                   (QEvt const **)0, 0U, (void *)0, 0U, (QEvt *)0);
+
+    (void)QF_run();
+
+    check(l_shared == 2U*N_LOCKS, "mutex counter");
+    printf("context switch in carrier 0: %.1f ns (%s)\n", l_nsPerSwitch,
+#ifdef QF_XTHR_UCONTEXT
+           "swapcontext()"
+#else
+           "port default"
+#endif
+           );
+    printf("%s\n", (l_nFailed == 0U) ? "PASSED" : "FAILED");
+    return (l_nFailed == 0U) ? 0 : 1;
+}
@@ -151,8 +151,10 @@ typedef struct QEQueue {
     /*! offset to where next event will be inserted into the buffer. */
     QEQueueCtr volatile head;
 
+#ifndef QF_CACHE_ALIGNED
     /*! offset of where next event will be extracted from the buffer. */
     QEQueueCtr volatile tail;
+#endif
 
     /*! number of free events in the ring buffer. */
     QEQueueCtr volatile nFree;
@@ -165,6 +167,16 @@ typedef struct QEQueue {
     * @sa QF_getQueueMargin().
     */
     QEQueueCtr nMin;
+
+#ifdef QF_CACHE_ALIGNED
+    /*! offset of where next event will be extracted from the buffer. */
+    /**
+    * @note With the SMP layout (#QF_CACHE_ALIGNED defined in the port),
+    * the index used only by the consumer sits on its own cache line, so
+    * that it does not bounce between the cores of the posting threads.
+    */
+    QEQueueCtr volatile tail QF_CACHE_ALIGNED;
+#endif
 } QEQueue;
 
 /* public class operations */
@@ -82,6 +82,31 @@
     #define QF_TIMEEVT_CTR_SIZE  2
 #endif
 
+/* QF_TIMEEVT_SLACK can be defined in qf_port.h to enable the timer slack
+* of time events (see QTimeEvt_setSlack()). The alignments are traced only
+* when the QS port defines the record QS_TIMEEVT_ALIGN in qs_port.h.
+*/
+
+/* QF_TIMEEVT_SOA can be defined in qf_port.h to keep the armed time events
+* of each tick rate in an array of down-counters instead of a linked list
+*/
+#ifdef QF_TIMEEVT_SOA
+#ifndef QF_TIMEEVT_SOA_MAX
+    /*! Default maximum number of armed time events per tick rate */
+    #define QF_TIMEEVT_SOA_MAX   64
+#endif
+#endif
+
+/* QF_CACHE_ALIGNED can be defined in qf_port.h of hosted SMP ports as the
+* compiler-specific attribute aligning an object to the cache line, which
+* selects the false-sharing-free layout of ::QActive and ::QEQueue
+*/
+
+/* QF_MAX_DOMAIN can be defined in qf_port.h to instantiate the given number
+* of independent QF domains in one process. The port must then also define
+* the macro QF_DOMAIN_ID_() returning the domain of the calling thread.
+*/
+
 /****************************************************************************/
 struct QEQueue; /* forward declaration */
 
@@ -121,8 +146,18 @@ typedef struct {
     *
     * @note The native QF event queue is configured by defining the macro
     * #QF_EQUEUE_TYPE as ::QEQueue.
+    *
+    * @note With the SMP layout (#QF_CACHE_ALIGNED defined in the port),
+    * the event queue starts on its own cache line, which separates it from
+    * the state machine data written by the AO thread. This also aligns the
+    * whole active object (and any structure derived from it) to the cache
+    * line, so that no two active objects share a line.
     */
+#ifndef QF_CACHE_ALIGNED
     QF_EQUEUE_TYPE eQueue;
+#else
+    QF_EQUEUE_TYPE eQueue QF_CACHE_ALIGNED;
+#endif
 #endif
 
 #ifdef QF_OS_OBJECT_TYPE
@@ -439,8 +474,13 @@ void QMActive_ctor(QMActive * const me, QStateHandler initial);
 typedef struct QTimeEvt {
     QEvt super; /*<! inherits ::QEvt */
 
+#ifdef QF_TIMEEVT_SOA
+    /*! index of the armed time event in the per-rate array */
+    uint16_t slot;
+#else
     /*! link to the next time event in the list */
     struct QTimeEvt * volatile next;
+#endif
 
     /*! the active object that receives the time events */
     void * volatile act;
@@ -451,6 +491,11 @@ typedef struct QTimeEvt {
     * The down-counter is decremented by 1 in every QF_tickX_() invocation.
     * The time event fires (gets posted or published) when the down-counter
     * reaches zero.
+    *
+    * @note
+    * With the #QF_TIMEEVT_SOA layout the down-counters of armed time events
+    * live in the per-rate array and this member is used only in the heads
+    * of the tick rates. Use QTimeEvt_ctr() to read the counter portably.
     */
     QTimeEvtCtr volatile ctr;
 
@@ -462,6 +507,24 @@ typedef struct QTimeEvt {
     * periodically.
     */
     QTimeEvtCtr interval;
+
+#ifdef QF_TIMEEVT_SLACK
+    /*! the number of ticks the time event may expire late (timer slack) */
+    /**
+    * @description
+    * A non-zero slack lets QF align the expiry of the time event to
+    * a deadline shared with other time events, see QTimeEvt_setSlack().
+    */
+    QTimeEvtCtr slack;
+
+    /*! the tick of the requested (not aligned) expiry of the time event */
+    /**
+    * @description
+    * The periodic re-load aligns the next expiry from this tick, so that
+    * the alignment does not accumulate over the periods.
+    */
+    QTimeEvtCtr due;
+#endif
 } QTimeEvt;
 
 /* public functions */
@@ -480,6 +543,11 @@ bool QTimeEvt_rearm(QTimeEvt * const me, QTimeEvtCtr const nTicks);
 /*! Disarm a time event. */
 bool QTimeEvt_disarm(QTimeEvt * const me);
 
+#ifdef QF_TIMEEVT_SLACK
+/*! Set the timer slack of a time event */
+void QTimeEvt_setSlack(QTimeEvt * const me, QTimeEvtCtr const slack);
+#endif
+
 /*! Get the current value of the down-counter of a time event. */
 QTimeEvtCtr QTimeEvt_ctr(QTimeEvt const * const me);
 
@@ -789,7 +857,12 @@ void QF_bzero(void * const start, uint_fast16_t len);
 /**
 * @note Not to be used by Clients directly, only in ports of QF
 */
+#ifndef QF_MAX_DOMAIN
 extern QActive *QF_active_[QF_MAX_ACTIVE + 1];
+#else
+extern QActive *QF_domainActive_[QF_MAX_DOMAIN][QF_MAX_ACTIVE + 1];
+#define QF_active_ (QF_domainActive_[QF_DOMAIN_ID_()])
+#endif
 
 
 /****************************************************************************/
@@ -0,0 +1,551 @@
+/**
+* @file
+* @brief Unix-domain socket bridge between QP processes (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_codec.h"     /* event codec */
+#include "qf_bridge.h"    /* Unix-domain socket bridge interface */
+
+#include <errno.h>        /* for errno */
+#include <string.h>       /* for memset() and strncpy() */
+#include <sys/socket.h>   /* for socket(), sendmsg() and recv() */
+#include <sys/uio.h>      /* for struct iovec */
+#include <sys/un.h>       /* for struct sockaddr_un */
+#include <time.h>         /* for clock_gettime() */
+#include <unistd.h>       /* for close(), unlink() and usleep() */
+
+Q_DEFINE_THIS_MODULE("qf_bridge")
+
+/* packet layout, see NOTE2 */
+enum {
+    PKT_HDR_LEN = 12U,    /* credits(2), # events(2), timestamp(8) */
+    REC_HDR_LEN = 3U      /* recipient priority(1), length(2) */
+};
+
+/* Local functions ---------------------------------------------------------*/
+static QState QBridge_initial(QBridge * const me, QEvt const * const e);
+static QState QBridge_active(QBridge * const me, QEvt const * const e);
+static void QBridge_flush_(QBridge * const me);
+static void QBridge_receive_(QBridge * const me);
+static void QBridge_unpack_(QBridge * const me, uint_fast16_t const n);
+static void QBridge_linkDown_(QBridge * const me);
+static void putLE(uint8_t * const p, uint64_t v, uint_fast8_t const n);
+static uint64_t getLE(uint8_t const * const p, uint_fast8_t const n);
+static uint64_t bridge_nsNow(void);
+
+static void QBridgeProxy_init_(QHsm * const me, QEvt const * const e);
+static void QBridgeProxy_dispatch_(QHsm * const me, QEvt const * const e);
+#ifdef Q_SPY
+    static bool QBridgeProxy_post_(QActive * const me, QEvt const * const e,
+                      uint_fast16_t const margin, void const * const sender);
+#else
+    static bool QBridgeProxy_post_(QActive * const me, QEvt const * const e,
+                      uint_fast16_t const margin);
+#endif
+static void QBridgeProxy_postLIFO_(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+void QBridge_ctor(QBridge * const me, int const fd, enum_t const sig) {
+    QActive_ctor(&me->super, Q_STATE_CAST(&QBridge_initial));
+    QFdWatch_ctor(&me->rxWatch, &me->super, sig, (uint8_t)QF_FDW_LEVEL);
+    me->flushEvt.sig     = (QSignal)(sig + 1);
+    me->flushEvt.poolId_ = (uint8_t)0;
+    me->flushEvt.refCtr_ = (uint8_t)0;
+    me->fd           = fd;
+    me->txCur        = (uint8_t)0;
+    me->flushPending = (uint8_t)0;
+    me->credits      = (uint8_t)QF_BRIDGE_CREDITS;
+    me->creditsOwed  = (uint8_t)0;
+    me->txLen[0]   = (uint16_t)0;
+    me->txLen[1]   = (uint16_t)0;
+    me->txCount[0] = (uint16_t)0;
+    me->txCount[1] = (uint16_t)0;
+    me->nTxEvt   = (uint32_t)0;
+    me->nTxPkt   = (uint32_t)0;
+    me->nRxEvt   = (uint32_t)0;
+    me->nRxPkt   = (uint32_t)0;
+    me->nStalls  = (uint32_t)0;
+    me->nDropped = (uint32_t)0;
+    me->latSumNs = (uint64_t)0;
+    me->latMaxNs = (uint64_t)0;
+}
+/*..........................................................................*/
+/**
+* @description
+* The server side removes any stale socket file at @p path, waits for the
+* client to connect and returns the connected socket. The client side
+* retries the connection for about two seconds, so that the processes
+* can be started in any order.
+*
+* @returns the connected socket or -1 on failure.
+*/
+int QBridge_connect(char const * const path, bool const isServer) {
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    int conn = -1;
+    uint_fast8_t tries;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1U);
+
+    if (fd < 0) {
+        /* no socket, nothing to connect */
+    }
+    else if (isServer) {
+        (void)unlink(path);
+        if ((bind(fd, (struct sockaddr const *)&addr, sizeof(addr)) == 0)
+            && (listen(fd, 1) == 0))
+        {
+            conn = accept(fd, (struct sockaddr *)0, (socklen_t *)0);
+        }
+        (void)close(fd); /* the listening socket is no longer needed */
+    }
+    else {
+        for (tries = (uint_fast8_t)0;
+             (conn < 0) && (tries < (uint_fast8_t)100);
+             ++tries)
+        {
+            if (connect(fd, (struct sockaddr const *)&addr,
+                        sizeof(addr)) == 0)
+            {
+                conn = fd;
+            }
+            else {
+                usleep(20000U);
+            }
+        }
+        if (conn < 0) {
+            (void)close(fd);
+        }
+    }
+    return conn;
+}
+/*..........................................................................*/
+static QState QBridge_initial(QBridge * const me, QEvt const * const e) {
+    (void)e; /* unused parameter */
+    if (me->fd >= 0) {
+        Q_ALLEGE_ID(100, QFdWatch_add(&me->rxWatch, me->fd,
+                                      (uint8_t)QF_FD_READ));
+    }
+    return Q_TRAN(&QBridge_active);
+}
+/*..........................................................................*/
+static QState QBridge_active(QBridge * const me, QEvt const * const e) {
+    QState status;
+    if (e->sig == me->rxWatch.evt.super.sig) {
+        QFdEvt const * const fe = (QFdEvt const *)e;
+        if ((fe->ready & (uint8_t)(QF_FD_HUP | QF_FD_ERR)) != (uint8_t)0) {
+            QBridge_receive_(me); /* drain what is left, then go down */
+            QBridge_linkDown_(me);
+        }
+        else {
+            QBridge_receive_(me);
+            if (me->fd >= 0) {
+                (void)QFdWatch_rearm(&me->rxWatch); /* level-triggered */
+            }
+        }
+        status = Q_HANDLED();
+    }
+    else if (e->sig == me->flushEvt.sig) {
+        QBridge_flush_(me);
+        status = Q_HANDLED();
+    }
+    else {
+        status = Q_SUPER(&QHsm_top);
+    }
+    return status;
+}
+/*..........................................................................*/
+/**
+* @description
+* Sends the transmit packet being filled by the proxies, if there are
+* credits for it, together with the credits owed to the peer. Without
+* any events to send, a credit-only packet is sent when at least half
+* of the peer's window is owed.
+*/
+static void QBridge_flush_(QBridge * const me) {
+    uint8_t hdr[PKT_HDR_LEN];
+    struct iovec iov[2];
+    struct msghdr msg;
+    uint_fast8_t buf = (uint_fast8_t)0;
+    uint_fast16_t len = (uint_fast16_t)0;
+    uint_fast16_t cnt = (uint_fast16_t)0;
+    uint64_t stamp = (uint64_t)0;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    if (me->txCount[me->txCur] == (uint16_t)0) {
+        me->flushPending = (uint8_t)0; /* nothing to send */
+    }
+    else if (me->credits == (uint8_t)0) {
+        ++me->nStalls; /* stay pending until the peer returns credits */
+    }
+    else { /* swap the transmit buffers, see NOTE1 */
+        buf   = (uint_fast8_t)me->txCur;
+        len   = (uint_fast16_t)me->txLen[buf];
+        cnt   = (uint_fast16_t)me->txCount[buf];
+        stamp = me->txStamp[buf];
+        me->txCur = (uint8_t)(buf ^ 1U);
+        me->txLen[me->txCur]   = (uint16_t)0;
+        me->txCount[me->txCur] = (uint16_t)0;
+        me->flushPending = (uint8_t)0;
+    }
+    QF_CRIT_EXIT_();
+
+    if ((me->fd >= 0)
+        && ((cnt != (uint_fast16_t)0)
+            || (me->creditsOwed >= (uint8_t)(QF_BRIDGE_CREDITS / 2U))))
+    {
+        putLE(&hdr[0], (uint64_t)me->creditsOwed, (uint_fast8_t)2);
+        putLE(&hdr[2], (uint64_t)cnt, (uint_fast8_t)2);
+        putLE(&hdr[4], stamp, (uint_fast8_t)8);
+        iov[0].iov_base = &hdr[0];
+        iov[0].iov_len  = sizeof(hdr);
+        iov[1].iov_base = &me->txBuf[buf][0];
+        iov[1].iov_len  = (size_t)len;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = &iov[0];
+        msg.msg_iovlen = (cnt != (uint_fast16_t)0) ? 2U : 1U;
+
+        if (sendmsg(me->fd, &msg, MSG_NOSIGNAL) >= 0) {
+            me->creditsOwed = (uint8_t)0;
+            if (cnt != (uint_fast16_t)0) {
+                --me->credits;
+                ++me->nTxPkt;
+                me->nTxEvt += (uint32_t)cnt;
+            }
+        }
+        else {
+            me->nDropped += (uint32_t)cnt;
+            QBridge_linkDown_(me);
+        }
+    }
+}
+/*..........................................................................*/
+static void QBridge_receive_(QBridge * const me) {
+    uint_fast8_t i;
+    bool isUp = true;
+
+    /* at most the whole credit window of packets per readiness report */
+    for (i = (uint_fast8_t)0;
+         isUp && (i < (uint_fast8_t)QF_BRIDGE_CREDITS);
+         ++i)
+    {
+        ssize_t n = recv(me->fd, &me->rxBuf[0], sizeof(me->rxBuf),
+                         MSG_DONTWAIT);
+        if (n >= (ssize_t)PKT_HDR_LEN) {
+            QBridge_unpack_(me, (uint_fast16_t)n);
+        }
+        else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            break; /* all packets received */
+        }
+        else if (n <= 0) {
+            isUp = false; /* the peer closed the connection or error */
+        }
+        else {
+            /* a runt packet, ignore */
+        }
+    }
+    if (!isUp) {
+        QBridge_linkDown_(me);
+    }
+    else if (me->flushPending != (uint8_t)0) {
+        QBridge_flush_(me); /* the credits might have been the reason */
+    }
+    else if (me->creditsOwed >= (uint8_t)(QF_BRIDGE_CREDITS / 2U)) {
+        QBridge_flush_(me); /* send the credits back to the peer */
+    }
+    else {
+        /* nothing to do */
+    }
+}
+/*..........................................................................*/
+static void QBridge_unpack_(QBridge * const me, uint_fast16_t const n) {
+    uint8_t const * const pkt = &me->rxBuf[0];
+    uint_fast16_t cnt = (uint_fast16_t)getLE(&pkt[2], (uint_fast8_t)2);
+    uint_fast16_t pos = (uint_fast16_t)PKT_HDR_LEN;
+
+    me->credits += (uint8_t)getLE(&pkt[0], (uint_fast8_t)2);
+
+    if (cnt != (uint_fast16_t)0) {
+        uint64_t lat = bridge_nsNow() - getLE(&pkt[4], (uint_fast8_t)8);
+        me->latSumNs += lat;
+        if (lat > me->latMaxNs) {
+            me->latMaxNs = lat;
+        }
+        ++me->nRxPkt;
+        ++me->creditsOwed;
+    }
+
+    for (; cnt != (uint_fast16_t)0; --cnt) {
+        uint_fast8_t prio;
+        uint_fast16_t len;
+        QEvt *e;
+
+        if ((pos + (uint_fast16_t)REC_HDR_LEN) > n) {
+            me->nDropped += (uint32_t)cnt; /* truncated packet */
+            break;
+        }
+        prio = (uint_fast8_t)pkt[pos];
+        len  = (uint_fast16_t)getLE(&pkt[pos + 1U], (uint_fast8_t)2);
+        pos += (uint_fast16_t)REC_HDR_LEN;
+        if ((pos + len) > n) {
+            me->nDropped += (uint32_t)cnt; /* truncated packet */
+            break;
+        }
+
+        /* decode straight into a pool event (asserts if no event) */
+        e = QF_decode(&pkt[pos], len, (uint_fast16_t)0);
+        pos += len;
+
+        if (e == (QEvt *)0) {
+            ++me->nDropped; /* no schema for the signal in this process */
+        }
+        else if (prio == (uint_fast8_t)0) {
+            ++me->nRxEvt;
+            QF_PUBLISH(e, me);
+        }
+        else {
+            /** the recipient AO must be registered in this process */
+            Q_ASSERT_ID(310, (prio <= (uint_fast8_t)QF_MAX_ACTIVE)
+                             && (QF_active_[prio] != (QActive *)0));
+            ++me->nRxEvt;
+            QACTIVE_POST(QF_active_[prio], e, me);
+        }
+    }
+}
+/*..........................................................................*/
+static void QBridge_linkDown_(QBridge * const me) {
+    QF_CRIT_STAT_
+    if (me->fd >= 0) {
+        (void)QFdWatch_remove(&me->rxWatch);
+        (void)close(me->fd);
+        QF_CRIT_ENTRY_();
+        me->fd = -1; /* the proxies drop all events from now on */
+        me->nDropped += (uint32_t)me->txCount[me->txCur];
+        me->txLen[me->txCur]   = (uint16_t)0;
+        me->txCount[me->txCur] = (uint16_t)0;
+        QF_CRIT_EXIT_();
+    }
+}
+
+/*..........................................................................*/
+void QBridgeProxy_ctor(QBridgeProxy * const me, QBridge * const bridge,
+                       uint_fast8_t const remotePrio)
+{
+    static QActiveVtbl const vtbl = {  /* QActiveVtbl virtual table */
+        { &QBridgeProxy_init_,
+          &QBridgeProxy_dispatch_ },
+        &QActive_start_,
+        &QBridgeProxy_post_,
+        &QBridgeProxy_postLIFO_
+    };
+
+    /** @pre the remote AO must be in range */
+    Q_REQUIRE_ID(400, remotePrio <= (uint_fast8_t)QF_MAX_ACTIVE);
+
+    QActive_ctor(&me->super, Q_STATE_CAST(0)); /* superclass' ctor */
+    me->super.super.vptr = &vtbl.super; /* hook the vptr */
+    me->bridge     = bridge;
+    me->remotePrio = (uint8_t)remotePrio;
+}
+/*..........................................................................*/
+void QBridgeProxy_start(QBridgeProxy * const me, uint_fast8_t const prio) {
+    me->super.prio = (uint8_t)prio;
+    QF_add_(&me->super); /* make QF aware of this proxy */
+}
+/*..........................................................................*/
+static void QBridgeProxy_init_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+}
+/*..........................................................................*/
+static void QBridgeProxy_dispatch_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(500); /* events are never dispatched to a proxy */
+}
+/*..........................................................................*/
+/**
+* @description
+* Encodes the event into the current transmit packet of the bridge and
+* posts the flush event to the bridge, unless it has been posted already.
+* When the link is down, the events are dropped (and counted), but this
+* is not treated as an error. Otherwise the @p margin of zero asserts when
+* the transmit packet has no room left for the event.
+*/
+#ifndef Q_SPY
+static bool QBridgeProxy_post_(QActive * const me, QEvt const * const e,
+                               uint_fast16_t const margin)
+#else
+static bool QBridgeProxy_post_(QActive * const me, QEvt const * const e,
+                               uint_fast16_t const margin,
+                               void const * const sender)
+#endif
+{
+    QBridgeProxy * const proxy = (QBridgeProxy *)me;
+    QBridge * const br = proxy->bridge;
+    uint_fast16_t const len = QF_encodedSize((enum_t)e->sig);
+    bool status = false;
+    bool doFlush = false;
+    bool isUp;
+    QF_CRIT_STAT_
+
+    /** @pre the signal must have a registered schema */
+    Q_REQUIRE_ID(600, len != (uint_fast16_t)0);
+
+    QF_CRIT_ENTRY_();
+    isUp = (br->fd >= 0);
+    if (isUp && ((uint_fast16_t)br->txLen[br->txCur]
+                  + (uint_fast16_t)REC_HDR_LEN + len
+                  <= (uint_fast16_t)(QF_BRIDGE_PKT_SIZE - PKT_HDR_LEN)))
+    {
+        uint8_t * const rec = &br->txBuf[br->txCur][br->txLen[br->txCur]];
+        if (br->txCount[br->txCur] == (uint16_t)0) {
+            br->txStamp[br->txCur] = bridge_nsNow();
+        }
+        rec[0] = proxy->remotePrio;
+        putLE(&rec[1], (uint64_t)len, (uint_fast8_t)2);
+        (void)QF_encode(e, &rec[REC_HDR_LEN], len);
+        br->txLen[br->txCur] += (uint16_t)(REC_HDR_LEN + len);
+        ++br->txCount[br->txCur];
+        status = true;
+        if (br->flushPending == (uint8_t)0) {
+            br->flushPending = (uint8_t)1;
+            doFlush = true;
+        }
+    }
+    else {
+        ++br->nDropped;
+    }
+
+    QS_BEGIN_NOCRIT_((status ? QS_QF_ACTIVE_POST_FIFO
+                             : QS_QF_ACTIVE_POST_ATTEMPT),
+                     QS_priv_.aoObjFilter, me)
+        QS_TIME_();             /* timestamp */
+        QS_OBJ_(sender);        /* the sender object */
+        QS_SIG_(e->sig);        /* the signal of the event */
+        QS_OBJ_(me);            /* this proxy (recipient) */
+        QS_2U8_(e->poolId_, e->refCtr_); /* pool Id & ref Count */
+        QS_EQC_((QEQueueCtr)0); /* number of free entries (unknown) */
+        QS_EQC_((QEQueueCtr)margin); /* margin requested */
+    QS_END_NOCRIT_()
+
+    /* the event has been copied, so it is consumed right away,
+    * see NOTE3 in qf_shm.c
+    */
+    if (e->poolId_ != (uint8_t)0) {
+        QF_EVT_REF_CTR_INC_(e);
+    }
+    QF_CRIT_EXIT_();
+    QF_gc(e);
+
+    /* assert if the event cannot be sent and dropping is not acceptable */
+    Q_ASSERT_ID(610, status || (!isUp) || (margin != (uint_fast16_t)0));
+
+    if (doFlush) {
+        QACTIVE_POST(&br->super, &br->flushEvt, me);
+    }
+    return status;
+}
+/*..........................................................................*/
+static void QBridgeProxy_postLIFO_(QActive * const me, QEvt const * const e)
+{
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(700); /* LIFO posting is meaningful only for self-posting */
+}
+
+/*..........................................................................*/
+static void putLE(uint8_t * const p, uint64_t v, uint_fast8_t const n) {
+    uint_fast8_t i;
+    for (i = (uint_fast8_t)0; i < n; ++i) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+/*..........................................................................*/
+static uint64_t getLE(uint8_t const * const p, uint_fast8_t const n) {
+    uint64_t v = (uint64_t)0;
+    uint_fast8_t i;
+    for (i = n; i > (uint_fast8_t)0; --i) {
+        v = (v << 8) | (uint64_t)p[i - 1U];
+    }
+    return v;
+}
+/*..........................................................................*/
+static uint64_t bridge_nsNow(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*****************************************************************************
+* NOTE1:
+* The proxies append the encoded events to the current transmit packet in
+* the critical section and only the first event in a packet posts the
+* flush event to the bridge. When the bridge processes the flush event, it
+* swaps the two transmit buffers and sends the filled one outside of the
+* critical section, while the proxies already fill the other one. So, the
+* busier the bridge, the more events travel in a single sendmsg().
+*
+* Each side may have at most #QF_BRIDGE_CREDITS unacknowledged packets in
+* flight. A packet is credited back to the sender when the receiver has
+* re-injected all its events, so a slow receiver throttles the sender
+* instead of exhausting its own event pools. The returned credits travel
+* in the header of the next packet in the opposite direction, or in
+* a credit-only packet when half of the window is owed. Credit-only
+* packets are not credited themselves, so the credits can never deadlock.
+*
+* NOTE2:
+* A packet consists of a header and the events. The header holds the
+* credits returned to the peer, the number of events and the time the
+* first event has been added to the packet (CLOCK_MONOTONIC, which is
+* common to all processes on the host). Each event is the recipient
+* priority (0 for publishing), the length of the encoded event and the
+* event encoded by QF_encode(). All numbers are little-endian.
+*/
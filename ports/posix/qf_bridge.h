@@ -0,0 +1,128 @@
+/**
+* @file
+* @brief Unix-domain socket bridge between QP processes (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_bridge_h
+#define qf_bridge_h
+
+#include "qf_fdwatch.h" /* the bridge watches its socket */
+
+#ifndef QF_BRIDGE_PKT_SIZE
+    /*! The maximum size of a packet (a batch of encoded events) [bytes] */
+    #define QF_BRIDGE_PKT_SIZE  4096U
+#endif
+
+#ifndef QF_BRIDGE_CREDITS
+    /*! The number of packets a side may send ahead of the peer */
+    #define QF_BRIDGE_CREDITS   8U
+#endif
+
+/*! Unix-domain socket bridge active object */
+/**
+* @description
+* A bridge is an AO that owns one connected @c SOCK_SEQPACKET socket to
+* a peer process. The events posted to the ::QBridgeProxy objects of this
+* process are encoded with the event codec (see qf_codec.h) into the
+* current transmit packet, which the bridge sends with a single sendmsg()
+* when it gets to process its flush event. So, all the events posted
+* while the bridge is busy go out in one packet. Each received packet is
+* decoded in one go and its events are re-injected with QACTIVE_POST() or
+* QF_PUBLISH().
+*
+* The link has credit-based flow control (see NOTE1 in qf_bridge.c) and
+* keeps counters of its throughput and latency.
+*
+* @note The bridge uses two consecutive signals starting with the @c sig
+* passed to QBridge_ctor(). The events must have their schemas registered
+* with QF_CODEC_REGISTER() in both processes.
+*/
+typedef struct {
+    QActive super;        /*!< inherits ::QActive */
+    QFdWatch rxWatch;     /*!< readiness of the socket */
+    QEvt flushEvt;        /*!< static event requesting a flush */
+    int fd;               /*!< the connected socket (-1 when closed) */
+    uint8_t  txCur;       /*!< the transmit packet being filled */
+    uint8_t  flushPending;/*!< the flush event has been posted */
+    uint8_t  credits;     /*!< packets that may be sent to the peer */
+    uint8_t  creditsOwed; /*!< packets processed, but not credited yet */
+    uint16_t txLen[2];    /*!< the lengths of the transmit packets */
+    uint16_t txCount[2];  /*!< # events in the transmit packets */
+    uint64_t txStamp[2];  /*!< when the first event was added [ns] */
+
+    /* link counters (for diagnostics only) */
+    uint32_t nTxEvt;      /*!< # events sent */
+    uint32_t nTxPkt;      /*!< # packets sent */
+    uint32_t nRxEvt;      /*!< # events received */
+    uint32_t nRxPkt;      /*!< # packets received */
+    uint32_t nStalls;     /*!< # flushes delayed for lack of credits */
+    uint32_t nDropped;    /*!< # events dropped (full or link down) */
+    uint64_t latSumNs;    /*!< the sum of the packet latencies [ns] */
+    uint64_t latMaxNs;    /*!< the maximum packet latency [ns] */
+
+    uint8_t txBuf[2][QF_BRIDGE_PKT_SIZE]; /*!< double transmit buffer */
+    uint8_t rxBuf[QF_BRIDGE_PKT_SIZE];    /*!< receive buffer */
+} QBridge;
+
+/*! The "constructor" of a bridge over the connected socket @p fd */
+void QBridge_ctor(QBridge * const me, int const fd, enum_t const sig);
+
+/*! Create a connected @c SOCK_SEQPACKET socket at the @p path */
+int QBridge_connect(char const * const path, bool const isServer);
+
+/*! Proxy of an active object in the process on the other side of a bridge */
+/**
+* @description
+* Like ::QShmProxy, the proxy is registered with the local framework at
+* a unique priority but has no event queue or thread. The events posted to
+* the proxy, or published and delivered to it by virtue of its
+* subscriptions, are forwarded to the AO with the priority @c remotePrio
+* in the peer process (or re-published there if @c remotePrio is zero).
+*/
+typedef struct {
+    QActive super;        /*!< inherits ::QActive */
+    QBridge *bridge;      /*!< the bridge leading to the remote AO */
+    uint8_t remotePrio;   /*!< the remote AO (0 to publish remotely) */
+} QBridgeProxy;
+
+/*! The "constructor" of a remote AO proxy */
+void QBridgeProxy_ctor(QBridgeProxy * const me, QBridge * const bridge,
+                       uint_fast8_t const remotePrio);
+
+/*! Register the proxy with the framework at the priority @p prio */
+void QBridgeProxy_start(QBridgeProxy * const me, uint_fast8_t const prio);
+
+#endif /* qf_bridge_h */
@@ -0,0 +1,190 @@
+/**
+* @file
+* @brief SPSC channels between active objects (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_channel.h"   /* SPSC channels interface */
+
+Q_DEFINE_THIS_MODULE("qf_channel")
+
+static bool channel_takeWake(QChannel * const me);
+
+/*..........................................................................*/
+void QChannel_init(QChannel * const me, QActive * const act,
+                   QEvt const *sto[], uint_fast16_t const len)
+{
+    /** @pre the ring length must be a power of 2 */
+    Q_REQUIRE_ID(100, (len > (uint_fast16_t)1)
+                      && ((len & (len - (uint_fast16_t)1))
+                          == (uint_fast16_t)0));
+
+    QF_bzero(me, (uint_fast16_t)sizeof(*me));
+    me->doorbell.sig = QF_CHANNEL_SIG_; /* static event, see NOTE1 */
+    me->act      = act;
+    me->ring     = sto;
+    me->mask     = (uint32_t)len - 1U;
+    me->needWake = 1U; /* the consumer has not seen any events yet */
+}
+/*..........................................................................*/
+bool QChannel_post(QChannel * const me, QEvt const * const e,
+                   uint_fast16_t const margin)
+{
+    uint32_t const head = me->head;
+    uint32_t const len  = me->mask + 1U;
+    bool status;
+
+    /* refresh the cached tail only when the ring looks full */
+    if ((len - (head - me->tailCache)) <= (uint32_t)margin) {
+        me->tailCache = __atomic_load_n(&me->tail, __ATOMIC_ACQUIRE);
+    }
+
+    if ((len - (head - me->tailCache)) > (uint32_t)margin) {
+        if (e->poolId_ != (uint8_t)0) { /* dynamic event? */
+            QF_EVT_REF_CTR_INC_(e); /* the producer owns it, see NOTE2 */
+        }
+        me->ring[head & me->mask] = e;
+        __atomic_store_n(&me->head, head + 1U, __ATOMIC_RELEASE);
+        ++me->nPosted;
+
+        /* the new head must be visible before needWake is read, NOTE1 */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if ((__atomic_load_n(&me->needWake, __ATOMIC_RELAXED) != 0U)
+            && channel_takeWake(me)) /* won the doorbell? */
+        {
+            ++me->nWakeups;
+            QACTIVE_POST(me->act, &me->doorbell, me);
+        }
+        status = true;
+    }
+    else {
+        /* assert if the event cannot be posted and dropping is not
+        * acceptable
+        */
+        Q_ASSERT_ID(210, margin != (uint_fast16_t)0);
+
+        if (e->poolId_ != (uint8_t)0) { /* recycle the event */
+            QF_EVT_REF_CTR_INC_(e);
+            QF_gc(e);
+        }
+        status = false;
+    }
+    return status;
+}
+/*..........................................................................*/
+void QChannel_service_(QChannel * const me) {
+    QActive * const act = me->act;
+    uint32_t tail = me->tail;
+    uint_fast16_t budget = (uint_fast16_t)QF_CHANNEL_BATCH;
+    bool more = true;
+
+    while (more) {
+        if (tail != __atomic_load_n(&me->head, __ATOMIC_ACQUIRE)) {
+            if (budget != (uint_fast16_t)0) {
+                QEvt const * const e = me->ring[tail & me->mask];
+
+                ++tail;
+                __atomic_store_n(&me->tail, tail, __ATOMIC_RELEASE);
+
+                /* each event is its own RTC step, like from the queue */
+                QHSM_DISPATCH(&act->super, e);
+                QF_gc(e);
+                --budget;
+            }
+            else { /* let the events in the main queue in, see NOTE1 */
+                QACTIVE_POST(act, &me->doorbell, me);
+                more = false;
+            }
+        }
+        else { /* drained, ask the producer for the doorbell, see NOTE1 */
+            __atomic_store_n(&me->needWake, 1U, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (tail == __atomic_load_n(&me->head, __ATOMIC_ACQUIRE)) {
+                more = false; /* the producer will ring the doorbell */
+            }
+            /* the producer was faster, did it ring the doorbell as well? */
+            else if (!channel_takeWake(me)) {
+                more = false; /* the events wait for the doorbell */
+            }
+        }
+    }
+}
+/*..........................................................................*/
+/* clear needWake unless the other side already did, see NOTE1 */
+static bool channel_takeWake(QChannel * const me) {
+    uint32_t expected = 1U;
+    return __atomic_compare_exchange_n(&me->needWake, &expected, 0U, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The consumer learns about the events in a channel from the "doorbell",
+* a static event with the reserved signal QF_CHANNEL_SIG_ that is posted
+* to its main queue. The thread of the consumer (see thread_routine() in
+* qf_port.c) does not dispatch the doorbell, but instead dispatches the
+* events waiting in the channel, each in its own RTC step. The doorbell is
+* rung only when the consumer has drained the channel and raised the
+* needWake flag, so in a busy pipeline the producer posts to the channel
+* without ever touching the lock of the consumer's queue. The producer
+* publishes the head and then reads needWake, while the consumer raises
+* needWake and then re-reads the head, both across a full memory fence,
+* so at least one of them sees the other and no wakeup can be lost. When
+* both see each other, the side that clears needWake (compare-exchange
+* from 1 to 0) wins: the producer rings the doorbell only when it wins,
+* and the consumer that lost returns, because the doorbell is already on
+* its way. After QF_CHANNEL_BATCH events the consumer rings the doorbell
+* to itself (needWake is 0 at this time) and returns, so that a busy
+* channel cannot starve the main queue. At most one doorbell of every
+* channel is therefore waiting in the main queue of the consumer, which
+* must have room for one doorbell of every channel feeding it.
+*
+* NOTE2:
+* The reference counter of a dynamic event is normally changed only inside
+* the critical section. A channel post increments it without the lock,
+* which is safe only because the producer is the only owner of the event
+* at this time (see QChannel_post()), so no other thread can be recycling
+* it concurrently. The consumer recycles the event with QF_gc() as usual.
+*/
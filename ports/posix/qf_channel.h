@@ -0,0 +1,121 @@
+/**
+* @file
+* @brief SPSC channels between active objects (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_channel_h
+#define qf_channel_h
+
+#ifndef QF_CHANNEL_BATCH
+    /*! The maximum number of channel events dispatched per wakeup */
+    #define QF_CHANNEL_BATCH  64U
+#endif
+
+/*! Point-to-point channel into an active object */
+/**
+* @description
+* A channel is a wait-free single-producer, single-consumer (SPSC) ring
+* of event pointers, which feeds the consumer AO alongside its main event
+* queue. Posting to a channel takes no lock and no atomic read-modify-
+* write: the producer stores the event and publishes the new head, and
+* the consumer thread dispatches the events straight from the ring. The
+* consumer's main queue (and its lock) is used only to wake up the
+* consumer when it has drained the channel and might be sleeping, see
+* NOTE1 in qf_channel.c.
+*
+* Each channel must have exactly one producer (a single AO or thread) at
+* any given time. The events from a channel are dispatched in the order
+* in which they were posted, but they are not ordered with respect to the
+* events in the consumer's main queue or in other channels.
+*/
+typedef struct {
+    QEvt doorbell;        /*!< wakes up the consumer (must be first) */
+    QActive *act;         /*!< the consumer AO */
+    QEvt const **ring;    /*!< the ring storage */
+    uint32_t mask;        /*!< the ring length - 1 */
+
+    /* written by the producer only */
+    uint32_t head __attribute__((aligned(64))); /*!< next slot to fill */
+    uint32_t tailCache;   /*!< the last tail seen by the producer */
+    uint32_t volatile nPosted; /*!< # events posted */
+
+    /* written by the consumer (and needWake cleared by the producer) */
+    uint32_t tail __attribute__((aligned(64))); /*!< next slot to read */
+    uint32_t needWake;    /*!< the consumer waits for the doorbell */
+    uint32_t volatile nWakeups; /*!< # doorbells rung by the producer */
+} QChannel;
+
+/*! Initialize the channel into the consumer AO @p act */
+/**
+* @description
+* The ring length @p len must be a power of 2. The consumer AO must be
+* started before the first event is posted to the channel.
+*/
+void QChannel_init(QChannel * const me, QActive * const act,
+                   QEvt const *sto[], uint_fast16_t const len);
+
+/*! Post the event @p e to the channel (called only by the producer) */
+/**
+* @description
+* The producer must be the only owner of a dynamic event @p e, that is,
+* the event is either freshly allocated or it is the event being processed
+* by the producer that was not delivered to any other AO (e.g., an event
+* received from another channel). Like QACTIVE_POST_X(), the event is
+* posted only if the channel has more than @p margin free slots, and
+* otherwise the function returns 'false' and recycles the event. The zero
+* @p margin asserts that the event was posted.
+*/
+bool QChannel_post(QChannel * const me, QEvt const * const e,
+                   uint_fast16_t const margin);
+
+/*! The number of events currently waiting in the channel */
+#define QChannel_getDepth(me_) \
+    ((uint_fast16_t)(__atomic_load_n(&(me_)->head, __ATOMIC_ACQUIRE) \
+                     - __atomic_load_n(&(me_)->tail, __ATOMIC_ACQUIRE)))
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! the reserved signal of the channel doorbell events */
+    #define QF_CHANNEL_SIG_  ((QSignal)0)
+
+    /*! dispatch the events waiting in the channel (consumer thread only) */
+    void QChannel_service_(QChannel * const me);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_channel_h */
@@ -0,0 +1,346 @@
+/**
+* @file
+* @brief Event serialization schema and codec (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_codec.h"     /* event codec interface */
+
+#include <string.h>       /* for memcpy() */
+
+Q_DEFINE_THIS_MODULE("qf_codec")
+
+/* Local objects -----------------------------------------------------------*/
+typedef struct {          /* codec entry of a signal */
+    QEvtSchema const *schema; /* the schema (NULL if not registered) */
+    uint16_t wireSize;    /* the encoded size of the fields [bytes] */
+    uint16_t podOffset;   /* offset of the fields for the POD fast path */
+    uint8_t  isPod;       /* wire layout == memory layout? see NOTE1 */
+} QCodecEntry;
+
+static QCodecEntry l_codec[QF_CODEC_MAX_SIG];
+
+/* the size of the field elements indexed by QFieldType */
+static uint8_t const l_elemSize[] = {
+    (uint8_t)1, (uint8_t)2, (uint8_t)4, (uint8_t)8,
+    (uint8_t)4, (uint8_t)8, (uint8_t)1
+};
+
+/*! the schema of events without parameters (plain ::QEvt) */
+QEvtSchema const QEvt_schema = {
+    "QEvt", (QEvtField const *)0, (uint16_t)0, (uint16_t)sizeof(QEvt)
+};
+
+static void codec_put(uint8_t * const dst, uint8_t const * const src,
+                      uint_fast16_t const size, uint_fast8_t const elem);
+static void codec_get(uint8_t * const dst, uint8_t const * const src,
+                      uint_fast16_t const size, uint_fast8_t const elem);
+
+/*..........................................................................*/
+/**
+* @description
+* Validates the @p schema and associates it with the signal @p sig.
+* Registering the same signal again replaces the previous schema.
+*
+* @note This function should be called during the initialization, before
+* the event codec is used by any thread.
+*/
+void QF_codecRegister(enum_t const sig, QEvtSchema const * const schema) {
+    static uint16_t const endian = (uint16_t)1;
+    QCodecEntry * const ent = &l_codec[sig];
+    uint_fast16_t next;
+    uint_fast16_t i;
+
+    /** @pre the signal must be in range and the schema must be provided */
+    Q_REQUIRE_ID(100, ((uint_fast16_t)sig < (uint_fast16_t)QF_CODEC_MAX_SIG)
+                      && (schema != (QEvtSchema const *)0));
+
+    ent->wireSize = (uint16_t)0;
+    ent->isPod = (uint8_t)(*(uint8_t const *)&endian == (uint8_t)1);
+    ent->podOffset = (schema->nFields != (uint16_t)0)
+                     ? schema->fields[0].offset
+                     : (uint16_t)sizeof(QEvt);
+    next = (uint_fast16_t)ent->podOffset;
+
+    for (i = (uint_fast16_t)0; i < (uint_fast16_t)schema->nFields; ++i) {
+        QEvtField const * const f = &schema->fields[i];
+
+        /** @pre every field must lie behind the ::QEvt header, inside
+        * the event and consist of whole elements of its wire type
+        */
+        Q_REQUIRE_ID(110, (f->type <= (uint8_t)QF_FLD_BYTES)
+            && (f->offset >= (uint16_t)sizeof(QEvt))
+            && ((uint_fast16_t)f->offset + (uint_fast16_t)f->size
+                <= (uint_fast16_t)schema->evtSize)
+            && ((f->size % l_elemSize[f->type]) == (uint16_t)0));
+
+        if ((uint_fast16_t)f->offset != next) {
+            ent->isPod = (uint8_t)0; /* padding or out of order */
+        }
+        next = (uint_fast16_t)f->offset + (uint_fast16_t)f->size;
+        ent->wireSize += f->size;
+    }
+    ent->schema = schema;
+}
+/*..........................................................................*/
+QEvtSchema const *QF_codecSchema(enum_t const sig) {
+    return ((uint_fast16_t)sig < (uint_fast16_t)QF_CODEC_MAX_SIG)
+           ? l_codec[sig].schema
+           : (QEvtSchema const *)0;
+}
+/*..........................................................................*/
+/**
+* @returns the number of bytes QF_encode() produces for an event with
+* the signal @p sig or zero if no schema is registered for the signal.
+*/
+uint_fast16_t QF_encodedSize(enum_t const sig) {
+    return (QF_codecSchema(sig) != (QEvtSchema const *)0)
+           ? ((uint_fast16_t)Q_SIGNAL_SIZE
+              + (uint_fast16_t)l_codec[sig].wireSize)
+           : (uint_fast16_t)0;
+}
+/*..........................................................................*/
+/**
+* @description
+* The event is encoded as its signal (Q_SIGNAL_SIZE bytes) followed by
+* the fields in the order of the schema. All multi-byte values are
+* encoded in the little-endian byte order, which is also the order used
+* by the QS protocol.
+*
+* @returns the number of bytes written to @p buf or zero if no schema is
+* registered for the signal of @p e or if @p buf is too small.
+*/
+uint_fast16_t QF_encode(QEvt const * const e,
+                        uint8_t * const buf, uint_fast16_t const bufSize)
+{
+    uint_fast16_t len = QF_encodedSize((enum_t)e->sig);
+    uint_fast16_t i;
+
+    if ((len != (uint_fast16_t)0) && (len <= bufSize)) {
+        QCodecEntry const * const ent = &l_codec[e->sig];
+        uint8_t const * const src = (uint8_t const *)e;
+        uint8_t *dst = &buf[Q_SIGNAL_SIZE];
+
+        for (i = (uint_fast16_t)0; i < (uint_fast16_t)Q_SIGNAL_SIZE; ++i) {
+            buf[i] = (uint8_t)((uint32_t)e->sig >> (8U * i));
+        }
+        if (ent->isPod != (uint8_t)0) { /* the fast path, see NOTE1 */
+            memcpy(dst, &src[ent->podOffset], (size_t)ent->wireSize);
+        }
+        else {
+            for (i = (uint_fast16_t)0;
+                 i < (uint_fast16_t)ent->schema->nFields;
+                 ++i)
+            {
+                QEvtField const * const f = &ent->schema->fields[i];
+                codec_put(dst, &src[f->offset], (uint_fast16_t)f->size,
+                          (uint_fast8_t)l_elemSize[f->type]);
+                dst = &dst[f->size];
+            }
+        }
+    }
+    else {
+        len = (uint_fast16_t)0;
+    }
+    return len;
+}
+/*..........................................................................*/
+/**
+* @description
+* Decodes the event encoded by QF_encode() directly into an event block
+* allocated from the event pools with QF_newX_(). The @p margin has the
+* same meaning as in Q_NEW_X(). In particular, the zero margin asserts
+* when no event is available in the pool.
+*
+* @returns the new event or NULL if the signal has no registered schema,
+* if @p buf is too short, or if the event could not be allocated.
+*/
+QEvt *QF_decode(uint8_t const * const buf, uint_fast16_t const len,
+                uint_fast16_t const margin)
+{
+    QEvt *e = (QEvt *)0;
+    uint32_t sig = (uint32_t)0;
+    uint_fast16_t i;
+
+    if (len >= (uint_fast16_t)Q_SIGNAL_SIZE) {
+        for (i = (uint_fast16_t)0; i < (uint_fast16_t)Q_SIGNAL_SIZE; ++i) {
+            sig |= ((uint32_t)buf[i] << (8U * i));
+        }
+        if ((QF_encodedSize((enum_t)sig) != (uint_fast16_t)0)
+            && (QF_encodedSize((enum_t)sig) <= len))
+        {
+            e = QF_newX_((uint_fast16_t)l_codec[sig].schema->evtSize,
+                         margin, (enum_t)sig);
+            if (e != (QEvt *)0) {
+                (void)QF_decodeFields(e, &buf[Q_SIGNAL_SIZE],
+                                      len - (uint_fast16_t)Q_SIGNAL_SIZE);
+            }
+        }
+    }
+    return e;
+}
+/*..........................................................................*/
+/**
+* @description
+* Decodes only the fields of an event, for which the signal is already
+* known and set in @p e. This is useful for event injectors, such as
+* the QS-RX event injection, which allocate the event before its
+* parameters are received.
+*
+* @returns 'true' if the fields could be decoded and 'false' when the
+* signal has no registered schema or @p buf is too short.
+*/
+bool QF_decodeFields(QEvt * const e, uint8_t const * const buf,
+                     uint_fast16_t const len)
+{
+    bool status = false;
+    uint_fast16_t i;
+
+    if ((QF_encodedSize((enum_t)e->sig) != (uint_fast16_t)0)
+        && ((uint_fast16_t)l_codec[e->sig].wireSize <= len))
+    {
+        QCodecEntry const * const ent = &l_codec[e->sig];
+        uint8_t * const dst = (uint8_t *)e;
+        uint8_t const *src = buf;
+
+        if (ent->isPod != (uint8_t)0) { /* the fast path, see NOTE1 */
+            memcpy(&dst[ent->podOffset], src, (size_t)ent->wireSize);
+        }
+        else {
+            for (i = (uint_fast16_t)0;
+                 i < (uint_fast16_t)ent->schema->nFields;
+                 ++i)
+            {
+                QEvtField const * const f = &ent->schema->fields[i];
+                codec_get(&dst[f->offset], src, (uint_fast16_t)f->size,
+                          (uint_fast8_t)l_elemSize[f->type]);
+                src = &src[f->size];
+            }
+        }
+        status = true;
+    }
+    return status;
+}
+/*..........................................................................*/
+static void codec_put(uint8_t * const dst, uint8_t const * const src,
+                      uint_fast16_t const size, uint_fast8_t const elem)
+{
+    uint_fast16_t i;
+    uint_fast8_t b;
+
+    if (elem == (uint_fast8_t)1) {
+        memcpy(dst, src, (size_t)size);
+    }
+    else {
+        for (i = (uint_fast16_t)0; i < size; i += elem) {
+            uint64_t v;
+            switch (elem) {
+                case 2U: {
+                    uint16_t x;
+                    memcpy(&x, &src[i], sizeof(x));
+                    v = (uint64_t)x;
+                    break;
+                }
+                case 4U: {
+                    uint32_t x;
+                    memcpy(&x, &src[i], sizeof(x));
+                    v = (uint64_t)x;
+                    break;
+                }
+                default: {
+                    memcpy(&v, &src[i], sizeof(v));
+                    break;
+                }
+            }
+            for (b = (uint_fast8_t)0; b < elem; ++b) {
+                dst[i + b] = (uint8_t)(v >> (8U * b));
+            }
+        }
+    }
+}
+/*..........................................................................*/
+static void codec_get(uint8_t * const dst, uint8_t const * const src,
+                      uint_fast16_t const size, uint_fast8_t const elem)
+{
+    uint_fast16_t i;
+    uint_fast8_t b;
+
+    if (elem == (uint_fast8_t)1) {
+        memcpy(dst, src, (size_t)size);
+    }
+    else {
+        for (i = (uint_fast16_t)0; i < size; i += elem) {
+            uint64_t v = (uint64_t)0;
+            for (b = (uint_fast8_t)0; b < elem; ++b) {
+                v |= ((uint64_t)src[i + b] << (8U * b));
+            }
+            switch (elem) {
+                case 2U: {
+                    uint16_t x = (uint16_t)v;
+                    memcpy(&dst[i], &x, sizeof(x));
+                    break;
+                }
+                case 4U: {
+                    uint32_t x = (uint32_t)v;
+                    memcpy(&dst[i], &x, sizeof(x));
+                    break;
+                }
+                default: {
+                    memcpy(&dst[i], &v, sizeof(v));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*****************************************************************************
+* NOTE1:
+* On a little-endian host, the wire format of an event, whose fields follow
+* each other without any padding in the order of the schema, is identical
+* to the memory image of these fields. Such "plain old data" events are
+* encoded and decoded with a single memcpy(). Other events are converted
+* field by field, which also covers big-endian hosts and padded structures.
+*/
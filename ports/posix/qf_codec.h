@@ -0,0 +1,158 @@
+/**
+* @file
+* @brief Event serialization schema and codec (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_codec_h
+#define qf_codec_h
+
+#include <stddef.h>  /* for offsetof() */
+
+#ifndef QF_CODEC_MAX_SIG
+    /*! The maximum signal (exclusive) that can have an event schema */
+    #define QF_CODEC_MAX_SIG  256U
+#endif
+
+/*! The wire types of the event fields */
+enum QFieldType {
+    QF_FLD_U8,            /*!< 8-bit integers (signed or unsigned) */
+    QF_FLD_U16,           /*!< 16-bit integers */
+    QF_FLD_U32,           /*!< 32-bit integers */
+    QF_FLD_U64,           /*!< 64-bit integers */
+    QF_FLD_F32,           /*!< IEEE-754 single precision floats */
+    QF_FLD_F64,           /*!< IEEE-754 double precision floats */
+    QF_FLD_BYTES          /*!< opaque bytes (e.g., char arrays) */
+};
+
+/*! Description of a single field of an event (see #QF_EVT_SCHEMA) */
+typedef struct {
+    uint16_t offset;      /*!< offset of the field in the event */
+    uint16_t size;        /*!< size of the field (all elements) [bytes] */
+    uint8_t  type;        /*!< the wire type of the elements (QFieldType) */
+} QEvtField;
+
+/*! Schema of a ::QEvt-derived event (see #QF_EVT_SCHEMA) */
+typedef struct {
+    char_t const *name;        /*!< the name of the event type */
+    QEvtField const *fields;   /*!< the fields in the wire order */
+    uint16_t nFields;          /*!< the number of fields */
+    uint16_t evtSize;          /*!< sizeof() of the event */
+} QEvtSchema;
+
+/*! Describe one field of the event @p type_ (for #QF_EVT_SCHEMA) */
+/**
+* @description
+* Array members are described with the type of their elements and are
+* encoded element by element.
+*/
+#define QF_EVT_FIELD(type_, member_, ftype_) \
+    { (uint16_t)offsetof(type_, member_), \
+      (uint16_t)sizeof(((type_ *)0)->member_), (uint8_t)(ftype_) },
+
+/*! Define the schema @c <type_>_schema from the field list @p fields_ */
+/**
+* @description
+* The field list is a macro, which applies its argument to every field
+* of the event that has to go on the wire, for example:
+* @code
+* typedef struct {
+*     QEvt super;
+*     uint8_t  philoNum;
+*     uint32_t timestamp;
+*     char_t   name[8];
+* } TableEvt;
+*
+* #define TABLE_EVT_FIELDS(F_) \
+*     F_(TableEvt, philoNum,  QF_FLD_U8)  \
+*     F_(TableEvt, timestamp, QF_FLD_U32) \
+*     F_(TableEvt, name,      QF_FLD_BYTES)
+*
+* QF_EVT_SCHEMA(TableEvt, TABLE_EVT_FIELDS);
+* @endcode
+* The event header (::QEvt) is never part of the field list, because only
+* its signal is transmitted and the receiver allocates a fresh event.
+*/
+#define QF_EVT_SCHEMA(type_, fields_) \
+    static QEvtField const type_##_fields_[] = { \
+        fields_(QF_EVT_FIELD) \
+    }; \
+    QEvtSchema const type_##_schema = { \
+        #type_, &type_##_fields_[0], \
+        (uint16_t)(sizeof(type_##_fields_) / sizeof(type_##_fields_[0])), \
+        (uint16_t)sizeof(type_) \
+    }
+
+/*! Declare the schema @c <type_>_schema defined by #QF_EVT_SCHEMA */
+#define QF_EVT_SCHEMA_DECL(type_) extern QEvtSchema const type_##_schema
+
+/*! The schema of events without parameters (register it as QEvt) */
+QF_EVT_SCHEMA_DECL(QEvt);
+
+/*! Associate the signal @p sig_ with the schema of the event type @p type_ */
+/**
+* @description
+* Besides registering the schema with the codec, this macro produces the
+* QS signal dictionary entry for @p sig_, so that the signals of
+* the events going through the codec are always known to QSPY. The schema
+* defined in another module must be declared there with #QF_EVT_SCHEMA_DECL.
+*/
+#define QF_CODEC_REGISTER(sig_, type_) do { \
+    QF_codecRegister((enum_t)(sig_), &type_##_schema); \
+    QS_SIG_DICTIONARY((sig_), (void *)0); \
+} while (0)
+
+/*! Associate the signal @p sig with the event @p schema */
+void QF_codecRegister(enum_t const sig, QEvtSchema const * const schema);
+
+/*! Obtain the schema registered for the signal @p sig (or NULL) */
+QEvtSchema const *QF_codecSchema(enum_t const sig);
+
+/*! The size of the encoded event with the signal @p sig [bytes] */
+uint_fast16_t QF_encodedSize(enum_t const sig);
+
+/*! Encode the event @p e (signal and fields) into @p buf */
+uint_fast16_t QF_encode(QEvt const * const e,
+                        uint8_t * const buf, uint_fast16_t const bufSize);
+
+/*! Decode an event from @p buf into a freshly allocated pool event */
+QEvt *QF_decode(uint8_t const * const buf, uint_fast16_t const len,
+                uint_fast16_t const margin);
+
+/*! Decode just the fields of an event (no signal) into the event @p e */
+bool QF_decodeFields(QEvt * const e, uint8_t const * const buf,
+                     uint_fast16_t const len);
+
+#endif /* qf_codec_h */
@@ -0,0 +1,144 @@
+/**
+* @file
+* @brief Batched datagram receive into pool events for the QF/C port to POSIX
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define _GNU_SOURCE       /* for recvmmsg() */
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#include "qf_dgram.h"     /* batched datagram receiver interface */
+
+#include <stddef.h>       /* for offsetof() */
+
+Q_DEFINE_THIS_MODULE("qf_dgram")
+
+/*..........................................................................*/
+void QDgramRx_ctor(QDgramRx * const me, int const fd,
+                   QActive * const act, enum_t const sig,
+                   uint_fast16_t const evtSize, uint_fast16_t const batch)
+{
+    /** @pre the consumer AO and the signal must be valid, the events must
+    * have room for some payload and the batch must fit the headers
+    */
+    Q_REQUIRE_ID(100, (act != (QActive *)0)
+        && (sig >= (enum_t)Q_USER_SIG)
+        && (evtSize > (uint_fast16_t)offsetof(QDgramEvt, payload))
+        && ((uint_fast16_t)0 < batch)
+        && (batch <= (uint_fast16_t)QF_DGRAM_BATCH_MAX));
+
+    QF_bzero(me, (uint_fast16_t)sizeof(*me));
+    me->act      = act;
+    me->fd       = fd;
+    me->sig      = (QSignal)sig;
+    me->evtSize  = (uint16_t)evtSize;
+    me->batch    = (uint16_t)batch;
+}
+/*..........................................................................*/
+#ifndef Q_SPY
+int QDgramRx_recv(QDgramRx * const me)
+#else
+int QDgramRx_recv(QDgramRx * const me, void const * const sender)
+#endif
+{
+    struct mmsghdr msg[QF_DGRAM_BATCH_MAX]; /* recvmmsg() headers */
+    struct iovec iov[QF_DGRAM_BATCH_MAX];   /* payload I/O vectors */
+    uint_fast16_t i;
+    int n;
+
+    /* top up the pre-allocated events (without exhausting the pools) */
+    while (me->nEvt < me->batch) {
+        QDgramEvt *e = (QDgramEvt *)QF_newX_((uint_fast16_t)me->evtSize,
+                                             (uint_fast16_t)1,
+                                             (enum_t)me->sig);
+        if (e == (QDgramEvt *)0) {
+            break;
+        }
+        me->evt[me->nEvt] = e;
+        ++me->nEvt;
+    }
+
+    if (me->nEvt == (uint16_t)0) { /* no events at all? */
+        ++me->nStarved; /* leave the datagrams in the socket buffer */
+        n = 0;
+    }
+    else {
+        for (i = (uint_fast16_t)0; i < (uint_fast16_t)me->nEvt; ++i) {
+            struct msghdr *hdr = &msg[i].msg_hdr;
+            iov[i].iov_base     = &me->evt[i]->payload[0];
+            iov[i].iov_len      = (size_t)me->evtSize
+                                  - offsetof(QDgramEvt, payload);
+            hdr->msg_name       = &me->evt[i]->from;
+            hdr->msg_namelen    = (socklen_t)sizeof(me->evt[i]->from);
+            hdr->msg_iov        = &iov[i];
+            hdr->msg_iovlen     = (size_t)1;
+            hdr->msg_control    = (void *)0;
+            hdr->msg_controllen = (size_t)0;
+            hdr->msg_flags      = 0;
+        }
+
+        n = recvmmsg(me->fd, &msg[0], (unsigned)me->nEvt,
+                     MSG_DONTWAIT, (struct timespec *)0);
+
+        if (n > 0) {
+            /* post the filled events in the order of reception... */
+            for (i = (uint_fast16_t)0; i < (uint_fast16_t)n; ++i) {
+                QDgramEvt *e = me->evt[i];
+                e->len = (uint32_t)msg[i].msg_len; /* truncated to fit */
+                e->isTrunc = ((msg[i].msg_hdr.msg_flags & MSG_TRUNC) != 0);
+
+                /* QACTIVE_POST() asserts internally if the queue overflows */
+                QACTIVE_POST(me->act, &e->super, sender);
+            }
+
+            /* ...and keep the unused ones for the next call */
+            for (i = (uint_fast16_t)n; i < (uint_fast16_t)me->nEvt; ++i) {
+                me->evt[i - (uint_fast16_t)n] = me->evt[i];
+            }
+            me->nEvt -= (uint16_t)n;
+        }
+    }
+    return n; /* -1 and errno set to EAGAIN when nothing was pending */
+}
+/*..........................................................................*/
+void QDgramRx_xtor(QDgramRx * const me) {
+    while (me->nEvt > (uint16_t)0) {
+        --me->nEvt;
+        QF_gc(&me->evt[me->nEvt]->super); /* never posted, so recycled */
+    }
+}
@@ -0,0 +1,109 @@
+/**
+* @file
+* @brief Batched datagram receive into pool events for the QF/C port to POSIX
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_dgram_h
+#define qf_dgram_h
+
+#include <sys/socket.h> /* for struct sockaddr */
+#include <netinet/in.h> /* for struct sockaddr_in and sockaddr_in6 */
+
+#ifndef QF_DGRAM_BATCH_MAX
+    /*! The maximum number of datagrams received in one system call */
+    #define QF_DGRAM_BATCH_MAX 32U
+#endif
+
+/*! Datagram event: the payload is received directly behind the header */
+/**
+* @description
+* The events are allocated from the QF event pools, so the maximum payload
+* that fits into a ::QDgramEvt is the block size of the pool used (as given
+* by the @c evtSize parameter of QDgramRx_ctor()) less the header. A longer
+* datagram is truncated to that payload (with @c isTrunc set) and the rest
+* of it is discarded by the kernel.
+*/
+typedef struct {
+    QEvt super;     /*!< inherits ::QEvt */
+    union {
+        struct sockaddr     sa;
+        struct sockaddr_in  in;
+        struct sockaddr_in6 in6;
+    } from;         /*!< the source address of the datagram */
+    uint32_t len;   /*!< the number of payload bytes received (at most the
+                    * payload that fits, see @c isTrunc) */
+    bool isTrunc;   /*!< the datagram was longer than @c len (MSG_TRUNC) */
+    uint8_t payload[]; /*!< the payload (up to the end of the pool block) */
+} QDgramEvt;
+
+/*! Batched datagram receiver */
+/**
+* @description
+* ::QDgramRx keeps up to @c batch pool events pre-allocated and receives
+* a whole batch of datagrams into them with a single recvmmsg(2) call.
+* The filled events are then posted to the consumer AO, while the events
+* left unused stay allocated for the next call, so no payload is copied and
+* no per-datagram system call is needed.
+*/
+typedef struct {
+    QActive *act;        /*!< the consumer AO of the datagram events */
+    QDgramEvt *evt[QF_DGRAM_BATCH_MAX]; /*!< pre-allocated events */
+    int fd;              /*!< the datagram socket */
+    uint16_t evtSize;    /*!< size of the allocated events (pool block) */
+    uint16_t batch;      /*!< the number of datagrams per system call */
+    uint16_t nEvt;       /*!< the number of pre-allocated events */
+    QSignal sig;         /*!< the signal of the datagram events */
+    uint32_t nStarved;   /*!< # calls that found no events available */
+} QDgramRx;
+
+/*! The "constructor" of the batched datagram receiver */
+void QDgramRx_ctor(QDgramRx * const me, int const fd,
+                   QActive * const act, enum_t const sig,
+                   uint_fast16_t const evtSize, uint_fast16_t const batch);
+
+/*! Receive a batch of datagrams and post them to the consumer AO */
+#ifdef Q_SPY
+int QDgramRx_recv(QDgramRx * const me, void const * const sender);
+#define QDGRAMRX_RECV(me_, sender_) (QDgramRx_recv((me_), (sender_)))
+#else
+int QDgramRx_recv(QDgramRx * const me);
+#define QDGRAMRX_RECV(me_, dummy_)  (QDgramRx_recv(me_))
+#endif
+
+/*! Return the pre-allocated events to the pools */
+void QDgramRx_xtor(QDgramRx * const me);
+
+#endif /* qf_dgram_h */
@@ -0,0 +1,203 @@
+/**
+* @file
+* @brief Independent QF domains (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define _GNU_SOURCE       /* for pthread_setaffinity_np() */
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+
+#ifdef QF_MAX_DOMAIN      /* independent QF domains configured? */
+
+#include "qf_domain.h"    /* independent QF domains interface */
+
+#include <sched.h>        /* for CPU_SET() */
+#include <string.h>       /* for memcpy() */
+
+Q_DEFINE_THIS_MODULE("qf_domain")
+
+typedef struct {          /* the thread running the main_ of a domain */
+    pthread_t thread;
+    int_t (*main_)(void);
+    int_t result;
+    int cpu;
+    uint8_t domain;
+} QDomainThread;
+
+static QDomainThread l_thread[QF_MAX_DOMAIN];
+#ifdef Q_SPY
+static uint8_t const l_domainPost = 0U; /* unique sender object for QS */
+#endif
+
+static void *domain_routine(void *arg);
+
+/*..........................................................................*/
+void QF_domainEnter(uint_fast8_t const domain) {
+    /** @pre the domain must be in range */
+    Q_REQUIRE_ID(100, domain < (uint_fast8_t)QF_MAX_DOMAIN);
+    QF_domainId_ = (uint8_t)domain;
+}
+/*..........................................................................*/
+uint_fast8_t QF_domainSelf(void) {
+    return (uint_fast8_t)QF_domainId_;
+}
+/*..........................................................................*/
+uint_fast8_t QF_domainOf(QActive const * const act) {
+    uint_fast8_t d;
+
+    for (d = (uint_fast8_t)0; d < (uint_fast8_t)QF_MAX_DOMAIN; ++d) {
+        if (QF_domainActive_[d][act->prio] == act) {
+            break;
+        }
+    }
+
+    /** @post the AO must be started in one of the domains */
+    Q_ENSURE_ID(290, d < (uint_fast8_t)QF_MAX_DOMAIN);
+    return d;
+}
+/*..........................................................................*/
+void QF_domainSpawn(uint_fast8_t const domain, int_t (*main_)(void),
+                    int const cpu)
+{
+    QDomainThread * const t = &l_thread[domain];
+
+    /** @pre the domain must be in range and not running yet */
+    Q_REQUIRE_ID(300, (domain < (uint_fast8_t)QF_MAX_DOMAIN)
+                      && (t->main_ == (int_t (*)(void))0)
+                      && (main_ != (int_t (*)(void))0));
+
+    t->main_  = main_;
+    t->cpu    = cpu;
+    t->domain = (uint8_t)domain;
+    Q_ALLEGE_ID(310, pthread_create(&t->thread, (pthread_attr_t *)0,
+                                    &domain_routine, (void *)t) == 0);
+}
+/*..........................................................................*/
+int_t QF_domainJoin(uint_fast8_t const domain) {
+    QDomainThread * const t = &l_thread[domain];
+
+    /** @pre the domain must be in range and spawned */
+    Q_REQUIRE_ID(400, (domain < (uint_fast8_t)QF_MAX_DOMAIN)
+                      && (t->main_ != (int_t (*)(void))0));
+
+    (void)pthread_join(t->thread, (void **)0);
+    t->main_ = (int_t (*)(void))0; /* the domain can be spawned again */
+    return t->result;
+}
+/*..........................................................................*/
+static void *domain_routine(void *arg) { /* the expected POSIX signature */
+    QDomainThread * const t = (QDomainThread *)arg;
+
+    QF_domainId_ = t->domain;
+    if (t->cpu >= 0) { /* pin the domain to a CPU? */
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(t->cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)
+            == 0)
+        {
+            /* success, all threads of the domain will run on this CPU */
+        }
+        else {
+            /* the CPU is not available, the domain runs unpinned */
+        }
+    }
+    t->result = (*t->main_)();
+    return (void *)0; /* return success */
+}
+/*..........................................................................*/
+bool QF_domainPost(QActive * const act, QEvt const * const e,
+                   uint_fast16_t const margin)
+{
+    uint_fast8_t const self = (uint_fast8_t)QF_domainId_;
+    uint_fast8_t const dst  = QF_domainOf(act);
+    bool posted;
+
+    /* same domain or immutable event? */
+    if ((dst == self) || (e->poolId_ == (uint8_t)0)) {
+        QF_domainId_ = (uint8_t)dst; /* post under the lock of the target */
+        posted = QACTIVE_POST_X(act, e, margin, &l_domainPost);
+        QF_domainId_ = (uint8_t)self;
+    }
+    else { /* dynamic event from another domain, see NOTE1 */
+        uint_fast16_t const size = (uint_fast16_t)
+            QF_EPOOL_EVENT_SIZE_(QF_pool_[e->poolId_ - (uint8_t)1]);
+        QEvt *copy;
+        QF_CRIT_STAT_
+
+        QF_domainId_ = (uint8_t)dst; /* allocate from the target's pools */
+        copy = QF_newX_(size, margin, (enum_t)e->sig);
+        if (copy != (QEvt *)0) {
+            memcpy((uint8_t *)copy + sizeof(QEvt),
+                   (uint8_t const *)e + sizeof(QEvt),
+                   size - sizeof(QEvt));
+            posted = QACTIVE_POST_X(act, copy, margin, &l_domainPost);
+        }
+        else {
+            posted = false;
+        }
+        QF_domainId_ = (uint8_t)self;
+
+        /* recycle the original in its own domain */
+        QF_CRIT_ENTRY_();
+        QF_EVT_REF_CTR_INC_(e);
+        QF_CRIT_EXIT_();
+        QF_gc(e);
+    }
+    return posted;
+}
+
+/*****************************************************************************
+* NOTE1:
+* Each domain recycles events only into its own pools, under its own
+* critical section, so a dynamic event must never be referenced by two
+* domains at once. The event is therefore copied into the pools of the
+* target domain (the whole block of the source pool, which covers the
+* event and its parameters). The reference counter of the original is
+* incremented before QF_gc(), so that an event posted from within its own
+* RTC step is not recycled before the step ends, while a freshly allocated
+* event (reference counter 0) goes back to its pool right away.
+*/
+
+#endif /* QF_MAX_DOMAIN */
@@ -0,0 +1,89 @@
+/**
+* @file
+* @brief Independent QF domains (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_domain_h
+#define qf_domain_h
+
+/*! Bind the calling thread to the QF domain @p domain */
+/**
+* @description
+* All QF services called from the thread afterwards (QF_init(), event pool
+* and AO initialization, QF_run(), posting, etc.) operate on the objects
+* of the given domain. The threads created by the port inherit the domain
+* of their creator. See NOTE3 in qf_port.h.
+*/
+void QF_domainEnter(uint_fast8_t const domain);
+
+/*! The QF domain of the calling thread */
+uint_fast8_t QF_domainSelf(void);
+
+/*! The QF domain of the started active object @p act */
+uint_fast8_t QF_domainOf(QActive const * const act);
+
+/*! Run @p main_ in a new thread of the domain @p domain */
+/**
+* @description
+* The function @p main_ typically initializes the domain (QF_init(), event
+* pools, publish-subscribe, AOs) and returns the result of QF_run(), just
+* like main() of a single-domain application. When @p cpu is not negative,
+* the thread is pinned to the given CPU before @p main_ is called, so all
+* threads of the domain (which inherit the affinity) run on that CPU.
+*/
+void QF_domainSpawn(uint_fast8_t const domain, int_t (*main_)(void),
+                    int const cpu);
+
+/*! Wait for the @p main_ of the domain to return and get its result */
+int_t QF_domainJoin(uint_fast8_t const domain);
+
+/*! Post an event to the active object @p act of any QF domain */
+/**
+* @description
+* Posting to an AO of the calling thread's own domain is equivalent to
+* QACTIVE_POST_X(). A dynamic event posted to another domain is copied
+* into the event pools of the target domain (which must have a block size
+* large enough) and the original is recycled, so that each domain manages
+* only its own events. Immutable (static) events are posted as they are.
+*
+* @returns 'true' if the event was posted, 'false' if the queue or the
+* event pools of the target domain could not provide the @p margin (in
+* which case the event is recycled). The zero @p margin asserts instead.
+*/
+bool QF_domainPost(QActive * const act, QEvt const * const e,
+                   uint_fast16_t const margin);
+
+#endif /* qf_domain_h */
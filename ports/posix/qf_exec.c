@@ -0,0 +1,318 @@
+/**
+* @file
+* @brief Offload executor (worker thread pool) for the QF/C port to POSIX
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_exec.h"      /* offload executor interface */
+
+#include <time.h>         /* for clock_gettime() */
+
+Q_DEFINE_THIS_MODULE("qf_exec")
+
+static void *worker(void *arg);
+static uint64_t exec_nsNow(void);
+
+/*..........................................................................*/
+void QExecutor_start(QExecutor * const me, uint_fast8_t const nWorkers,
+                     QEvt const *qSto[], uint_fast16_t const qLen,
+                     uint_fast32_t const stkSize)
+{
+    pthread_attr_t attr;
+    uint_fast8_t n;
+
+    /** @pre the number of workers must be in range */
+    Q_REQUIRE_ID(100, ((uint_fast8_t)0 < nWorkers)
+                      && (nWorkers <= (uint_fast8_t)QF_EXEC_MAX_WORKERS));
+
+    QF_bzero(me, (uint_fast16_t)sizeof(*me));
+    QEQueue_init(&me->queue, qSto, qLen);
+    pthread_cond_init(&me->cond, 0);
+    me->nWorkers  = (uint8_t)nWorkers;
+    me->isRunning = (uint8_t)1;
+
+    /* the workers run at the default (non real-time) priority, so that
+    * the offloaded jobs never compete with the AOs and the ticker
+    */
+    pthread_attr_init(&attr);
+    if (stkSize != (uint_fast32_t)0) {
+        pthread_attr_setstacksize(&attr, (size_t)stkSize);
+    }
+    for (n = (uint_fast8_t)0; n < nWorkers; ++n) {
+        Q_ALLEGE_ID(110, pthread_create(&me->thread[n], &attr,
+                                        &worker, me) == 0);
+    }
+    pthread_attr_destroy(&attr);
+}
+/*..........................................................................*/
+/**
+* @description
+* Waits until every worker has finished the job it is running (the replies
+* of those jobs are posted as usual) and has exited. The jobs still waiting
+* in the queue are recycled without running and without any reply. After
+* the function returns, no job handler of the executor is running and the
+* executor can be started again with QExecutor_start().
+*
+* @note Must not be called from a job handler of the same executor.
+*/
+void QExecutor_stop(QExecutor * const me) {
+    QEvt const *e;
+    uint_fast8_t n;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    me->isRunning = (uint8_t)0;
+    pthread_cond_broadcast(&me->cond); /* let all idle workers exit */
+    QF_CRIT_EXIT_();
+
+    for (n = (uint_fast8_t)0; n < (uint_fast8_t)me->nWorkers; ++n) {
+        Q_ALLEGE_ID(120, pthread_join(me->thread[n], (void **)0) == 0);
+    }
+
+    /* recycle the jobs that have never run */
+    for (e = QEQueue_get(&me->queue); e != (QEvt const *)0;
+         e = QEQueue_get(&me->queue))
+    {
+        ++me->nCanceled;
+        QF_gc(e); /* drop the reference held by the queue */
+    }
+    pthread_cond_destroy(&me->cond);
+}
+/*..........................................................................*/
+/**
+* @description
+* The job must be a dynamic event with the signal set to the reply signal
+* and the job handler set. The job is posted back to the AO @p act after
+* the handler has completed. The @p margin has the same meaning as in
+* QACTIVE_POST_X(): when the job cannot be queued with the @p margin of
+* free queue entries left, the job is recycled and the function returns
+* 'false'. With @p margin of zero the function asserts instead.
+*/
+bool QExecutor_submit(QExecutor * const me, QJob * const job,
+                      QActive * const act, uint_fast16_t const margin)
+{
+    bool status;
+    QF_CRIT_STAT_
+
+    /** @pre the job must be a dynamic event with a handler */
+    Q_REQUIRE_ID(200, (job->super.poolId_ != (uint8_t)0)
+                      && (job->handler != (QJobHandler)0)
+                      && (act != (QActive *)0));
+
+    job->act    = act;
+    job->state  = (uint8_t)QJOB_QUEUED;
+    job->runUs  = (uint32_t)0;
+    job->tStamp = exec_nsNow(); /* the start of the wait in the queue */
+    status = QEQueue_post(&me->queue, &job->super, margin);
+
+    QF_CRIT_ENTRY_();
+    if (status) {
+        ++me->nSubmitted;
+        pthread_cond_signal(&me->cond); /* wake up one idle worker */
+    }
+    QF_CRIT_EXIT_();
+
+    if (!status) {
+        QF_gc(&job->super); /* recycle the job to avoid a leak */
+    }
+    return status;
+}
+/*..........................................................................*/
+/**
+* @description
+* A job that has not been picked up by a worker yet is canceled for good:
+* its handler will never run, the job is recycled by the executor and no
+* reply is posted. A job whose handler is already running is only flagged,
+* so that the handler can poll QJob_isCanceled() and finish early. Such
+* a job is still posted back (with the ::QJOB_CANCELED state).
+*
+* @returns 'true' if the job was canceled before it started (no reply
+* will follow) and 'false' otherwise (a reply will follow or has already
+* been posted).
+*
+* @note The job is looked up only by its pointer value, so the function
+* must be called only by the submitting AO before it has handled the reply
+* of the job. After that the job is recycled and its memory can be reused
+* by another job, which would be canceled instead.
+*/
+bool QExecutor_cancel(QExecutor * const me, QJob const * const job) {
+    bool canceled = false;
+    uint_fast8_t n;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    if (me->queue.frontEvt == &job->super) {
+        canceled = true;
+    }
+    else if (me->queue.frontEvt != (QEvt const *)0) {
+        QEQueueCtr i = me->queue.tail;
+        QEQueueCtr nUsed = me->queue.end - me->queue.nFree; /* in ring */
+
+        for (; (nUsed > (QEQueueCtr)0) && (!canceled); --nUsed) {
+            canceled = (QF_PTR_AT_(me->queue.ring, i) == &job->super);
+            if (i == (QEQueueCtr)0) { /* need to wrap? */
+                i = me->queue.end;
+            }
+            --i;
+        }
+    }
+    else {
+        /* empty queue, the job can only be running */
+    }
+
+    if (canceled) {
+        ((QJob *)job)->state = (uint8_t)QJOB_CANCELED; /* never to run */
+        ++me->nCanceled;
+    }
+    else {
+        for (n = (uint_fast8_t)0; n < (uint_fast8_t)me->nWorkers; ++n) {
+            if (me->running[n] == job) {
+                ((QJob *)job)->state = (uint8_t)QJOB_CANCELED; /* flag it */
+            }
+        }
+    }
+    QF_CRIT_EXIT_();
+
+    return canceled;
+}
+/*..........................................................................*/
+uint_fast16_t QExecutor_getDepth(QExecutor * const me) {
+    uint_fast16_t depth;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    depth = (uint_fast16_t)(me->queue.end + (QEQueueCtr)1
+                            - me->queue.nFree);
+    QF_CRIT_EXIT_();
+
+    return depth;
+}
+
+/*..........................................................................*/
+static void *worker(void *arg) { /* the expected POSIX signature */
+    QExecutor * const me = (QExecutor *)arg;
+    uint_fast8_t idx;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    idx = (uint_fast8_t)me->nStarted; /* this worker's slot in running[] */
+    ++me->nStarted;
+    QF_CRIT_EXIT_();
+
+    for (;;) {
+        QJob *job;
+        uint64_t t1;
+        bool run;
+#ifdef Q_SPY
+        uint16_t depth;
+#endif
+
+        /* wait for a job (the condition variable uses the QF mutex) */
+        QF_CRIT_ENTRY_();
+        while (QEQueue_isEmpty(&me->queue) && (me->isRunning != 0U)) {
+            pthread_cond_wait(&me->cond, &QF_pThreadMutex_);
+        }
+        if (me->isRunning == 0U) {
+            QF_CRIT_EXIT_();
+            break;
+        }
+        QF_CRIT_EXIT_();
+
+        job = (QJob *)QEQueue_get(&me->queue);
+        if (job == (QJob *)0) { /* another worker was faster? */
+            continue;
+        }
+
+        QF_CRIT_ENTRY_();
+        run = (job->state != (uint8_t)QJOB_CANCELED);
+        if (run) {
+            job->state = (uint8_t)QJOB_RUNNING;
+            me->running[idx] = job;
+        }
+        QF_CRIT_EXIT_();
+
+        if (run) {
+            t1 = exec_nsNow();
+            job->waitUs = (uint32_t)((t1 - job->tStamp) / 1000U);
+
+            (*job->handler)(job); /* run the job outside the RTC step */
+
+            job->tStamp = exec_nsNow();
+            job->runUs  = (uint32_t)((job->tStamp - t1) / 1000U);
+
+            QF_CRIT_ENTRY_();
+            me->running[idx] = (QJob *)0;
+            if (job->state == (uint8_t)QJOB_RUNNING) {
+                job->state = (uint8_t)QJOB_DONE;
+            }
+            ++me->nDone;
+#ifdef Q_SPY
+            depth = (uint16_t)(me->queue.end + (QEQueueCtr)1
+                               - me->queue.nFree);
+#endif
+            QF_CRIT_EXIT_();
+
+            QS_BEGIN(QS_PORT_EXEC_JOB, job->act)
+                QS_OBJ(job->act);           /* the submitting AO */
+                QS_SIG(job->super.sig, job->act); /* the reply signal */
+                QS_U32(0, job->waitUs);     /* time waiting in queue [us] */
+                QS_U32(0, job->runUs);      /* time running [us] */
+                QS_U16(0, depth);           /* jobs still waiting */
+                QS_U8(0, job->state);       /* done or canceled */
+            QS_END()
+
+            /* QACTIVE_POST() asserts internally if the queue overflows */
+            QACTIVE_POST(job->act, &job->super, me);
+        }
+        QF_gc(&job->super); /* drop the reference held by the queue */
+    }
+    return (void *)0; /* return success */
+}
+/*..........................................................................*/
+static uint64_t exec_nsNow(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,125 @@
+/**
+* @file
+* @brief Offload executor (worker thread pool) for the QF/C port to POSIX
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_exec_h
+#define qf_exec_h
+
+#ifndef QF_EXEC_MAX_WORKERS
+    /*! The maximum number of worker threads of a ::QExecutor */
+    #define QF_EXEC_MAX_WORKERS 8U
+#endif
+
+/*! States of an offloaded job (see ::QJob) */
+enum QJobState {
+    QJOB_QUEUED,   /*!< the job waits in the executor queue */
+    QJOB_RUNNING,  /*!< the job function runs in a worker thread */
+    QJOB_DONE,     /*!< the job function has returned */
+    QJOB_CANCELED  /*!< the job has been canceled, see QExecutor_cancel() */
+};
+
+struct QJob; /* forward declaration */
+
+/*! Job function executed in a worker thread of a ::QExecutor */
+typedef void (*QJobHandler)(struct QJob * const job);
+
+/*! Offloaded job, which is also the event carrying the result back */
+/**
+* @description
+* A job is a dynamic event allocated by the submitting AO, typically with
+* a derived structure that adds the job inputs and outputs (see @ref oop).
+* The signal of the job event is the reply signal: after the job handler
+* has run in a worker thread, the very same event is posted back to the
+* submitting AO, so offloading a job requires no additional allocation.
+*/
+typedef struct QJob {
+    QEvt super;              /*!< inherits ::QEvt (signal = reply signal) */
+    QJobHandler handler;     /*!< the job function */
+    QActive *act;            /*!< the submitting AO (receives the reply) */
+    uint8_t volatile state;  /*!< the job state (::QJobState) */
+    uint32_t waitUs;         /*!< time spent in the queue [us] */
+    uint32_t runUs;          /*!< time spent in the job handler [us] */
+    uint64_t tStamp;         /*!< internal time stamp [ns] */
+} QJob;
+
+/*! Offload executor: a bounded pool of worker threads */
+/**
+* @description
+* The pending jobs are kept in a thread-safe "raw" ::QEQueue, whose length
+* bounds the number of jobs that can be outstanding at any given time.
+* The statistics counters can be read at any time, but are only updated
+* by the executor.
+*/
+typedef struct {
+    QEQueue queue;           /*!< the queue of pending jobs */
+    pthread_cond_t cond;     /*!< signals the idle workers */
+    pthread_t thread[QF_EXEC_MAX_WORKERS]; /*!< the worker threads */
+    QJob * volatile running[QF_EXEC_MAX_WORKERS]; /*!< jobs being run */
+    uint8_t nWorkers;        /*!< the number of worker threads */
+    uint8_t nStarted;        /*!< the number of workers started so far */
+    uint8_t volatile isRunning; /*!< the workers keep running while set */
+    uint32_t volatile nSubmitted; /*!< # jobs submitted so far */
+    uint32_t volatile nDone;      /*!< # jobs completed so far */
+    uint32_t volatile nCanceled;  /*!< # jobs canceled so far */
+} QExecutor;
+
+/*! Start the executor with @p nWorkers worker threads */
+void QExecutor_start(QExecutor * const me, uint_fast8_t const nWorkers,
+                     QEvt const *qSto[], uint_fast16_t const qLen,
+                     uint_fast32_t const stkSize);
+
+/*! Stop the worker threads of the executor and wait for them to exit */
+void QExecutor_stop(QExecutor * const me);
+
+/*! Submit a job on behalf of the active object @p act */
+bool QExecutor_submit(QExecutor * const me, QJob * const job,
+                      QActive * const act, uint_fast16_t const margin);
+
+/*! Cancel a submitted job */
+bool QExecutor_cancel(QExecutor * const me, QJob const * const job);
+
+/*! The number of jobs currently waiting in the executor queue */
+uint_fast16_t QExecutor_getDepth(QExecutor * const me);
+
+/*! The maximum number of jobs ever waiting in the executor queue */
+#define QExecutor_getMaxDepth(me_) \
+    ((uint_fast16_t)((me_)->queue.end + (QEQueueCtr)1 - (me_)->queue.nMin))
+
+/*! Check in a job handler whether the job is being canceled */
+#define QJob_isCanceled(job_) ((job_)->state == (uint8_t)QJOB_CANCELED)
+
+#endif /* qf_exec_h */
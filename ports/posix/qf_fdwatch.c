@@ -0,0 +1,249 @@
+/**
+* @file
+* @brief File-descriptor watcher service for the QF/C port to POSIX (Linux)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#include "qf_fdwatch.h"   /* file-descriptor watcher interface */
+
+#include <errno.h>        /* for errno and EINTR */
+#include <sys/epoll.h>    /* for epoll_create1(), epoll_ctl(), epoll_wait() */
+
+Q_DEFINE_THIS_MODULE("qf_fdwatch")
+
+/* Local objects -----------------------------------------------------------*/
+static int l_epfd = -1;   /* the epoll instance of the watcher thread */
+static pthread_once_t l_fdwOnce = PTHREAD_ONCE_INIT;
+
+enum { FDW_MAX_EVENTS = 16 }; /* max # descriptors reported per wakeup */
+
+#ifdef Q_SPY
+static uint8_t const l_fdWatcher = 0U; /* unique sender object for QS */
+#endif
+
+static void fdw_start(void);
+static void *fdw_thread(void *arg);
+static void fdw_report(QFdWatch * const me, uint32_t const events);
+static uint32_t fdw_epollEvents(QFdWatch const * const me);
+
+/*..........................................................................*/
+void QFdWatch_ctor(QFdWatch * const me, QActive * const act,
+                   enum_t const sig, uint8_t const flags)
+{
+    /** @pre the AO must be valid, the signal must be a user signal and
+    * an edge-triggered watch must not repost its static event, see NOTE2
+    * in qf_fdwatch.h
+    */
+    Q_REQUIRE_ID(100, (act != (QActive *)0)
+        && (sig >= (enum_t)Q_USER_SIG)
+        && (((flags & (uint8_t)QF_FDW_EDGE) == (uint8_t)0)
+            || ((flags & (uint8_t)(QF_FDW_ONESHOT | QF_FDW_POOL))
+                != (uint8_t)0)));
+
+    me->act      = act;
+    me->fd       = -1;
+    me->flags    = flags;
+    me->interest = (uint8_t)0;
+
+    me->evt.super.sig     = (QSignal)sig;
+    me->evt.super.poolId_ = (uint8_t)0; /* static event */
+    me->evt.super.refCtr_ = (uint8_t)0;
+    me->evt.watch = me;
+    me->evt.fd    = -1;
+    me->evt.ready = (uint8_t)0;
+}
+/*..........................................................................*/
+bool QFdWatch_add(QFdWatch * const me, int const fd,
+                  uint8_t const interest)
+{
+    struct epoll_event ev;
+    bool added;
+    QF_CRIT_STAT_
+
+    /** @pre the watch must be constructed and not watching any descriptor,
+    * the descriptor must be valid and some interest must be specified
+    */
+    Q_REQUIRE_ID(200, (me->act != (QActive *)0)
+                      && (me->fd < 0)
+                      && (fd >= 0)
+                      && ((interest & (uint8_t)(QF_FD_READ | QF_FD_WRITE))
+                          != (uint8_t)0));
+
+    (void)pthread_once(&l_fdwOnce, &fdw_start); /* start the service */
+
+    QF_CRIT_ENTRY_();
+    me->fd       = fd;
+    me->interest = interest;
+    QF_CRIT_EXIT_();
+
+    ev.events   = fdw_epollEvents(me);
+    ev.data.ptr = me;
+    if (epoll_ctl(l_epfd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+        added = true;
+    }
+    else { /* invalid descriptor, already watched, etc. (see errno) */
+        QF_CRIT_ENTRY_();
+        me->fd = -1;
+        QF_CRIT_EXIT_();
+        added = false;
+    }
+    return added;
+}
+/*..........................................................................*/
+bool QFdWatch_rearm(QFdWatch * const me) {
+    struct epoll_event ev;
+
+    /** @pre the watch must be watching a descriptor */
+    Q_REQUIRE_ID(300, me->fd >= 0);
+
+    ev.events   = fdw_epollEvents(me);
+    ev.data.ptr = me;
+    return epoll_ctl(l_epfd, EPOLL_CTL_MOD, me->fd, &ev) == 0;
+}
+/*..........................................................................*/
+bool QFdWatch_remove(QFdWatch * const me) {
+    struct epoll_event ev; /* ignored, but required by pre-2.6.9 kernels */
+    int fd;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    fd = me->fd;
+    me->fd = -1; /* suppress any report already collected by the thread */
+    QF_CRIT_EXIT_();
+
+    return (fd >= 0) && (epoll_ctl(l_epfd, EPOLL_CTL_DEL, fd, &ev) == 0);
+}
+
+/*..........................................................................*/
+static uint32_t fdw_epollEvents(QFdWatch const * const me) {
+    uint32_t events = (uint32_t)0;
+
+    if ((me->interest & (uint8_t)QF_FD_READ) != (uint8_t)0) {
+        events |= (uint32_t)(EPOLLIN | EPOLLRDHUP);
+    }
+    if ((me->interest & (uint8_t)QF_FD_WRITE) != (uint8_t)0) {
+        events |= (uint32_t)EPOLLOUT;
+    }
+    if ((me->flags & (uint8_t)QF_FDW_EDGE) != (uint8_t)0) {
+        events |= (uint32_t)EPOLLET;
+        if ((me->flags & (uint8_t)QF_FDW_ONESHOT) != (uint8_t)0) {
+            events |= (uint32_t)EPOLLONESHOT;
+        }
+    }
+    else { /* level-triggered watches are suspended after each report */
+        events |= (uint32_t)EPOLLONESHOT;
+    }
+    return events;
+}
+/*..........................................................................*/
+static void fdw_report(QFdWatch * const me, uint32_t const events) {
+    QActive *act;
+    QFdEvt *e;
+    int fd;
+    uint8_t ready = (uint8_t)0;
+    QF_CRIT_STAT_
+
+    if ((events & (uint32_t)EPOLLIN) != (uint32_t)0) {
+        ready |= (uint8_t)QF_FD_READ;
+    }
+    if ((events & (uint32_t)EPOLLOUT) != (uint32_t)0) {
+        ready |= (uint8_t)QF_FD_WRITE;
+    }
+    if ((events & (uint32_t)(EPOLLHUP | EPOLLRDHUP)) != (uint32_t)0) {
+        ready |= (uint8_t)QF_FD_HUP;
+    }
+    if ((events & (uint32_t)EPOLLERR) != (uint32_t)0) {
+        ready |= (uint8_t)QF_FD_ERR;
+    }
+
+    QF_CRIT_ENTRY_();
+    fd  = me->fd;
+    act = me->act;
+    QF_CRIT_EXIT_();
+
+    if (fd >= 0) { /* not removed since epoll_wait() collected it? */
+        if ((me->flags & (uint8_t)QF_FDW_POOL) != (uint8_t)0) {
+            e = Q_NEW(QFdEvt, (enum_t)me->evt.super.sig);
+            e->watch = me;
+        }
+        else {
+            e = &me->evt;
+        }
+        e->fd    = fd;
+        e->ready = ready;
+
+        /* QACTIVE_POST() asserts internally if the queue overflows */
+        QACTIVE_POST(act, &e->super, &l_fdWatcher);
+    }
+}
+/*..........................................................................*/
+static void *fdw_thread(void *arg) { /* the expected POSIX signature */
+    struct epoll_event evts[FDW_MAX_EVENTS];
+
+    (void)arg;
+    for (;;) {
+        int n = epoll_wait(l_epfd, evts, (int)FDW_MAX_EVENTS, -1);
+        int i;
+
+        if (n < 0) {
+            Q_ASSERT_ID(510, errno == EINTR); /* only signals may interrupt */
+            n = 0;
+        }
+        for (i = 0; i < n; ++i) {
+            fdw_report((QFdWatch *)evts[i].data.ptr, evts[i].events);
+        }
+    }
+    return (void *)0; /* not reached */
+}
+/*..........................................................................*/
+static void fdw_start(void) {
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    l_epfd = epoll_create1(EPOLL_CLOEXEC);
+    Q_ASSERT_ID(610, l_epfd >= 0);
+
+    QF_threadAttrInit_(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    /* the watcher is an "ISR-like" thread, see NOTE04 in qf_port.c */
+    QF_createThread_(&thread, &attr, QF_isrPrio_(1U), &fdw_thread, (void *)0);
+    pthread_attr_destroy(&attr);
+}
@@ -0,0 +1,120 @@
+/**
+* @file
+* @brief File-descriptor watcher service for the QF/C port to POSIX (Linux)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_fdwatch_h
+#define qf_fdwatch_h
+
+/****************************************************************************/
+/*! File-descriptor watch flags (see QFdWatch_ctor()) */
+enum QFdWatchFlags {
+    QF_FDW_LEVEL   = 0x00U, /*!< level-triggered reports (default) */
+    QF_FDW_EDGE    = 0x01U, /*!< edge-triggered reports */
+    QF_FDW_ONESHOT = 0x02U, /*!< disarm after every report, see NOTE1 */
+    QF_FDW_POOL    = 0x04U  /*!< post dynamic (pool) events, see NOTE2 */
+};
+
+/*! File-descriptor interest/readiness bits (see QFdWatch_add()) */
+enum QFdWatchReady {
+    QF_FD_READ  = 0x01U, /*!< the descriptor is readable */
+    QF_FD_WRITE = 0x02U, /*!< the descriptor is writable */
+    QF_FD_HUP   = 0x04U, /*!< the peer closed the connection */
+    QF_FD_ERR   = 0x08U  /*!< error condition on the descriptor */
+};
+
+struct QFdWatch; /* forward declaration */
+
+/*! Readiness event posted by the file-descriptor watcher to the AO */
+typedef struct {
+    QEvt super;             /*!< inherits ::QEvt */
+    struct QFdWatch *watch; /*!< the watch that reported the readiness */
+    int fd;                 /*!< the ready file descriptor */
+    uint8_t ready;          /*!< readiness bits (::QFdWatchReady) */
+} QFdEvt;
+
+/*! File-descriptor watch */
+/**
+* @description
+* A ::QFdWatch registers a file descriptor with the single epoll(7) thread
+* of the POSIX port. When the descriptor becomes ready, the thread posts
+* a ::QFdEvt with the signal of the watch to the associated active object,
+* so that no dedicated blocking reader thread is needed per descriptor.
+* Like ::QTimeEvt, a ::QFdWatch is typically a member of its active object.
+*/
+typedef struct QFdWatch {
+    QActive *act;   /*!< the active object that receives the reports */
+    QFdEvt evt;     /*!< static readiness event (unless #QF_FDW_POOL) */
+    int fd;         /*!< the watched descriptor (-1 when not added) */
+    uint8_t flags;  /*!< watch flags (::QFdWatchFlags) */
+    uint8_t interest; /*!< interest bits (::QFdWatchReady) */
+} QFdWatch;
+
+/*! The "constructor" of a file-descriptor watch */
+void QFdWatch_ctor(QFdWatch * const me, QActive * const act,
+                   enum_t const sig, uint8_t const flags);
+
+/*! Start watching the descriptor @p fd for the @p interest bits */
+bool QFdWatch_add(QFdWatch * const me, int const fd,
+                  uint8_t const interest);
+
+/*! Re-enable the reports of a level-triggered or one-shot watch */
+bool QFdWatch_rearm(QFdWatch * const me);
+
+/*! Stop watching the descriptor */
+bool QFdWatch_remove(QFdWatch * const me);
+
+/*****************************************************************************
+* NOTE1:
+* A level-triggered watch is suspended after each report, whether or not
+* #QF_FDW_ONESHOT is set, and resumes only after the AO has serviced the
+* descriptor and called QFdWatch_rearm(). If the descriptor is still ready
+* at that point, the next report follows immediately. This prevents the
+* watcher thread from flooding the AO queue with reports of a condition
+* that the AO has not had the chance to handle yet. An edge-triggered watch
+* stays armed and reports each new edge, unless #QF_FDW_ONESHOT is set.
+*
+* NOTE2:
+* Without #QF_FDW_POOL, the watch posts its own static ::QFdEvt member
+* (like a ::QTimeEvt does). With #QF_FDW_POOL a new ::QFdEvt is allocated
+* from the event pools for every report. The static event can be reported
+* again only after the AO has called QFdWatch_rearm(), so that the watcher
+* thread never overwrites it while the AO is still handling it. An
+* edge-triggered watch, which stays armed, therefore requires
+* #QF_FDW_ONESHOT or #QF_FDW_POOL (asserted by QFdWatch_ctor()).
+*/
+
+#endif /* qf_fdwatch_h */
@@ -0,0 +1,239 @@
+/**
+* @file
+* @brief Active object groups (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_group.h"     /* active object groups interface */
+
+Q_DEFINE_THIS_MODULE("qf_group")
+
+static void QActiveGroup_init_(QHsm * const me, QEvt const * const e);
+static void QActiveGroup_dispatch_(QHsm * const me, QEvt const * const e);
+#ifndef Q_SPY
+    static bool QActiveGroup_post_(QActive * const me, QEvt const * const e,
+                                   uint_fast16_t const margin);
+#else
+    static bool QActiveGroup_post_(QActive * const me, QEvt const * const e,
+                                   uint_fast16_t const margin,
+                                   void const * const sender);
+#endif
+static void QActiveGroup_postLIFO_(QActive * const me, QEvt const * const e);
+static uint_fast8_t QActiveGroup_route_(QActiveGroup * const me,
+                                        QEvt const * const e);
+
+/*..........................................................................*/
+void QActiveGroup_ctor(QActiveGroup * const me,
+                       QActive * const replicas[],
+                       uint_fast8_t const nReplicas,
+                       QGroupKeyFun const key)
+{
+    static QActiveVtbl const vtbl = {  /* QActiveVtbl virtual table */
+        { &QActiveGroup_init_,
+          &QActiveGroup_dispatch_ },
+        &QActive_start_,
+        &QActiveGroup_post_,
+        &QActiveGroup_postLIFO_
+    };
+    uint_fast8_t i;
+
+    /** @pre the number of replicas must be in range */
+    Q_REQUIRE_ID(100, ((uint_fast8_t)0 < nReplicas)
+                 && (nReplicas <= (uint_fast8_t)QF_GROUP_MAX_REPLICAS));
+
+    QActive_ctor(&me->super, Q_STATE_CAST(0)); /* superclass' ctor */
+    me->super.super.vptr = &vtbl.super; /* hook the vptr */
+    for (i = (uint_fast8_t)0; i < nReplicas; ++i) {
+        me->replica[i] = replicas[i];
+        me->nRouted[i] = (uint32_t)0;
+    }
+    me->key       = key;
+    me->nReplicas = (uint8_t)nReplicas;
+    me->next      = (uint8_t)0;
+    me->nDropped  = (uint32_t)0;
+}
+/*..........................................................................*/
+void QActiveGroup_start(QActiveGroup * const me, uint_fast8_t const prio,
+                        QEvt const *qSto[], uint_fast16_t const qLen,
+                        uint_fast16_t const stkSize,
+                        QEvt const * const ie)
+{
+    uint_fast8_t i;
+
+    /** @pre the group and all its replicas must fit the priority range */
+    Q_REQUIRE_ID(200, ((uint_fast8_t)0 < prio)
+                 && ((prio + (uint_fast8_t)me->nReplicas)
+                     <= (uint_fast8_t)QF_MAX_ACTIVE));
+
+    me->super.prio = (uint8_t)prio;
+    QF_add_(&me->super); /* make QF aware of the group proxy */
+
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)me->nReplicas; ++i) {
+        QACTIVE_START(me->replica[i], prio + (uint_fast8_t)1 + i,
+                      &qSto[i * qLen], qLen, (void *)0, stkSize, ie);
+    }
+}
+/*..........................................................................*/
+void QActiveGroup_getStats(QActiveGroup * const me,
+                           QActiveGroupStats * const stats)
+{
+    uint_fast8_t i;
+    QF_CRIT_STAT_
+
+    QF_bzero(stats, (uint_fast16_t)sizeof(*stats));
+    stats->minFree = (uint_fast16_t)~(uint_fast16_t)0;
+
+    QF_CRIT_ENTRY_();
+    stats->nDropped = me->nDropped;
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)me->nReplicas; ++i) {
+        QEQueue const * const q = &me->replica[i]->eQueue;
+
+        stats->nRouted += me->nRouted[i];
+        if (stats->nRoutedMax < me->nRouted[i]) {
+            stats->nRoutedMax = me->nRouted[i];
+        }
+        /* the front event counts as one of the (end + 1) entries */
+        stats->depth += (uint_fast16_t)(q->end + (QEQueueCtr)1 - q->nFree);
+        if (stats->minFree > (uint_fast16_t)q->nMin) {
+            stats->minFree = (uint_fast16_t)q->nMin;
+        }
+    }
+    QF_CRIT_EXIT_();
+}
+/*..........................................................................*/
+static void QActiveGroup_init_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+}
+/*..........................................................................*/
+static void QActiveGroup_dispatch_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(300); /* events are never dispatched to a group proxy */
+}
+/*..........................................................................*/
+#ifndef Q_SPY
+static bool QActiveGroup_post_(QActive * const me, QEvt const * const e,
+                               uint_fast16_t const margin)
+#else
+static bool QActiveGroup_post_(QActive * const me, QEvt const * const e,
+                               uint_fast16_t const margin,
+                               void const * const sender)
+#endif
+{
+    QActiveGroup * const grp = (QActiveGroup *)me;
+    uint_fast8_t const i = QActiveGroup_route_(grp, e);
+    bool status;
+    QF_CRIT_STAT_
+
+    /* the replica takes over the event, including its reference counting */
+    status = QACTIVE_POST_X(grp->replica[i], e, margin, sender);
+
+    QF_CRIT_ENTRY_();
+    if (status) {
+        ++grp->nRouted[i];
+    }
+    else {
+        ++grp->nDropped;
+    }
+    QF_CRIT_EXIT_();
+
+    return status;
+}
+/*..........................................................................*/
+static void QActiveGroup_postLIFO_(QActive * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(400); /* LIFO posting is meaningful only for self-posting */
+}
+/*..........................................................................*/
+/* select the replica for the event @p e, see NOTE1 */
+static uint_fast8_t QActiveGroup_route_(QActiveGroup * const me,
+                                        QEvt const * const e)
+{
+    uint_fast8_t const n = (uint_fast8_t)me->nReplicas;
+    uint_fast8_t sel;
+
+    if (me->key != (QGroupKeyFun)0) { /* route by the key? */
+        uint32_t const h = (*me->key)(e) * (uint32_t)0x9E3779B1U;
+        sel = (uint_fast8_t)(((uint64_t)h * (uint64_t)n) >> 32);
+    }
+    else { /* route to the least-loaded replica */
+        QEQueueCtr maxFree = (QEQueueCtr)0;
+        uint_fast8_t i;
+        QF_CRIT_STAT_
+
+        QF_CRIT_ENTRY_();
+        sel = (uint_fast8_t)me->next;
+        for (i = (uint_fast8_t)0; i < n; ++i) {
+            uint_fast8_t j = (uint_fast8_t)me->next + i;
+            if (j >= n) {
+                j -= n;
+            }
+            if (maxFree < me->replica[j]->eQueue.nFree) {
+                maxFree = me->replica[j]->eQueue.nFree;
+                sel = j;
+            }
+        }
+        /* rotate the start, so that ties are spread over the replicas */
+        me->next = (uint8_t)((sel + (uint_fast8_t)1 < n)
+                             ? (sel + (uint_fast8_t)1)
+                             : (uint_fast8_t)0);
+        QF_CRIT_EXIT_();
+    }
+    return sel;
+}
+
+/*****************************************************************************
+* NOTE1:
+* The key is spread with the Fibonacci (golden ratio) multiplicative hash
+* and mapped onto the replicas with a multiply-shift instead of a division,
+* so that consecutive keys (e.g., session or connection numbers) land on
+* different replicas. The least-loaded routing reads the queue occupancy
+* under the critical section, but the queues can change right after, so
+* the choice is only a heuristic. Under sustained load it keeps the queue
+* depths of the replicas even, while an idle group rotates over the
+* replicas to share the work in the first place.
+*/
@@ -0,0 +1,116 @@
+/**
+* @file
+* @brief Active object groups (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_group_h
+#define qf_group_h
+
+#ifndef QF_GROUP_MAX_REPLICAS
+    /*! The maximum number of replicas in a ::QActiveGroup */
+    #define QF_GROUP_MAX_REPLICAS 16U
+#endif
+
+/*! Routing key of an event posted to a ::QActiveGroup */
+typedef uint32_t (*QGroupKeyFun)(QEvt const * const e);
+
+/*! Group of replicated (sharded) active objects */
+/**
+* @description
+* A group runs N replicas of the same state machine class at consecutive
+* priorities behind a single proxy, which is registered with the framework
+* like an AO but has no event queue or thread (like ::QShmProxy). Events
+* posted to the group, or published and delivered to it by virtue of its
+* subscriptions, are routed to one of the replicas:
+* - with a @c key function, the replica is selected by the hash of the
+*   key, so all events with the same key are handled by the same replica
+*   in the order in which they were posted;
+* - without a @c key function, the event goes to the least-loaded replica
+*   (the one with the most free entries in its event queue).
+*
+* The group subscribes to signals as a single subscriber, so a published
+* event is processed by exactly one replica. The counters can be read at
+* any time, see QActiveGroup_getStats().
+*/
+typedef struct {
+    QActive super;           /*!< inherits ::QActive (the group proxy) */
+    QActive *replica[QF_GROUP_MAX_REPLICAS]; /*!< the replicas */
+    QGroupKeyFun key;        /*!< routing key (0 for least-loaded) */
+    uint8_t nReplicas;       /*!< the number of replicas */
+    uint8_t next;            /*!< first replica considered for a tie */
+    uint32_t volatile nRouted[QF_GROUP_MAX_REPLICAS]; /*!< # per replica */
+    uint32_t volatile nDropped; /*!< # events not posted (margin) */
+} QActiveGroup;
+
+/*! Aggregated statistics of a ::QActiveGroup */
+typedef struct {
+    uint32_t nRouted;        /*!< # events posted to all replicas */
+    uint32_t nDropped;       /*!< # events not posted (margin not met) */
+    uint32_t nRoutedMax;     /*!< # events posted to the busiest replica */
+    uint_fast16_t depth;     /*!< # events queued in all replicas now */
+    uint_fast16_t minFree;   /*!< the lowest free queue space ever seen */
+} QActiveGroupStats;
+
+/*! The "constructor" of an active object group */
+/**
+* @description
+* The @p nReplicas replicas must be already constructed, typically as an
+* array of the same AO class with the same initial pseudostate. The key
+* function @p key (or 0 for least-loaded routing) is called in the
+* context of the poster and must not block.
+*/
+void QActiveGroup_ctor(QActiveGroup * const me,
+                       QActive * const replicas[],
+                       uint_fast8_t const nReplicas,
+                       QGroupKeyFun const key);
+
+/*! Start the group at the priority @p prio and its replicas above it */
+/**
+* @description
+* The group proxy occupies the priority @p prio and the replicas the
+* priorities @p prio + 1 .. @p prio + nReplicas. The event queue storage
+* @p qSto is divided into nReplicas queues of @p qLen events each.
+*/
+void QActiveGroup_start(QActiveGroup * const me, uint_fast8_t const prio,
+                        QEvt const *qSto[], uint_fast16_t const qLen,
+                        uint_fast16_t const stkSize,
+                        QEvt const * const ie);
+
+/*! Get the statistics aggregated over all replicas of the group */
+void QActiveGroup_getStats(QActiveGroup * const me,
+                           QActiveGroupStats * const stats);
+
+#endif /* qf_group_h */
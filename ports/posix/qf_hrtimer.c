@@ -0,0 +1,472 @@
+/**
+* @file
+* @brief High-resolution timers (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#include "qf_hrtimer.h"   /* high-resolution timer interface */
+
+#include <errno.h>        /* for errno and EINTR */
+#include <sys/timerfd.h>  /* for timerfd_create() and timerfd_settime() */
+#include <time.h>         /* for clock_gettime() */
+#include <unistd.h>       /* for read() */
+
+Q_DEFINE_THIS_MODULE("qf_hrtimer")
+
+/* Local objects -----------------------------------------------------------*/
+/* min-heap of all armed timers and scheduled posts ordered by deadline */
+static QHrTimer *l_heap[QF_HRTIMER_MAX + QF_HRTIMER_POSTS];
+static uint_fast16_t l_nHeap;            /* # timers in the heap */
+static int l_tfd = -1;                   /* the timerfd of the service */
+static pthread_once_t l_hrtOnce = PTHREAD_ONCE_INIT;
+
+/* scheduled posts, see NOTE3 */
+static QHrTimer l_posts[QF_HRTIMER_POSTS];       /* the timers carrying... */
+static uint16_t l_postGen[QF_HRTIMER_POSTS];     /* ...and their handles */
+static uint16_t l_postFree[QF_HRTIMER_POSTS];    /* stack of free posts */
+static uint_fast16_t l_nPostFree;                /* # free posts */
+
+#ifdef Q_SPY
+static uint8_t const l_hrTimer = 0U; /* unique sender object for QS */
+#endif
+
+static void hrt_start(void);
+static void *hrt_thread(void *arg);
+static void hrt_insert(QHrTimer * const t);
+static void hrt_remove(QHrTimer * const t);
+static void hrt_place(QHrTimer * const t, uint_fast16_t i);
+static void hrt_program(void);
+static void hrt_freePost(QHrTimer * const t);
+
+/*..........................................................................*/
+void QHrTimer_ctor(QHrTimer * const me, QActive * const act,
+                   enum_t const sig)
+{
+    /** @pre the AO must be valid and the signal must be a user signal */
+    Q_REQUIRE_ID(100, (act != (QActive *)0)
+                      && (sig >= (enum_t)Q_USER_SIG));
+
+    me->super.sig     = (QSignal)sig;
+    me->super.poolId_ = (uint8_t)0; /* static event */
+    me->super.refCtr_ = (uint8_t)0;
+    me->act       = act;
+    me->deadline  = (uint64_t)0;
+    me->interval  = (uint64_t)0;
+    me->nOverruns = (uint32_t)0;
+    me->payload   = (QEvt const *)0;
+    me->heapIdx   = (uint16_t)0;
+}
+/*..........................................................................*/
+void QHrTimer_arm(QHrTimer * const me, uint64_t const nsec,
+                  uint64_t const interval)
+{
+    QHrTimer_armAt(me, QHrTimer_now() + nsec, interval);
+}
+/*..........................................................................*/
+/**
+* @description
+* Arms the timer to expire at the absolute time @p deadline, which is
+* measured by QHrTimer_now(), and then periodically every @p interval
+* nanoseconds (zero @p interval arms a one-shot timer).
+*
+* @note Like QTimeEvt_armX(), this function requires the timer to be
+* disarmed. Use QHrTimer_rearm() to change the deadline of armed timers.
+*/
+void QHrTimer_armAt(QHrTimer * const me, uint64_t const deadline,
+                    uint64_t const interval)
+{
+    QF_CRIT_STAT_
+
+    (void)pthread_once(&l_hrtOnce, &hrt_start); /* start the service */
+
+    QF_CRIT_ENTRY_();
+
+    /** @pre the timer must be constructed and not armed */
+    Q_REQUIRE_ID(200, (me->act != (QActive *)0)
+                      && (me->heapIdx == (uint16_t)0));
+
+    me->deadline  = deadline;
+    me->interval  = interval;
+    me->nOverruns = (uint32_t)0;
+    hrt_insert(me);
+    if (me->heapIdx == (uint16_t)1) { /* the new earliest deadline? */
+        hrt_program();
+    }
+    QF_CRIT_EXIT_();
+}
+/*..........................................................................*/
+/**
+* @description
+* Disarms the timer, so that it does not expire any more. As with
+* QTimeEvt_disarm(), the timer might have expired just before the call
+* and its event might already be in the queue of the AO, in which case
+* the function returns 'false'.
+*/
+bool QHrTimer_disarm(QHrTimer * const me) {
+    bool wasArmed;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    wasArmed = (me->heapIdx != (uint16_t)0);
+    if (wasArmed) {
+        bool const wasFirst = (me->heapIdx == (uint16_t)1);
+        hrt_remove(me);
+        if (wasFirst) {
+            hrt_program();
+        }
+    }
+    QF_CRIT_EXIT_();
+    return wasArmed;
+}
+/*..........................................................................*/
+/**
+* @description
+* Moves the next deadline of the timer to @p nsec from now, whether or not
+* the timer is armed, and keeps its interval.
+*
+* @returns 'true' if the timer was armed and 'false' if it was disarmed
+* (and thus has been armed by this call).
+*/
+bool QHrTimer_rearm(QHrTimer * const me, uint64_t const nsec) {
+    uint64_t const deadline = QHrTimer_now() + nsec;
+    bool wasArmed;
+    QF_CRIT_STAT_
+
+    (void)pthread_once(&l_hrtOnce, &hrt_start); /* start the service */
+
+    QF_CRIT_ENTRY_();
+    wasArmed = (me->heapIdx != (uint16_t)0);
+    if (wasArmed) {
+        hrt_remove(me);
+    }
+    me->deadline = deadline;
+    hrt_insert(me);
+    hrt_program(); /* the earliest deadline might have changed */
+    QF_CRIT_EXIT_();
+    return wasArmed;
+}
+/*..........................................................................*/
+uint64_t QHrTimer_now(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/*..........................................................................*/
+QPostHandle QActive_postIn(QActive * const me, QEvt const * const e,
+                           uint64_t const nsec)
+{
+    return QActive_postAt(me, e, QHrTimer_now() + nsec);
+}
+/*..........................................................................*/
+/**
+* @description
+* Schedules the event @p e to be posted to the AO @p me at the absolute
+* time @p deadline (see QHrTimer_now()). The event can be any dynamic or
+* static event, which is held (its reference counter is incremented) until
+* it is delivered with QACTIVE_POST() or the post is canceled.
+*
+* @returns the handle for QActive_cancelPost() or zero if all the
+* #QF_HRTIMER_POSTS scheduled posts are pending, in which case the event
+* is garbage-collected like an event that could not be posted.
+*/
+QPostHandle QActive_postAt(QActive * const me, QEvt const * const e,
+                           uint64_t const deadline)
+{
+    QPostHandle h = (QPostHandle)0;
+    QF_CRIT_STAT_
+
+    /** @pre the AO and the event must be valid */
+    Q_REQUIRE_ID(300, (me != (QActive *)0) && (e != (QEvt const *)0));
+
+    (void)pthread_once(&l_hrtOnce, &hrt_start); /* start the service */
+
+    QF_CRIT_ENTRY_();
+    if (l_nPostFree != (uint_fast16_t)0) {
+        uint_fast16_t idx;
+        QHrTimer *t;
+
+        --l_nPostFree;
+        idx = (uint_fast16_t)l_postFree[l_nPostFree];
+        t = &l_posts[idx];
+        t->act       = me;
+        t->payload   = e;
+        t->deadline  = deadline;
+        t->interval  = (uint64_t)0;
+        t->nOverruns = (uint32_t)0;
+        if (e->poolId_ != (uint8_t)0) { /* is it a dynamic event? */
+            QF_EVT_REF_CTR_INC_(e); /* hold the event until delivery */
+        }
+        hrt_insert(t);
+        if (t->heapIdx == (uint16_t)1) { /* the new earliest deadline? */
+            hrt_program();
+        }
+        h = ((QPostHandle)l_postGen[idx] << 16) | (QPostHandle)(idx + 1U);
+    }
+    QF_CRIT_EXIT_();
+
+    if (h == (QPostHandle)0) {
+        QF_gc(e); /* recycle the event, as if the post failed */
+    }
+    return h;
+}
+/*..........................................................................*/
+/**
+* @description
+* Cancels the scheduled post and releases its event.
+*
+* @returns 'true' if the post has been canceled and 'false' if it has been
+* delivered (or canceled) already, or if the handle is invalid.
+*/
+bool QActive_cancelPost(QPostHandle const h) {
+    uint_fast16_t const idx = (uint_fast16_t)(h & 0xFFFFU) - 1U;
+    QEvt const *e = (QEvt const *)0;
+    QF_CRIT_STAT_
+
+    if (idx < (uint_fast16_t)QF_HRTIMER_POSTS) {
+        QHrTimer * const t = &l_posts[idx];
+        QF_CRIT_ENTRY_();
+        if ((t->heapIdx != (uint16_t)0)
+            && (l_postGen[idx] == (uint16_t)(h >> 16)))
+        {
+            bool const wasFirst = (t->heapIdx == (uint16_t)1);
+            hrt_remove(t);
+            if (wasFirst) {
+                hrt_program();
+            }
+            e = t->payload;
+            hrt_freePost(t);
+        }
+        QF_CRIT_EXIT_();
+    }
+    if (e != (QEvt const *)0) {
+        QF_gc(e); /* release the event held by the scheduled post */
+    }
+    return (e != (QEvt const *)0);
+}
+
+/*..........................................................................*/
+static void *hrt_thread(void *arg) { /* the expected POSIX signature */
+    QActive *firedAct[QF_HRTIMER_MAX + QF_HRTIMER_POSTS];
+    QEvt const *firedEvt[QF_HRTIMER_MAX + QF_HRTIMER_POSTS];
+    uint64_t cnt;
+
+    (void)arg;
+    for (;;) {
+        uint_fast16_t n = (uint_fast16_t)0;
+        uint_fast16_t i;
+        uint64_t now;
+        QF_CRIT_STAT_
+
+        if (read(l_tfd, &cnt, sizeof(cnt)) < 0) {
+            Q_ASSERT_ID(510, errno == EINTR); /* only signals may interrupt */
+        }
+
+        now = QHrTimer_now();
+        QF_CRIT_ENTRY_();
+        while ((l_nHeap != (uint_fast16_t)0) && (l_heap[0]->deadline <= now))
+        {
+            QHrTimer * const t = l_heap[0];
+            hrt_remove(t);
+            if (t->interval != (uint64_t)0) { /* periodic? */
+                t->deadline += t->interval; /* no drift, see NOTE1 */
+                if (t->deadline <= now) {   /* missed some periods? */
+                    uint64_t const late = now - t->deadline;
+                    t->nOverruns += (uint32_t)(late / t->interval) + 1U;
+                    t->deadline += ((late / t->interval) + 1U)
+                                   * t->interval;
+                }
+                hrt_insert(t);
+            }
+            firedAct[n] = t->act;
+            if (t->payload != (QEvt const *)0) { /* scheduled post? */
+                firedEvt[n] = t->payload;
+                hrt_freePost(t);
+            }
+            else {
+                firedEvt[n] = &t->super;
+            }
+            ++n;
+        }
+        hrt_program();
+        QF_CRIT_EXIT_();
+
+        for (i = (uint_fast16_t)0; i < n; ++i) {
+            /* QACTIVE_POST() asserts internally if the queue overflows */
+            QACTIVE_POST(firedAct[i], firedEvt[i], &l_hrTimer);
+
+            /* release the events held by scheduled posts (this does
+            * nothing for the timers, which are static events)
+            */
+            QF_gc(firedEvt[i]);
+        }
+    }
+    return (void *)0; /* not reached */
+}
+/*..........................................................................*/
+static void hrt_start(void) {
+    pthread_t thread;
+    pthread_attr_t attr;
+    uint_fast16_t i;
+
+    for (i = (uint_fast16_t)0; i < (uint_fast16_t)QF_HRTIMER_POSTS; ++i) {
+        l_postFree[i] = (uint16_t)i;
+    }
+    l_nPostFree = (uint_fast16_t)QF_HRTIMER_POSTS;
+
+    l_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    Q_ASSERT_ID(610, l_tfd >= 0);
+
+    QF_threadAttrInit_(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    /* the timer service is an "ISR-like" thread, see NOTE04 in qf_port.c */
+    QF_createThread_(&thread, &attr, QF_isrPrio_(1U), &hrt_thread, (void *)0);
+    pthread_attr_destroy(&attr);
+}
+/*..........................................................................*/
+/* the heap functions must be called from a critical section */
+static void hrt_insert(QHrTimer * const t) {
+    /** @pre the heap must not be full */
+    Q_REQUIRE_ID(700, l_nHeap < (uint_fast16_t)(QF_HRTIMER_MAX
+                                                 + QF_HRTIMER_POSTS));
+    ++l_nHeap;
+    hrt_place(t, l_nHeap - 1U);
+}
+/*..........................................................................*/
+static void hrt_remove(QHrTimer * const t) {
+    uint_fast16_t const i = (uint_fast16_t)t->heapIdx - 1U;
+    QHrTimer * const last = l_heap[l_nHeap - 1U];
+
+    --l_nHeap;
+    t->heapIdx = (uint16_t)0;
+    if (last != t) {
+        hrt_place(last, i); /* re-place the last timer into the hole */
+    }
+}
+/*..........................................................................*/
+/* place the timer into the hole at the position i and restore the heap */
+static void hrt_place(QHrTimer * const t, uint_fast16_t i) {
+    /* sift up... */
+    while ((i > (uint_fast16_t)0)
+           && (l_heap[(i - 1U) / 2U]->deadline > t->deadline))
+    {
+        uint_fast16_t const parent = (i - 1U) / 2U;
+        l_heap[i] = l_heap[parent];
+        l_heap[i]->heapIdx = (uint16_t)(i + 1U);
+        i = parent;
+    }
+    /* sift down... */
+    for (;;) {
+        uint_fast16_t child = (2U * i) + 1U;
+        if (child >= l_nHeap) {
+            break;
+        }
+        if (((child + 1U) < l_nHeap)
+            && (l_heap[child + 1U]->deadline < l_heap[child]->deadline))
+        {
+            ++child;
+        }
+        if (l_heap[child]->deadline >= t->deadline) {
+            break;
+        }
+        l_heap[i] = l_heap[child];
+        l_heap[i]->heapIdx = (uint16_t)(i + 1U);
+        i = child;
+    }
+    l_heap[i] = t;
+    t->heapIdx = (uint16_t)(i + 1U);
+}
+/*..........................................................................*/
+/* program the timerfd with the earliest deadline, see NOTE2 */
+static void hrt_program(void) {
+    struct itimerspec its;
+
+    its.it_interval.tv_sec  = 0;
+    its.it_interval.tv_nsec = 0;
+    if (l_nHeap != (uint_fast16_t)0) {
+        uint64_t const dl = l_heap[0]->deadline;
+        its.it_value.tv_sec  = (time_t)(dl / 1000000000U);
+        its.it_value.tv_nsec = (long)(dl % 1000000000U);
+        if ((its.it_value.tv_sec == 0) && (its.it_value.tv_nsec == 0)) {
+            its.it_value.tv_nsec = 1; /* zero would disarm the timerfd */
+        }
+    }
+    else {
+        its.it_value.tv_sec  = 0; /* disarm the timerfd */
+        its.it_value.tv_nsec = 0;
+    }
+    Q_ALLEGE_ID(810, timerfd_settime(l_tfd, TFD_TIMER_ABSTIME, &its,
+                                     (struct itimerspec *)0) == 0);
+}
+
+/*..........................................................................*/
+/* return the scheduled post to the free stack (in a critical section) */
+static void hrt_freePost(QHrTimer * const t) {
+    uint_fast16_t const idx = (uint_fast16_t)(t - &l_posts[0]);
+    t->payload = (QEvt const *)0;
+    ++l_postGen[idx]; /* invalidate the outstanding handle */
+    l_postFree[l_nPostFree] = (uint16_t)idx;
+    ++l_nPostFree;
+}
+
+/*****************************************************************************
+* NOTE1:
+* The next deadline of a periodic timer is computed from its previous
+* deadline, not from the time it actually expired, so the period does not
+* drift with the wakeup latency. If the service thread was late by more
+* than a whole period, the missed periods are skipped (and counted in
+* nOverruns) instead of firing a burst of late events at the AO.
+*
+* NOTE2:
+* The timerfd is reprogrammed inside the critical section, so that two
+* threads arming timers concurrently cannot program the deadlines out of
+* order. The timerfd uses absolute deadlines, so a deadline that already
+* passed makes the timerfd expire immediately and no expiration is lost.
+*
+* NOTE3:
+* A scheduled post is a ::QHrTimer from the internal pool, which carries
+* the event to deliver in its payload. It goes into the same heap as the
+* timers, so it costs O(log n) to schedule and to cancel, and nothing
+* while it is pending. The handle combines the index of the pool entry
+* with its generation, which changes whenever the post is delivered or
+* canceled, so a stale handle can never cancel an unrelated post.
+*/
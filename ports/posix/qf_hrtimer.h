@@ -0,0 +1,115 @@
+/**
+* @file
+* @brief High-resolution timers (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_hrtimer_h
+#define qf_hrtimer_h
+
+#ifndef QF_HRTIMER_MAX
+    /*! The maximum number of simultaneously armed high-resolution timers */
+    #define QF_HRTIMER_MAX  64U
+#endif
+
+#ifndef QF_HRTIMER_POSTS
+    /*! The maximum number of pending scheduled posts (QActive_postIn()) */
+    #define QF_HRTIMER_POSTS 64U
+#endif
+
+/*! High-resolution timer */
+/**
+* @description
+* A ::QHrTimer is the counterpart of ::QTimeEvt with nanosecond deadlines
+* on CLOCK_MONOTONIC instead of the clock tick counts. Like ::QTimeEvt,
+* it is an event that posts itself to its active object when it expires,
+* and it can be one-shot or periodic.
+*
+* All armed timers are kept in a binary heap ordered by their deadlines
+* and the single timerfd of the port is always programmed with the
+* absolute deadline of the earliest timer. So, the timers cost nothing
+* between the expirations, regardless of their resolution, and
+* the periodic timers do not accumulate any drift.
+*/
+typedef struct {
+    QEvt super;           /*!< inherits ::QEvt */
+    QActive *act;         /*!< the AO that receives the timer */
+    uint64_t deadline;    /*!< the absolute expiration time [ns] */
+    uint64_t interval;    /*!< the period [ns] (0 for one-shot timers) */
+    uint32_t nOverruns;   /*!< # periods missed, because of late expiry */
+    QEvt const *payload;  /*!< the event posted instead (scheduled posts) */
+    uint16_t heapIdx;     /*!< position in the heap + 1 (0 if disarmed) */
+} QHrTimer;
+
+/*! The "constructor" of a high-resolution timer */
+void QHrTimer_ctor(QHrTimer * const me, QActive * const act,
+                   enum_t const sig);
+
+/*! Arm a timer to expire @p nsec from now and then every @p interval */
+void QHrTimer_arm(QHrTimer * const me, uint64_t const nsec,
+                  uint64_t const interval);
+
+/*! Arm a timer to expire at the absolute time @p deadline */
+void QHrTimer_armAt(QHrTimer * const me, uint64_t const deadline,
+                    uint64_t const interval);
+
+/*! Disarm a timer (returns 'true' if the timer was armed) */
+bool QHrTimer_disarm(QHrTimer * const me);
+
+/*! Re-arm a timer to expire @p nsec from now (returns 'true' if armed) */
+bool QHrTimer_rearm(QHrTimer * const me, uint64_t const nsec);
+
+/*! Check whether the timer is armed */
+#define QHrTimer_isArmed(me_) ((me_)->heapIdx != (uint16_t)0)
+
+/*! The current time on the timer clock (CLOCK_MONOTONIC) [ns] */
+uint64_t QHrTimer_now(void);
+
+/****************************************************************************/
+/*! Handle of a scheduled post (zero is never a valid handle) */
+typedef uint32_t QPostHandle;
+
+/*! Post the event @p e to the AO @p me in @p nsec nanoseconds */
+QPostHandle QActive_postIn(QActive * const me, QEvt const * const e,
+                           uint64_t const nsec);
+
+/*! Post the event @p e to the AO @p me at the absolute time @p deadline */
+QPostHandle QActive_postAt(QActive * const me, QEvt const * const e,
+                           uint64_t const deadline);
+
+/*! Cancel a scheduled post (returns 'true' if it has not been delivered) */
+bool QActive_cancelPost(QPostHandle const h);
+
+#endif /* qf_hrtimer_h */
@@ -0,0 +1,295 @@
+/**
+* @file
+* @brief Tick jitter and timer lateness measurement (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+
+#ifdef QF_TICK_JITTER     /* jitter measurement configured? */
+
+#include "qf_jitter.h"    /* jitter measurement interface */
+
+#include <time.h>         /* for clock_gettime() */
+
+Q_DEFINE_THIS_MODULE("qf_jitter")
+
+#if ((QF_JITTER_MAX_TIMEEVT & (QF_JITTER_MAX_TIMEEVT - 1U)) != 0U)
+    #error "QF_JITTER_MAX_TIMEEVT must be a power of 2"
+#endif
+
+typedef struct {          /* the measurement of one tick rate */
+    int64_t next;         /* the ideal time of the next tick [ns] */
+    int64_t period;       /* the tick period [ns], 0 if not measured */
+    bool isAbsolute;      /* the ideal ticks on a fixed grid, see NOTE1 */
+    QJitterHisto lateness;
+    QJitterHisto delay;
+} QJitterRate;
+
+typedef struct {          /* the stamp of a posted time event */
+    QTimeEvt const *te;   /* the time event (never removed) */
+    int64_t stamp;        /* when the time event was posted, 0 if not */
+} QJitterStamp;
+
+static QJitterRate l_rate[QF_MAX_TICK_RATE];
+static QJitterStamp l_stamp[QF_JITTER_MAX_TIMEEVT]; /* see NOTE2 */
+
+static int64_t jitter_now(void);
+static void QJitterHisto_add_(QJitterHisto * const me, int64_t const ns);
+static QJitterStamp *jitter_find(void const * const te, bool const insert);
+
+/*..........................................................................*/
+uint32_t QJitterHisto_percentile(QJitterHisto const * const me,
+                                 uint_fast8_t const pct)
+{
+    uint64_t const limit = ((uint64_t)me->n * pct + 99U) / 100U;
+    uint64_t sum = 0U;
+    uint_fast8_t i;
+
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)QF_JITTER_BUCKETS; ++i) {
+        sum += me->bucket[i];
+        if ((sum >= limit) && (sum != 0U)) {
+            break;
+        }
+    }
+    if (i >= (uint_fast8_t)(QF_JITTER_BUCKETS - 1U)) { /* the last bucket? */
+        return (me->maxNs + 999U) / 1000U; /* bounded only by the max */
+    }
+    return (uint32_t)1U << i;
+}
+/*..........................................................................*/
+void QF_getTickJitter(uint_fast8_t const tickRate,
+                      QJitterHisto * const lateness,
+                      QJitterHisto * const delay)
+{
+    QF_CRIT_STAT_
+
+    /** @pre the tick rate must be in range */
+    Q_REQUIRE_ID(100, tickRate < (uint_fast8_t)QF_MAX_TICK_RATE);
+
+    QF_CRIT_ENTRY_(); /* the histograms are not updated atomically */
+    *lateness = l_rate[tickRate].lateness;
+    *delay    = l_rate[tickRate].delay;
+    QF_CRIT_EXIT_();
+}
+/*..........................................................................*/
+void QF_resetTickJitter(void) {
+    uint_fast8_t i;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)QF_MAX_TICK_RATE; ++i) {
+        QF_bzero(&l_rate[i].lateness, (uint_fast16_t)sizeof(QJitterHisto));
+        QF_bzero(&l_rate[i].delay,    (uint_fast16_t)sizeof(QJitterHisto));
+    }
+    QF_CRIT_EXIT_();
+}
+/*..........................................................................*/
+void QF_traceTickJitter(void) {
+#ifdef Q_SPY
+    uint_fast8_t i;
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)QF_MAX_TICK_RATE; ++i) {
+        QJitterHisto late;
+        QJitterHisto delay;
+
+        QF_getTickJitter(i, &late, &delay);
+        if ((late.n != 0U) || (delay.n != 0U)) {
+            QS_BEGIN(QS_PORT_TICK_JITTER, (void *)0)
+                QS_U8(0, i);                   /* the tick rate */
+                QS_U32(0, late.n);             /* # ticks */
+                QS_U32(0, (late.n != 0U)       /* average lateness [ns] */
+                          ? (uint32_t)(late.sumNs / late.n) : 0U);
+                QS_U32(0, QJitterHisto_percentile(&late, 99U)); /* [us] */
+                QS_U32(0, late.maxNs);         /* max lateness [ns] */
+                QS_U32(0, delay.n);            /* # time events */
+                QS_U32(0, (delay.n != 0U)      /* average delay [ns] */
+                          ? (uint32_t)(delay.sumNs / delay.n) : 0U);
+                QS_U32(0, QJitterHisto_percentile(&delay, 99U)); /* [us] */
+                QS_U32(0, delay.maxNs);        /* max delay [ns] */
+            QS_END()
+        }
+    }
+#endif /* Q_SPY */
+}
+
+/****************************************************************************/
+void QF_jitterGrid_(uint_fast8_t const tickRate, int64_t const periodNs,
+                    int64_t const firstNs)
+{
+    QJitterRate * const r = &l_rate[tickRate];
+    r->isAbsolute = (firstNs != 0);
+    r->next = r->isAbsolute ? firstNs : (jitter_now() + periodNs);
+    __atomic_store_n(&r->period, periodNs, __ATOMIC_RELEASE);
+}
+/*..........................................................................*/
+void QF_jitterTick_(uint_fast8_t const tickRate) {
+    QJitterRate * const r = &l_rate[tickRate];
+
+#ifdef QF_MAX_DOMAIN
+    if (QF_domainId_ != (uint8_t)0) { /* the jitter of domain 0 only */
+        return;
+    }
+#endif
+    if (__atomic_load_n(&r->period, __ATOMIC_ACQUIRE) != 0) {
+        int64_t now = jitter_now();
+        QF_CRIT_STAT_
+
+        QF_CRIT_ENTRY_();
+        QJitterHisto_add_(&r->lateness, now - r->next);
+        r->next = (r->isAbsolute ? r->next : now) + r->period;
+        QF_CRIT_EXIT_();
+    }
+}
+/*..........................................................................*/
+void QF_jitterPost_(QTimeEvt const * const t) {
+    QJitterStamp * const s = jitter_find(t, true);
+    if (s != (QJitterStamp *)0) {
+        __atomic_store_n(&s->stamp, jitter_now(), __ATOMIC_RELAXED);
+    }
+}
+/*..........................................................................*/
+void QF_jitterDispatch_(QEvt const * const e) {
+    if (e->poolId_ == (uint8_t)0) { /* time events are never dynamic */
+        QJitterStamp * const s = jitter_find(e, false);
+        if (s != (QJitterStamp *)0) {
+            int64_t stamp = __atomic_exchange_n(&s->stamp, (int64_t)0,
+                                                __ATOMIC_RELAXED);
+            if (stamp != 0) {
+                uint_fast8_t rate = (uint_fast8_t)(e->refCtr_
+                                                   & (uint8_t)0x7F);
+                int64_t now = jitter_now();
+                QF_CRIT_STAT_
+
+                QF_CRIT_ENTRY_();
+                QJitterHisto_add_(&l_rate[rate].delay, now - stamp);
+                QF_CRIT_EXIT_();
+            }
+        }
+    }
+}
+
+/****************************************************************************/
+static int64_t jitter_now(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000) + (int64_t)ts.tv_nsec;
+}
+/*..........................................................................*/
+/* must be called from a critical section */
+static void QJitterHisto_add_(QJitterHisto * const me, int64_t const ns) {
+    uint32_t const lat = (ns <= 0) ? 0U        /* clock granularity */
+                       : (ns >= (int64_t)0xFFFFFFFF) ? 0xFFFFFFFFU
+                       : (uint32_t)ns;
+    uint32_t us = lat / 1000U;
+    uint_fast8_t i = (uint_fast8_t)0;
+
+    while ((us != 0U) && (i < (uint_fast8_t)(QF_JITTER_BUCKETS - 1U))) {
+        us >>= 1;
+        ++i;
+    }
+    ++me->bucket[i];
+    ++me->n;
+    me->sumNs += lat;
+    if (me->maxNs < lat) {
+        me->maxNs = lat;
+    }
+}
+/*..........................................................................*/
+static QJitterStamp *jitter_find(void const * const te, bool const insert) {
+    uint32_t const h = (uint32_t)(((uintptr_t)te >> 4) * 2654435769U);
+    /* the top log2(QF_JITTER_MAX_TIMEEVT) bits of the Fibonacci hash */
+    uint32_t i = (uint32_t)(((uint64_t)h * QF_JITTER_MAX_TIMEEVT) >> 32);
+    uint_fast16_t n;
+
+    for (n = (uint_fast16_t)0; n < (uint_fast16_t)QF_JITTER_MAX_TIMEEVT;
+         ++n, ++i)
+    {
+        QJitterStamp * const s = &l_stamp[i & (QF_JITTER_MAX_TIMEEVT - 1U)];
+        QTimeEvt const *key = __atomic_load_n(&s->te, __ATOMIC_ACQUIRE);
+        if (key == (QTimeEvt const *)te) {
+            return s;
+        }
+        if (key == (QTimeEvt const *)0) { /* the end of the probe chain */
+            if (!insert) {
+                return (QJitterStamp *)0;
+            }
+            if (__atomic_compare_exchange_n(&s->te, &key,
+                    (QTimeEvt const *)te, false,
+                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+                || (key == (QTimeEvt const *)te))
+            {
+                return s;
+            }
+        }
+    }
+    return (QJitterStamp *)0; /* table full, the time event not measured */
+}
+
+/*****************************************************************************
+* NOTE1:
+* The lateness of a tick is the time of the QF_tickX_() call less the
+* ideal time of the tick. The tick sources of QF_setTickRateX() fire on
+* a fixed grid of an absolute timerfd, so the ideal ticks are a whole
+* number of periods after the first tick, and the ticks replayed after an
+* overrun show their true lateness. The ticks from QF_onClockTick() in
+* QF_run() come after the nanosleep() of one period following the previous
+* tick, so their ideal time is one period after the previous tick (and the
+* lateness includes the time of processing the previous tick). This
+* assumes that QF_onClockTick() ticks every such rate in every call. The
+* rates ticked in other ways (e.g., QF_poll() applications) are not
+* measured. The delay of a time event is measured from its posting in
+* QF_tickX_() to the start of its dispatching in the AO thread (or in
+* QF_poll()), so the expiry of a time event is late by the lateness of its
+* tick plus its delay.
+*
+* NOTE2:
+* The expired time events are stamped in a lock-free hash table indexed by
+* the address of the time event. A time event takes its slot when it is
+* posted for the first time and keeps it forever (time events are never
+* destroyed in QP), so the table needs no removal. Time events beyond
+* QF_JITTER_MAX_TIMEEVT are not measured. A time event posted again before
+* its previous posting was dispatched is measured from the later posting.
+*/
+
+#endif /* QF_TICK_JITTER */
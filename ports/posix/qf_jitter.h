@@ -0,0 +1,109 @@
+/**
+* @file
+* @brief Tick jitter and timer lateness measurement (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_jitter_h
+#define qf_jitter_h
+
+#ifndef QF_JITTER_BUCKETS
+    /*! The number of the logarithmic buckets of the jitter histograms */
+    #define QF_JITTER_BUCKETS      16U
+#endif
+
+#ifndef QF_JITTER_MAX_TIMEEVT
+    /*! The maximum number of time events measured (a power of 2) */
+    #define QF_JITTER_MAX_TIMEEVT  256U
+#endif
+
+/*! Histogram of latencies with logarithmic buckets */
+/**
+* @description
+* The bucket 0 counts the latencies below 1us and the bucket i > 0 the
+* latencies from 2^(i-1) up to 2^i us, except the last bucket, which
+* counts all the longer latencies as well.
+*/
+typedef struct {
+    uint32_t bucket[QF_JITTER_BUCKETS]; /*!< # samples in every bucket */
+    uint32_t n;       /*!< # samples */
+    uint32_t maxNs;   /*!< the longest latency [ns] */
+    uint64_t sumNs;   /*!< the sum of all latencies [ns] */
+} QJitterHisto;
+
+/*! The upper bound [us] of the @p pct percentile of the histogram */
+uint32_t QJitterHisto_percentile(QJitterHisto const * const me,
+                                 uint_fast8_t const pct);
+
+/*! Get the histograms of the tick rate @p tickRate */
+/**
+* @description
+* @p lateness receives the lateness of every QF_tickX_() call at this tick
+* rate against its ideal time and @p delay the delays from posting the
+* expired time events of this rate (in QF_tickX_()) to the beginning of
+* their dispatching in the target AOs. See NOTE1 in qf_jitter.c.
+*/
+void QF_getTickJitter(uint_fast8_t const tickRate,
+                      QJitterHisto * const lateness,
+                      QJitterHisto * const delay);
+
+/*! Clear the histograms of all tick rates */
+void QF_resetTickJitter(void);
+
+/*! Produce the QS_PORT_TICK_JITTER summary record for every tick rate */
+void QF_traceTickJitter(void);
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! start the ideal ticks of the rate @p tickRate at @p firstNs on
+    * the fixed grid of a timer (or at 0 to follow every tick by one period)
+    */
+    void QF_jitterGrid_(uint_fast8_t const tickRate, int64_t const periodNs,
+                        int64_t const firstNs);
+
+    /*! measure the lateness of the tick (called from QF_tickX_()) */
+    void QF_jitterTick_(uint_fast8_t const tickRate);
+
+    /*! stamp the expired time event before it is posted */
+    void QF_jitterPost_(QTimeEvt const * const t);
+
+    /*! measure the delay of the time event @p e being dispatched */
+    void QF_jitterDispatch_(QEvt const * const e);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_jitter_h */
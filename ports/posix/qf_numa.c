@@ -0,0 +1,347 @@
+/**
+* @file
+* @brief NUMA-aware placement of AOs and event pools (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define _GNU_SOURCE       /* for sched_getcpu(), pthread_attr_setaffinity_np */
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+
+#ifdef QF_NUMA_MAX_NODE   /* NUMA placement configured? */
+
+#include "qf_numa.h"      /* NUMA placement interface */
+
+#include <sched.h>        /* for sched_getcpu(), CPU_SET() */
+#include <stdio.h>        /* for fopen() of the sysfs node lists */
+#include <sys/mman.h>     /* for mmap() */
+#include <sys/syscall.h>  /* for SYS_mbind */
+#include <unistd.h>       /* for syscall(), sysconf() */
+
+Q_DEFINE_THIS_MODULE("qf_numa")
+
+/* the memory policy of mbind(2), without the dependency on libnuma */
+#define MPOL_BIND_        2
+#define MPOL_MF_MOVE_     (1 << 1)
+
+static pthread_once_t l_once = PTHREAD_ONCE_INIT;
+static uint8_t l_nNodes = 1U;                 /* # nodes used */
+static uint8_t l_cpuNode[QF_NUMA_MAX_CPU];    /* node of every CPU */
+static int16_t l_aoCpu[QF_MAX_ACTIVE + 1];    /* CPU + 1 of every AO */
+static QNumaStats l_stats[QF_NUMA_MAX_NODE];
+static uintptr_t l_pageSize;
+
+static void numa_discover(void);
+static void numa_bind(void *start, void *end, uint_fast8_t const node);
+
+/*..........................................................................*/
+uint_fast8_t QF_numaNodes(void) {
+    (void)pthread_once(&l_once, &numa_discover);
+    return (uint_fast8_t)l_nNodes;
+}
+/*..........................................................................*/
+uint_fast8_t QF_numaNodeOf(int const cpu) {
+    (void)pthread_once(&l_once, &numa_discover);
+    return ((0 <= cpu) && (cpu < (int)QF_NUMA_MAX_CPU))
+           ? (uint_fast8_t)l_cpuNode[cpu]
+           : (uint_fast8_t)0;
+}
+/*..........................................................................*/
+uint_fast8_t QF_numaSelf(void) {
+    return QF_numaNodeOf(sched_getcpu()); /* vDSO call, no syscall */
+}
+/*..........................................................................*/
+void QF_numaSetCpu(uint_fast8_t const prio, int const cpu) {
+    /** @pre the priority must be in range and the CPU must be known */
+    Q_REQUIRE_ID(100, ((uint_fast8_t)0 < prio)
+                      && (prio <= (uint_fast8_t)QF_MAX_ACTIVE)
+                      && (cpu < (int)QF_NUMA_MAX_CPU));
+    l_aoCpu[prio] = (int16_t)((cpu >= 0) ? (cpu + 1) : 0);
+}
+/*..........................................................................*/
+void *QF_numaAlloc(size_t const size, uint_fast8_t const node) {
+    void *mem;
+
+    /** @pre the node must be in range */
+    Q_REQUIRE_ID(200, node < QF_numaNodes());
+
+    mem = mmap((void *)0, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    /** @post the memory must be available */
+    Q_ENSURE_ID(210, mem != MAP_FAILED);
+
+    /* bind before the first touch, so that the pages come from the node */
+    numa_bind(mem, (uint8_t *)mem + size, node);
+    return mem;
+}
+/*..........................................................................*/
+void QF_numaGetStats(uint_fast8_t const node, QNumaStats * const stats) {
+    /** @pre the node must be in range */
+    Q_REQUIRE_ID(300, node < (uint_fast8_t)QF_NUMA_MAX_NODE);
+
+    stats->nGetLocal  = __atomic_load_n(&l_stats[node].nGetLocal,
+                                        __ATOMIC_RELAXED);
+    stats->nGetRemote = __atomic_load_n(&l_stats[node].nGetRemote,
+                                        __ATOMIC_RELAXED);
+    stats->nPutLocal  = __atomic_load_n(&l_stats[node].nPutLocal,
+                                        __ATOMIC_RELAXED);
+    stats->nPutRemote = __atomic_load_n(&l_stats[node].nPutRemote,
+                                        __ATOMIC_RELAXED);
+}
+
+/****************************************************************************/
+void QNumaPool_init(QNumaPool * const me, void * const poolSto,
+                    uint_fast32_t poolSize, uint_fast16_t blockSize)
+{
+    uint8_t *start = (uint8_t *)poolSto;
+    uint8_t *end = start + poolSize;
+    uint_fast8_t n = QF_numaNodes();
+    uint_fast8_t i;
+
+    /* every part must span at least one whole page of blocks, see NOTE2 */
+    while ((n > (uint_fast8_t)1)
+           && ((poolSize / n) < (l_pageSize + blockSize)))
+    {
+        --n;
+    }
+
+    me->nNodes = (uint8_t)n;
+    for (i = (uint_fast8_t)0; i < n; ++i) {
+        uint8_t *next = end;
+        if ((i + (uint_fast8_t)1) < n) { /* not the last part? */
+            next = (uint8_t *)(((uintptr_t)poolSto
+                       + ((uintptr_t)poolSize / n) * (i + 1U)
+                       + l_pageSize - 1U) & ~(l_pageSize - 1U));
+        }
+        if (n > (uint_fast8_t)1) {
+            numa_bind(start, next, i); /* before QMPool_init() touches it */
+        }
+        QMPool_init(&me->node[i], start, (uint_fast32_t)(next - start),
+                    blockSize);
+        start = next;
+    }
+
+    me->nMin = (QMPoolCtr)0;
+    for (i = (uint_fast8_t)0; i < n; ++i) {
+        me->nMin += me->node[i].nTot;
+    }
+}
+/*..........................................................................*/
+void *QNumaPool_get(QNumaPool * const me, uint_fast16_t const margin) {
+    uint_fast8_t self = QF_numaSelf();
+    uint_fast8_t home = (self < (uint_fast8_t)me->nNodes)
+                        ? self
+                        : (uint_fast8_t)0;
+    void *b = QMPool_get(&me->node[home], margin);
+
+    if (b == (void *)0) { /* local part exhausted? */
+        uint_fast8_t i;
+        for (i = (uint_fast8_t)0;
+             (i < (uint_fast8_t)me->nNodes) && (b == (void *)0);
+             ++i)
+        {
+            if (i != home) {
+                b = QMPool_get(&me->node[i], margin);
+                home = i;
+            }
+        }
+    }
+
+    if (b != (void *)0) {
+        QMPoolCtr nFree = (QMPoolCtr)0;
+        uint_fast8_t i;
+        QF_CRIT_STAT_
+
+        if ((home == self) || (me->nNodes == (uint8_t)1)) {
+            (void)__atomic_fetch_add(&l_stats[self].nGetLocal, 1U,
+                                     __ATOMIC_RELAXED);
+        }
+        else {
+            (void)__atomic_fetch_add(&l_stats[self].nGetRemote, 1U,
+                                     __ATOMIC_RELAXED);
+        }
+
+        /* the low watermark of the whole pool for QF_getPoolMin() */
+        QF_CRIT_ENTRY_();
+        for (i = (uint_fast8_t)0; i < (uint_fast8_t)me->nNodes; ++i) {
+            nFree += me->node[i].nFree;
+        }
+        if (me->nMin > nFree) {
+            me->nMin = nFree;
+        }
+        QF_CRIT_EXIT_();
+    }
+    return b;
+}
+/*..........................................................................*/
+void QNumaPool_put(QNumaPool * const me, void * const b) {
+    uint_fast8_t self = QF_numaSelf();
+    uint_fast8_t i = (uint_fast8_t)me->nNodes - (uint_fast8_t)1;
+
+    /* find the part the block belongs to (the last one by default) */
+    while ((i > (uint_fast8_t)0)
+           && !QF_PTR_RANGE_(b, me->node[i].start, me->node[i].end))
+    {
+        --i;
+    }
+    QMPool_put(&me->node[i], b); /* asserts that the block is in range */
+
+    if ((i == self) || (me->nNodes == (uint8_t)1)) {
+        (void)__atomic_fetch_add(&l_stats[self].nPutLocal, 1U,
+                                 __ATOMIC_RELAXED);
+    }
+    else {
+        (void)__atomic_fetch_add(&l_stats[self].nPutRemote, 1U,
+                                 __ATOMIC_RELAXED);
+    }
+}
+
+/****************************************************************************/
+void QF_numaPlace_(QActive const * const act,
+                   QEvt const *qSto[], uint_fast16_t const qLen,
+                   pthread_attr_t * const attr, size_t const stkSize)
+{
+    int cpu = (int)l_aoCpu[act->prio] - 1;
+
+    if (cpu >= 0) { /* the AO placed with QF_numaSetCpu()? */
+        uint_fast8_t node = QF_numaNodeOf(cpu);
+        size_t size = (stkSize + l_pageSize - 1U) & ~(l_pageSize - 1U);
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        if ((sched_getaffinity(0, sizeof(set), &set) == 0)
+            && CPU_ISSET(cpu, &set)) /* can this process run there? */
+        {
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_attr_setaffinity_np(attr, sizeof(set), &set);
+        }
+
+        /* the stack from the node (never freed, like the AO itself) */
+        pthread_attr_setstack(attr, QF_numaAlloc(size, node), size);
+
+        /* the whole pages of the queue ring */
+        numa_bind(qSto, &qSto[qLen], node);
+    }
+}
+
+/****************************************************************************/
+static void numa_discover(void) {
+    FILE *f;
+    int node;
+
+    l_pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+
+    /* the node of every CPU from the sysfs cpulist, such as "0-3,8-11" */
+    for (node = 0; node < (int)QF_NUMA_MAX_NODE; ++node) {
+        char path[64];
+        int lo;
+        int hi;
+        int c;
+
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/node/node%d/cpulist", node);
+        f = fopen(path, "r");
+        if (f != (FILE *)0) {
+            while (fscanf(f, "%d", &lo) == 1) {
+                hi = lo;
+                c = fgetc(f);
+                if (c == '-') {
+                    if (fscanf(f, "%d", &hi) != 1) {
+                        hi = lo;
+                    }
+                    c = fgetc(f);
+                }
+                for (; (lo <= hi) && (lo < (int)QF_NUMA_MAX_CPU); ++lo) {
+                    l_cpuNode[lo] = (uint8_t)node;
+                }
+                if (c != ',') {
+                    break;
+                }
+            }
+            fclose(f);
+            l_nNodes = (uint8_t)(node + 1);
+        }
+    }
+}
+/*..........................................................................*/
+static void numa_bind(void *start, void *end, uint_fast8_t const node) {
+    uintptr_t lo = ((uintptr_t)start + l_pageSize - 1U) & ~(l_pageSize - 1U);
+    uintptr_t hi = (uintptr_t)end & ~(l_pageSize - 1U);
+    unsigned long mask = 1UL << node;
+
+    if (lo < hi) { /* any whole pages to bind? */
+        /* best-effort, the placement is only a hint, see NOTE1 */
+        (void)syscall(SYS_mbind, (void *)lo, (unsigned long)(hi - lo),
+                      MPOL_BIND_, &mask, (unsigned long)(8U * sizeof(mask)),
+                      MPOL_MF_MOVE_);
+    }
+}
+
+/*****************************************************************************
+* NOTE1:
+* The placement follows the CPU affinity of the AO: its thread is pinned
+* to the CPU given in QF_numaSetCpu() and everything the thread touches
+* all the time (its stack and the ring of its event queue) is bound to the
+* memory of the node of that CPU with mbind(2), called directly so that the
+* port does not depend on libnuma. Only whole pages can be bound, so the
+* queue ring is moved only when it spans at least one whole page. For the
+* complete placement, the ring (and the storage of the event pools) can be
+* allocated with QF_numaAlloc() on the node of the consumer. All bindings
+* are best-effort: on a kernel or a machine without NUMA the memory is
+* simply allocated from the only node. The accesses to a pool that could
+* not be split (a single node or a small pool) are all counted as local.
+*
+* NOTE2:
+* The event pool is split into one part per node (QF_numaNodes() parts),
+* with the boundaries aligned to the pages, so that every part can be bound
+* to its node before QMPool_init() touches its blocks. A pool too small to
+* give every node at least one page is split into fewer parts. The margin
+* requested from QF_newX_() applies to each part separately, so an event
+* allocated with a non-zero margin may be refused a little earlier than
+* with the undivided pool. QF_getPoolMin() reports the low watermark of
+* all the parts together.
+*/
+
+#endif /* QF_NUMA_MAX_NODE */
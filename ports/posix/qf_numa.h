@@ -0,0 +1,121 @@
+/**
+* @file
+* @brief NUMA-aware placement of AOs and event pools (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_numa_h
+#define qf_numa_h
+
+#ifndef QF_NUMA_MAX_CPU
+    /*! The maximum number of CPUs known to the NUMA placement */
+    #define QF_NUMA_MAX_CPU  256U
+#endif
+
+/*! Per-node counters of the event-pool accesses */
+/**
+* @description
+* The counters are kept for the node of the accessing thread. An access is
+* remote when the event block lives in the memory of another node: either
+* the event was allocated from another node because the local part of the
+* pool was exhausted (nGetRemote), or the event was recycled by a thread
+* on another node than the one it was allocated on (nPutRemote), which
+* means that the event crossed the interconnect on its way to the AO. The
+* remote-access ratio of the node is (nGetRemote + nPutRemote) divided by
+* the total of all four counters.
+*/
+typedef struct {
+    uint32_t nGetLocal;   /*!< # events allocated from the local node */
+    uint32_t nGetRemote;  /*!< # events allocated from other nodes */
+    uint32_t nPutLocal;   /*!< # events recycled on their own node */
+    uint32_t nPutRemote;  /*!< # events recycled away from their node */
+} QNumaStats;
+
+/*! The number of NUMA nodes used by the placement (at least 1) */
+uint_fast8_t QF_numaNodes(void);
+
+/*! The NUMA node of the given @p cpu */
+uint_fast8_t QF_numaNodeOf(int const cpu);
+
+/*! The NUMA node of the CPU the calling thread is running on */
+uint_fast8_t QF_numaSelf(void);
+
+/*! Pin the AO of priority @p prio to the CPU @p cpu */
+/**
+* @description
+* Must be called before the AO is started. QActive_start_() then pins the
+* AO thread to the CPU, allocates the thread stack on the node of the CPU
+* and moves the (whole pages of the) event queue storage to that node.
+* A negative @p cpu removes the placement. See NOTE1 in qf_numa.c.
+*/
+void QF_numaSetCpu(uint_fast8_t const prio, int const cpu);
+
+/*! Allocate @p size bytes of page-aligned memory on the NUMA node @p node */
+/**
+* @description
+* The memory is meant for the storage that lives as long as the
+* application (event queues, event pools) and cannot be freed. Binding
+* the memory to the node is best-effort: the memory is always returned,
+* even when the kernel does not support the NUMA policies.
+*/
+void *QF_numaAlloc(size_t const size, uint_fast8_t const node);
+
+/*! Get the counters of the event-pool accesses of the NUMA @p node */
+void QF_numaGetStats(uint_fast8_t const node, QNumaStats * const stats);
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! event pool split into the parts local to each NUMA node */
+    typedef struct {
+        QMPool node[QF_NUMA_MAX_NODE]; /*!< the part on each node */
+        QMPoolCtr nMin;   /*!< the minimum # free blocks in all parts */
+        uint8_t nNodes;   /*!< # parts the pool is split into */
+    } QNumaPool;
+
+    void QNumaPool_init(QNumaPool * const me, void * const poolSto,
+                        uint_fast32_t poolSize, uint_fast16_t blockSize);
+    void *QNumaPool_get(QNumaPool * const me, uint_fast16_t const margin);
+    void QNumaPool_put(QNumaPool * const me, void * const b);
+
+    /*! place the thread, stack and queue of the AO being started */
+    void QF_numaPlace_(QActive const * const act,
+                       QEvt const *qSto[], uint_fast16_t const qLen,
+                       pthread_attr_t * const attr, size_t const stkSize);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_numa_h */
@@ -0,0 +1,578 @@
+/**
+* @file
+* @brief Warm restart of AOs from snapshots and journals (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+
+#ifdef QF_PERSIST         /* warm restart configured? */
+
+#include "qf_persist.h"   /* warm restart interface */
+
+#include <fcntl.h>        /* for open() */
+#include <stdio.h>        /* for snprintf() */
+#include <string.h>       /* for memcpy() */
+#include <sys/mman.h>     /* for mmap() */
+#include <time.h>         /* for clock_gettime() */
+#include <unistd.h>       /* for ftruncate() and close() */
+
+Q_DEFINE_THIS_MODULE("qf_persist")
+
+#define PERSIST_MAGIC     0x52575051U /* "QPWR" */
+#define PERSIST_NONE      0xFFFFFFFFU /* no valid snapshot */
+#define PERSIST_HDR_SIZE  64U         /* the header takes a cache line */
+#define PERSIST_ALIGN(n_) (((uint32_t)(n_) + 7U) & ~(uint32_t)7U)
+
+typedef struct {          /* the header of the file of an AO, see NOTE1 */
+    uint32_t magic;
+    uint32_t prio;
+    uint32_t stateSize;
+    uint32_t slotSize;    /* the size of one snapshot */
+    uint32_t journalSize;
+    uint32_t maxEvtSize;  /* the largest event in the snapshots */
+    uint64_t pos;         /* the valid snapshot and journal, see NOTE2 */
+} QPersistHdr;
+
+typedef struct {          /* a snapshot (followed by the extended state) */
+    uint32_t stateId;     /* the stable ID of the current state */
+    uint32_t nQueued;     /* the events in the queue (after the state) */
+    uint32_t teCtr[QF_PERSIST_MAX_TIMEEVT];      /* 0 for disarmed */
+    uint32_t teInterval[QF_PERSIST_MAX_TIMEEVT];
+} QPersistSlot;
+
+typedef struct {          /* a queued or journaled event */
+    uint32_t sig;
+    uint32_t size;        /* the bytes of the event that follow (0: none) */
+    uint8_t te;           /* 1 + index of the time event (0: none) */
+    uint8_t reserved[7];
+} QPersistRec;
+
+typedef struct {          /* a persistent AO */
+    QActive *act;
+    void *state;          /* the extended state */
+    uint32_t stateSize;
+    uint32_t journalSize;
+    QTimeEvt *te[QF_PERSIST_MAX_TIMEEVT];
+    uint_fast8_t nTe;
+    QPersistHdr *hdr;     /* the mapped file (0 until started) */
+    uint32_t slotSize;
+    uint32_t gen;         /* the last snapshot request served */
+    int64_t next;         /* when the next snapshot is due [ms] */
+    QPersistStats stats;
+} QPersistAO;
+
+typedef struct {          /* a state handler with the stable ID */
+    QStateHandler fun;
+    uint32_t id;
+} QPersistFun;
+
+__thread bool QF_persistReplaying_;
+
+static QPersistAO l_ao[QF_MAX_ACTIVE];
+static uint_fast8_t l_nAO;
+static QPersistAO *l_byPrio[QF_MAX_ACTIVE + 1];
+static QPersistFun l_fun[QF_PERSIST_MAX_FUN];
+static uint_fast16_t l_nFun;
+static char l_dir[256];
+static uint32_t l_period;
+static uint32_t l_gen;    /* incremented by QF_persistSnapshot() */
+
+static QPersistAO *persist_find(QActive const * const me);
+static uint32_t persist_id(QStateHandler const fun);
+static QStateHandler persist_fun(uint32_t const id);
+static QPersistSlot *persist_slot(QPersistAO const * const p,
+                                  uint32_t const n);
+static uint8_t *persist_journal(QPersistAO const * const p);
+static uint32_t persist_evtSize(QEvt const * const e);
+static uint32_t persist_record(QPersistAO const * const p,
+                               QEvt const * const e, uint8_t * const dst);
+static QEvt const *persist_event(QPersistAO const * const p,
+                                 QPersistRec const * const r,
+                                 bool const replay);
+static bool persist_restore(QPersistAO * const p);
+static void persist_snapshot(QPersistAO * const p);
+static int64_t persist_nowUs(void);
+
+/*..........................................................................*/
+void QF_persistInit(char const * const dir, uint32_t const periodMs) {
+    /** @pre the directory name must fit */
+    Q_REQUIRE_ID(100, (dir != (char const *)0)
+                      && (strlen(dir) < sizeof(l_dir)));
+    (void)strcpy(l_dir, dir);
+    l_period = periodMs;
+}
+/*..........................................................................*/
+void QF_persistFun(QStateHandler const fun, char const * const name) {
+    uint32_t id = 2166136261U; /* FNV-1a hash of the name */
+    char const *c;
+    uint_fast16_t n;
+
+    for (c = name; *c != '\0'; ++c) {
+        id = (id ^ (uint32_t)(uint8_t)*c) * 16777619U;
+    }
+    for (n = 0U; n < l_nFun; ++n) {
+        if (l_fun[n].fun == fun) {
+            break; /* already registered */
+        }
+        /* the IDs must be unique */
+        Q_ASSERT_ID(210, l_fun[n].id != id);
+    }
+    if (n == l_nFun) {
+        /** @pre the state handler must fit */
+        Q_REQUIRE_ID(200, l_nFun < (uint_fast16_t)QF_PERSIST_MAX_FUN);
+        l_fun[n].fun = fun;
+        l_fun[n].id  = id;
+        ++l_nFun;
+    }
+}
+/*..........................................................................*/
+void QActive_persist(QActive * const me, void * const state,
+                     uint32_t const stateSize, uint32_t const journalSize)
+{
+    QPersistAO *p;
+
+    /** @pre the AO must be a QHsm, not started and not persistent yet,
+    * and its journal must hold at least a few events
+    */
+    Q_REQUIRE_ID(300, (me->prio == (uint8_t)0)
+        && (me->super.vptr->init == &QHsm_init_)
+        && (persist_find(me) == (QPersistAO *)0)
+        && (l_nAO < (uint_fast8_t)QF_MAX_ACTIVE)
+        && (journalSize >= 256U));
+#ifdef QF_MAX_DOMAIN
+    /* the persistent AOs belong to the domain 0, see NOTE3 in qf_port.h */
+    Q_REQUIRE_ID(301, QF_DOMAIN_ID_() == (uint_fast8_t)0);
+#endif
+
+    p = &l_ao[l_nAO];
+    ++l_nAO;
+    p->act         = me;
+    p->state       = state;
+    p->stateSize   = stateSize;
+    p->journalSize = PERSIST_ALIGN(journalSize);
+}
+/*..........................................................................*/
+void QActive_persistTimeEvt(QActive * const me, QTimeEvt * const te) {
+    QPersistAO * const p = persist_find(me);
+
+    /** @pre the AO must be persistent, the time event must belong to it
+    * and fit
+    */
+    Q_REQUIRE_ID(400, (p != (QPersistAO *)0)
+        && (te->act == (void *)me)
+        && (p->nTe < (uint_fast8_t)QF_PERSIST_MAX_TIMEEVT));
+    p->te[p->nTe] = te;
+    ++p->nTe;
+}
+/*..........................................................................*/
+void QF_persistSnapshot(void) {
+    (void)__atomic_add_fetch(&l_gen, 1U, __ATOMIC_RELAXED);
+}
+/*..........................................................................*/
+bool QF_persistGetStats(uint_fast8_t const prio,
+                        QPersistStats * const stats)
+{
+    QPersistAO *p;
+    QF_CRIT_STAT_
+
+    Q_REQUIRE_ID(450, prio <= (uint_fast8_t)QF_MAX_ACTIVE);
+    QF_CRIT_ENTRY_();
+    p = l_byPrio[prio];
+    if (p != (QPersistAO *)0) {
+        *stats = p->stats; /* the counters are only informative */
+    }
+    QF_CRIT_EXIT_();
+    return (p != (QPersistAO *)0);
+}
+
+/*..........................................................................*/
+bool QF_persistStart_(QActive * const me, uint_fast16_t const qLen) {
+    QPersistAO * const p = persist_find(me);
+    bool isWarm = false;
+
+    if (p != (QPersistAO *)0) {
+        uint32_t const maxEvt = PERSIST_ALIGN(
+            (QF_maxPool_ != (uint_fast8_t)0)
+            ? QF_poolGetMaxBlockSize()
+            : (uint_fast16_t)sizeof(QEvt));
+        size_t size;
+        char path[sizeof(l_dir) + 16];
+        QPersistHdr *hdr;
+        int fd;
+
+        /** @pre QF_persistInit() must have been called and the journal
+        * must hold at least the largest event
+        */
+        Q_REQUIRE_ID(500, (l_dir[0] != '\0')
+            && (p->journalSize >= (uint32_t)sizeof(QPersistRec) + maxEvt));
+
+        /* a snapshot holds the whole queue (including the front event) */
+        p->slotSize = (uint32_t)sizeof(QPersistSlot)
+            + PERSIST_ALIGN(p->stateSize)
+            + ((uint32_t)qLen + 1U)
+              * ((uint32_t)sizeof(QPersistRec) + maxEvt);
+        size = (size_t)PERSIST_HDR_SIZE + (2U * (size_t)p->slotSize)
+               + (size_t)p->journalSize;
+
+        (void)snprintf(path, sizeof(path), "%s/ao%02u.qpw",
+                       l_dir, (unsigned)me->prio);
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        Q_ASSERT_ID(510, fd >= 0);
+        Q_ALLEGE_ID(520, ftruncate(fd, (off_t)size) == 0);
+        hdr = (QPersistHdr *)mmap((void *)0, size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED, fd, 0);
+        Q_ASSERT_ID(530, hdr != (QPersistHdr *)MAP_FAILED);
+        (void)close(fd);
+
+        p->hdr = hdr;
+        l_byPrio[me->prio] = p;
+
+        /* a valid snapshot of the same layout? */
+        if ((hdr->magic == PERSIST_MAGIC)
+            && (hdr->prio == (uint32_t)me->prio)
+            && (hdr->stateSize == p->stateSize)
+            && (hdr->slotSize == p->slotSize)
+            && (hdr->journalSize == p->journalSize)
+            && (hdr->maxEvtSize == maxEvt)
+            && ((uint32_t)(hdr->pos >> 32) < 2U))
+        {
+            isWarm = persist_restore(p);
+        }
+        if (!isWarm) { /* cold start, QHSM_INIT() follows */
+            hdr->magic       = PERSIST_MAGIC;
+            hdr->prio        = (uint32_t)me->prio;
+            hdr->stateSize   = p->stateSize;
+            hdr->slotSize    = p->slotSize;
+            hdr->journalSize = p->journalSize;
+            hdr->maxEvtSize  = maxEvt;
+            hdr->pos         = (uint64_t)PERSIST_NONE << 32;
+        }
+        p->stats.isWarm = isWarm;
+    }
+    return isWarm;
+}
+/*..........................................................................*/
+void QF_persistStarted_(QActive * const me) {
+    QPersistAO * const p = l_byPrio[me->prio];
+    if (p != (QPersistAO *)0) {
+        p->gen = __atomic_load_n(&l_gen, __ATOMIC_RELAXED);
+        persist_snapshot(p); /* the base of the journal */
+    }
+}
+/*..........................................................................*/
+void QF_persistPre_(QActive * const me, QEvt const * const e) {
+    QPersistAO * const p = l_byPrio[me->prio];
+    if (p != (QPersistAO *)0) {
+        uint32_t const need = (uint32_t)sizeof(QPersistRec)
+                              + PERSIST_ALIGN(persist_evtSize(e));
+        uint64_t const pos = p->hdr->pos;
+
+        /* the journal always has room for the next event, see NOTE2 */
+        Q_ASSERT_ID(600, (uint32_t)pos + need <= p->journalSize);
+
+        (void)persist_record(p, e, persist_journal(p) + (uint32_t)pos);
+
+        /* commit the record, see NOTE2 */
+        __atomic_store_n(&p->hdr->pos, pos + (uint64_t)need,
+                         __ATOMIC_RELEASE);
+        ++p->stats.nJournaled;
+    }
+}
+/*..........................................................................*/
+void QF_persistPost_(QActive * const me) {
+    QPersistAO * const p = l_byPrio[me->prio];
+    if (p != (QPersistAO *)0) {
+        uint32_t const gen = __atomic_load_n(&l_gen, __ATOMIC_RELAXED);
+        uint32_t const maxRec = (uint32_t)sizeof(QPersistRec)
+                                + p->hdr->maxEvtSize;
+        if ((gen != p->gen)
+            || ((persist_nowUs() / 1000) >= p->next)
+            || ((uint32_t)p->hdr->pos + maxRec > p->journalSize)) /* full? */
+        {
+            p->gen = gen;
+            persist_snapshot(p);
+        }
+    }
+}
+
+/*..........................................................................*/
+static QPersistAO *persist_find(QActive const * const me) {
+    QPersistAO *p = (QPersistAO *)0;
+    uint_fast8_t n;
+    for (n = 0U; (n < l_nAO) && (p == (QPersistAO *)0); ++n) {
+        if (l_ao[n].act == me) {
+            p = &l_ao[n];
+        }
+    }
+    return p;
+}
+/*..........................................................................*/
+static uint32_t persist_id(QStateHandler const fun) {
+    uint_fast16_t n = 0U;
+    while ((n < l_nFun) && (l_fun[n].fun != fun)) {
+        ++n;
+    }
+    /* every state of the persistent AO must have a stable ID */
+    Q_ASSERT_ID(700, n < l_nFun);
+    return l_fun[n].id;
+}
+/*..........................................................................*/
+static QStateHandler persist_fun(uint32_t const id) {
+    uint_fast16_t n = 0U;
+    while ((n < l_nFun) && (l_fun[n].id != id)) {
+        ++n;
+    }
+    return (n < l_nFun)
+           ? l_fun[n].fun
+           : (QStateHandler)0; /* the state is gone from this build */
+}
+/*..........................................................................*/
+static QPersistSlot *persist_slot(QPersistAO const * const p,
+                                  uint32_t const n)
+{
+    return (QPersistSlot *)((uint8_t *)p->hdr + PERSIST_HDR_SIZE
+                            + (n * p->slotSize));
+}
+/*..........................................................................*/
+static uint8_t *persist_journal(QPersistAO const * const p) {
+    return (uint8_t *)p->hdr + PERSIST_HDR_SIZE + (2U * p->slotSize);
+}
+/*..........................................................................*/
+static uint32_t persist_evtSize(QEvt const * const e) {
+    return (e->poolId_ != (uint8_t)0) /* a pool event? */
+        ? (uint32_t)QF_EPOOL_EVENT_SIZE_(QF_pool_[e->poolId_ - 1U])
+        : 0U; /* only the signal of the static events, see NOTE3 */
+}
+/*..........................................................................*/
+static uint32_t persist_record(QPersistAO const * const p,
+                               QEvt const * const e, uint8_t * const dst)
+{
+    QPersistRec * const r = (QPersistRec *)dst;
+    uint_fast8_t n;
+
+    r->sig  = (uint32_t)e->sig;
+    r->size = persist_evtSize(e);
+    r->te   = (uint8_t)0;
+    if (r->size != 0U) {
+        memcpy(r + 1, e, r->size);
+    }
+    else {
+        for (n = 0U; n < p->nTe; ++n) {
+            if (e == &p->te[n]->super) {
+                r->te = (uint8_t)(n + 1U);
+            }
+        }
+    }
+    return (uint32_t)sizeof(QPersistRec) + PERSIST_ALIGN(r->size);
+}
+/*..........................................................................*/
+static QEvt const *persist_event(QPersistAO const * const p,
+                                 QPersistRec const * const r,
+                                 bool const replay)
+{
+    QEvt const *e;
+
+    if (r->te != (uint8_t)0) { /* one of the time events of the AO? */
+        QTimeEvt * const te = p->te[r->te - 1U];
+        if (replay && (te->interval == (QTimeEvtCtr)0)) {
+            (void)QTimeEvt_disarm(te); /* it expired after the snapshot */
+        }
+        e = &te->super;
+    }
+    else { /* an event from a pool (or just the signal, see NOTE3) */
+        QEvt *d = QF_newX_((r->size != 0U)
+                           ? (uint_fast16_t)r->size
+                           : (uint_fast16_t)sizeof(QEvt),
+                           (uint_fast16_t)0, (enum_t)r->sig);
+        if (r->size > (uint32_t)sizeof(QEvt)) { /* keep poolId_/refCtr_ */
+            memcpy(d + 1, (QEvt const *)(r + 1) + 1,
+                   r->size - (uint32_t)sizeof(QEvt));
+        }
+        e = d;
+    }
+    return e;
+}
+/*..........................................................................*/
+static bool persist_restore(QPersistAO * const p) {
+    uint64_t const pos = p->hdr->pos;
+    QPersistSlot const * const slot = persist_slot(p, (uint32_t)(pos >> 32));
+    QStateHandler const fun = persist_fun(slot->stateId);
+
+    if (fun != (QStateHandler)0) { /* the state still exists? */
+        int64_t const start = persist_nowUs();
+        QActive * const me = p->act;
+        uint8_t const *rec;
+        uint8_t const *end;
+        uint_fast8_t n;
+        uint32_t i;
+
+        me->super.state.fun = fun; /* as QHsm_init_() leaves it */
+        me->super.temp.fun  = fun;
+        memcpy(p->state, slot + 1, p->stateSize);
+        for (n = 0U; n < p->nTe; ++n) {
+            if (slot->teCtr[n] != 0U) {
+                QTimeEvt_armX(p->te[n], (QTimeEvtCtr)slot->teCtr[n],
+                              (QTimeEvtCtr)slot->teInterval[n]);
+            }
+        }
+
+        /* replay the journal without posting any events, see NOTE3 */
+        QF_persistReplaying_ = true;
+        rec = persist_journal(p);
+        end = rec + (uint32_t)pos;
+        while (rec < end) {
+            QPersistRec const * const r = (QPersistRec const *)rec;
+            QEvt const * const e = persist_event(p, r, true);
+            if (e->poolId_ != (uint8_t)0) { /* hold it as the queue would */
+                QF_EVT_REF_CTR_INC_(e);
+            }
+            QHSM_DISPATCH(&me->super, e);
+            QF_gc(e);
+            rec += sizeof(QPersistRec) + PERSIST_ALIGN(r->size);
+            ++p->stats.nReplayed;
+        }
+        QF_persistReplaying_ = false;
+
+        /* requeue the events not dispatched since the snapshot */
+        rec = (uint8_t const *)(slot + 1) + PERSIST_ALIGN(p->stateSize);
+        for (i = 0U; i < slot->nQueued; ++i) {
+            QPersistRec const * const r = (QPersistRec const *)rec;
+            if (i >= p->stats.nReplayed) { /* the queue is FIFO */
+                QACTIVE_POST(me, persist_event(p, r, false), me);
+                ++p->stats.nRequeued;
+            }
+            rec += sizeof(QPersistRec) + PERSIST_ALIGN(r->size);
+        }
+        p->stats.restoreUs = (uint32_t)(persist_nowUs() - start);
+    }
+    return (fun != (QStateHandler)0);
+}
+/*..........................................................................*/
+static void persist_snapshot(QPersistAO * const p) {
+    QActive * const me = p->act;
+    uint32_t const next = ((uint32_t)(p->hdr->pos >> 32) == 0U) ? 1U : 0U;
+    QPersistSlot * const slot = persist_slot(p, next);
+    uint8_t *rec;
+    uint_fast8_t n;
+    QF_CRIT_STAT_
+
+    slot->stateId = persist_id(me->super.state.fun);
+    for (n = 0U; n < p->nTe; ++n) {
+        slot->teCtr[n]      = (uint32_t)QTimeEvt_ctr(p->te[n]);
+        slot->teInterval[n] = (uint32_t)p->te[n]->interval;
+    }
+    memcpy(slot + 1, p->state, p->stateSize);
+
+    /* the events in the queue, in the order of their dispatching */
+    rec = (uint8_t *)(slot + 1) + PERSIST_ALIGN(p->stateSize);
+    slot->nQueued = 0U;
+    QF_CRIT_ENTRY_();
+    if (me->eQueue.frontEvt != (QEvt const *)0) {
+        QEQueueCtr i = me->eQueue.tail;
+        QEQueueCtr k = me->eQueue.end - me->eQueue.nFree; /* in the ring */
+        rec += persist_record(p, me->eQueue.frontEvt, rec);
+        for (slot->nQueued = 1U; k != (QEQueueCtr)0; --k) {
+            rec += persist_record(p, QF_PTR_AT_(me->eQueue.ring, i), rec);
+            ++slot->nQueued;
+            if (i == (QEQueueCtr)0) {
+                i = me->eQueue.end; /* wrap around */
+            }
+            --i;
+        }
+    }
+    QF_CRIT_EXIT_();
+
+    /* switch to the new snapshot with an empty journal, see NOTE2 */
+    __atomic_store_n(&p->hdr->pos, (uint64_t)next << 32, __ATOMIC_RELEASE);
+    ++p->stats.nSnapshots;
+    p->next = (persist_nowUs() / 1000) + (int64_t)l_period;
+}
+/*..........................................................................*/
+static int64_t persist_nowUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000) + ((int64_t)ts.tv_nsec / 1000);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The file of a persistent AO consists of the header, two slots for the
+* snapshots and the journal. A snapshot holds the stable ID of the current
+* state (the FNV-1a hash of the name of the state handler, which does not
+* change between the builds unlike its address), the extended state, the
+* time events of the AO and the events in its queue. The snapshots and the
+* journal are written by the thread of the AO between the dispatches, so
+* the AOs never stop for each other. The file is shared memory mapped, so
+* it survives the crash of the process (but not of the OS, as nothing is
+* synced to the disk explicitly). A file of a different layout (e.g., after
+* the extended state of the AO changed) leads to a cold start.
+*
+* NOTE2:
+* The 64-bit pos in the header holds the valid slot (upper 32 bits) and
+* the bytes of the journal written after that snapshot (lower 32 bits),
+* so the new snapshot and the new journal record are committed with one
+* atomic store each. A crash in the middle of writing a snapshot or a
+* record leaves the previous state of the file intact. A snapshot is
+* taken only after a dispatch (also when the journal could not hold the
+* largest event any more), so the journal always starts with the front
+* event of the snapshot of the queue.
+*
+* NOTE3:
+* Restoring an AO sets its state and extended state from the snapshot,
+* re-arms its time events and dispatches the journaled events again, with
+* all the posting and publishing of the replaying thread suppressed (as
+* those events were already delivered before the restart). The one-shot
+* time events that expired after the snapshot are disarmed. The events
+* from the snapshot of the queue which were not dispatched yet are then
+* posted back, assuming that the queue is FIFO (no QACTIVE_POST_LIFO()).
+* The events posted to the AO after the snapshot and still waiting in the
+* queue at the crash are lost. Static events are restored as dynamic
+* events carrying just the signal (the event pools must be initialized
+* before the persistent AOs are started), except for the time events
+* registered with QActive_persistTimeEvt(). Events delivered through the
+* channels of qf_channel.h are not journaled.
+*/
+
+#endif /* QF_PERSIST */
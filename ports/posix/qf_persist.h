@@ -0,0 +1,123 @@
+/**
+* @file
+* @brief Warm restart of AOs from snapshots and journals (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_persist_h
+#define qf_persist_h
+
+#ifndef QF_PERSIST_MAX_TIMEEVT
+    /*! The maximum number of persistent time events of one AO */
+    #define QF_PERSIST_MAX_TIMEEVT  4U
+#endif
+
+#ifndef QF_PERSIST_MAX_FUN
+    /*! The maximum number of state handlers with stable IDs */
+    #define QF_PERSIST_MAX_FUN      256U
+#endif
+
+/*! Persistence statistics of one AO */
+typedef struct {
+    uint32_t nSnapshots; /*!< snapshots taken since the start */
+    uint32_t nJournaled; /*!< events journaled since the start */
+    uint32_t nReplayed;  /*!< events replayed from the journal */
+    uint32_t nRequeued;  /*!< events restored into the event queue */
+    uint32_t restoreUs;  /*!< duration of the restore [us] */
+    bool isWarm;         /*!< restored instead of the initial transition */
+} QPersistStats;
+
+/*! Keep the persistent AOs in directory @p dir, see NOTE1 in qf_persist.c */
+/**
+* @description
+* Every AO made persistent with QActive_persist() gets the file
+* @p dir/aoNN.qpw (NN being its priority), which holds two snapshots of
+* the AO and the journal of the events dispatched since the last one.
+* The AO takes a new snapshot after a dispatch once @p periodMs passed
+* since the previous one (or when its journal is full). Must be called
+* after QF_init() and before starting the persistent AOs.
+*/
+void QF_persistInit(char const * const dir, uint32_t const periodMs);
+
+/*! Give the state handler @p fun the stable ID derived from @p name */
+void QF_persistFun(QStateHandler const fun, char const * const name);
+
+/*! Register the state handler @p fun_ under its own name */
+#define QF_PERSIST_FUN(fun_) \
+    QF_persistFun(Q_STATE_CAST(&(fun_)), #fun_)
+
+/*! Make the AO @p me persistent (before starting it) */
+/**
+* @description
+* The extended state of the AO is the region of @p stateSize bytes at
+* @p state (which must not hold pointers to dynamic data) and the journal
+* takes at most @p journalSize bytes. All the states of the AO must be
+* registered with QF_PERSIST_FUN().
+*/
+void QActive_persist(QActive * const me, void * const state,
+                     uint32_t const stateSize, uint32_t const journalSize);
+
+/*! Include the time event @p te of the AO @p me in its snapshots */
+void QActive_persistTimeEvt(QActive * const me, QTimeEvt * const te);
+
+/*! Make every persistent AO take a snapshot after its next dispatch */
+void QF_persistSnapshot(void);
+
+/*! Get the persistence statistics of the AO at @p prio (false if none) */
+bool QF_persistGetStats(uint_fast8_t const prio,
+                        QPersistStats * const stats);
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! true in the thread replaying the journal of an AO */
+    extern __thread bool QF_persistReplaying_;
+
+    /*! open the file of the AO and restore it (false for a cold start) */
+    bool QF_persistStart_(QActive * const me, uint_fast16_t const qLen);
+
+    /*! take the first snapshot of the just started AO */
+    void QF_persistStarted_(QActive * const me);
+
+    /*! journal the event @p e about to be dispatched to the AO @p me */
+    void QF_persistPre_(QActive * const me, QEvt const * const e);
+
+    /*! take the snapshot of the AO @p me after a dispatch, if due */
+    void QF_persistPost_(QActive * const me);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_persist_h */
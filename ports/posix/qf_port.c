@@ -37,6 +37,7 @@
 ******************************************************************************
 * @endcond
 */
+#define _GNU_SOURCE       /* for pthread_getattr_np() */
 #define QP_IMPL           /* this is QP implementation */
 #include "qf_port.h"      /* QF port */
 #include "qf_pkg.h"
@@ -47,29 +48,113 @@
     #include "qs_dummy.h" /* disable the QS software tracing */
 #endif /* Q_SPY */
 
+#include "qf_channel.h"   /* SPSC channels between AOs */
+#include "qf_start.h"     /* parallel startup of AOs */
+#ifdef QF_MAX_DOMAIN
+    #include "qf_domain.h" /* independent QF domains */
+#endif
+
+#include <errno.h>        /* for errno */
 #include <limits.h>       /* for PTHREAD_STACK_MIN */
+#include <malloc.h>       /* for mallopt() */
+#include <stdlib.h>       /* for malloc() */
 #include <sys/mman.h>     /* for mlockall() */
+#include <sys/eventfd.h>  /* for eventfd() */
+#include <sys/timerfd.h>  /* for timerfd_create() and timerfd_settime() */
+#include <semaphore.h>    /* for sem_post() in QF_stop() */
+#include <unistd.h>       /* for read() and write() */
 
 Q_DEFINE_THIS_MODULE("qf_port")
 
 /* Global objects ----------------------------------------------------------*/
+#ifndef QF_MAX_DOMAIN
 pthread_mutex_t QF_pThreadMutex_;
+#else
+__thread uint8_t QF_domainId_;  /* domain 0 unless set, see NOTE3 */
+pthread_mutex_t QF_domainMutex_[QF_MAX_DOMAIN];
+#endif
 
 /* Local objects -----------------------------------------------------------*/
+enum { NANOSLEEP_NSEC_PER_SEC = 1000000000 }; /* see NOTE05 */
+
+typedef struct {           /* independent tick source, see NOTE07 */
+    pthread_t thread;      /* the thread ticking this rate */
+    int tfd;               /* the periodic timerfd (-1 if not used) */
+    uint32_t nOverruns;    /* # ticks replayed late */
+    bool volatile isRunning;
+#ifdef QF_MAX_DOMAIN
+    uint8_t domain;        /* the QF domain ticked by this source */
+#endif
+} QTickSrc;
+
+#ifndef QF_MAX_DOMAIN
 static bool l_isRunning;
 static struct timespec l_tick;
-enum { NANOSLEEP_NSEC_PER_SEC = 1000000000 }; /* see NOTE05 */
+
+static int l_pollFd = -1;  /* eventfd signaling polled AOs, see NOTE06 */
+static QPSet l_pollSet;    /* ready-set of the polled AOs */
+
+static sem_t l_stopSem;    /* wakes up the idle QF_run(), see NOTE07 */
+static QTickSrc l_tickSrc[QF_MAX_TICK_RATE];
+#else
+typedef struct {           /* the port objects of one QF domain, see NOTE3 */
+    bool isRunning;
+    struct timespec tick;
+    int pollFd;
+    QPSet pollSet;
+    sem_t stopSem;
+    QTickSrc tickSrc[QF_MAX_TICK_RATE];
+} QFDomainPort;
+static QFDomainPort l_domain[QF_MAX_DOMAIN] = {
+    [0 ... (QF_MAX_DOMAIN - 1)] = { .pollFd = -1 }
+};
+
+/* the port objects of the domain of the calling thread */
+#define l_isRunning (l_domain[QF_domainId_].isRunning)
+#define l_tick      (l_domain[QF_domainId_].tick)
+#define l_pollFd    (l_domain[QF_domainId_].pollFd)
+#define l_pollSet   (l_domain[QF_domainId_].pollSet)
+#define l_stopSem   (l_domain[QF_domainId_].stopSem)
+#define l_tickSrc   (l_domain[QF_domainId_].tickSrc)
+#endif /* QF_MAX_DOMAIN */
+
+static QFRtProfile l_rt;   /* the real-time profile, see NOTE6 in qf_port.h */
+static uint8_t l_rtFailures; /* QF_RT_... features not in effect */
+
+static void *tick_routine(void *arg);
+static void rt_failed(uint8_t const feature, int const err);
+static void rt_prefaultHeap(size_t const size);
+static void rt_prefaultStack(size_t const size);
+static void ao_init(QActive * const me, QEvt const * const ie);
 
 /*..........................................................................*/
 void QF_init(void) {
-    extern uint_fast8_t QF_maxPool_;
-    extern QTimeEvt QF_timeEvtHead_[QF_MAX_TICK_RATE];
+    uint_fast8_t i;
 
-    /* lock memory so we're never swapped out to disk */
-    /*mlockall(MCL_CURRENT | MCL_FUTURE);  uncomment when supported */
+    pthread_mutexattr_t attr;
 
-    /* init the global mutex with the default non-recursive initializer */
-    pthread_mutex_init(&QF_pThreadMutex_, NULL);
+    /* lock memory so we're never swapped out to disk, see NOTE6 */
+    if ((l_rt.flags & QF_RT_MLOCK) != 0U) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            rt_failed(QF_RT_MLOCK, errno);
+        }
+    }
+    if ((l_rt.flags & QF_RT_PREFAULT) != 0U) {
+        rt_prefaultHeap(l_rt.heapSize);
+    }
+
+    /* init the global mutex (non-recursive), with priority inheritance
+    * in the real-time profile
+    */
+    pthread_mutexattr_init(&attr);
+    if ((l_rt.flags & QF_RT_PI_MUTEX) != 0U) {
+        int err = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+        if (err != 0) {
+            rt_failed(QF_RT_PI_MUTEX, err);
+        }
+    }
+    pthread_mutex_init(&QF_pThreadMutex_, &attr);
+    pthread_mutexattr_destroy(&attr);
 
     /* clear the internal QF variables, so that the framework can (re)start
     * correctly even if the startup code is not called to clear the
@@ -78,30 +163,74 @@ void QF_init(void) {
     QF_maxPool_ = (uint_fast8_t)0;
     QF_bzero(&QF_timeEvtHead_[0], (uint_fast16_t)sizeof(QF_timeEvtHead_));
     QF_bzero(&QF_active_[0],      (uint_fast16_t)sizeof(QF_active_));
+    QF_bzero(&l_pollSet,          (uint_fast16_t)sizeof(l_pollSet));
 
     l_tick.tv_sec = 0;
     l_tick.tv_nsec = NANOSLEEP_NSEC_PER_SEC/100L; /* default clock tick */
+
+    QF_bzero(&l_tickSrc[0], (uint_fast16_t)sizeof(l_tickSrc));
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)QF_MAX_TICK_RATE; ++i) {
+        l_tickSrc[i].tfd = -1;
+    }
+    (void)sem_init(&l_stopSem, 0, 0U);
 }
 /*..........................................................................*/
 int_t QF_run(void) {
     struct sched_param sparam;
+    uint_fast8_t i;
+    int err;
 
+    QF_startGate_(); /* the AOs initialized in parallel, see qf_start.c */
     QF_onStartup();  /* invoke startup callback */
 
     /* try to maximize the priority of the ticker thread, see NOTE01 */
-    sparam.sched_priority = sched_get_priority_max(SCHED_FIFO);
-    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sparam) == 0) {
-        /* success, this application has sufficient privileges */
+    sparam.sched_priority = QF_isrPrio_((uint_fast8_t)0);
+    err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sparam);
+    /* setting priority failed, probably due to insufficient privieges? */
+    if ((err != 0) && ((l_rt.flags & QF_RT_FIFO) != 0U)) {
+        rt_failed(QF_RT_FIFO, err); /* report only when requested */
     }
-    else {
-        /* setting priority failed, probably due to insufficient privieges */
+    if ((l_rt.flags & QF_RT_PREFAULT) != 0U) {
+        rt_prefaultStack((l_rt.stkSize != (size_t)0)
+                         ? l_rt.stkSize
+                         : (size_t)PTHREAD_STACK_MIN);
     }
 
     l_isRunning = true;
-    while (l_isRunning) { /* the clock tick loop... */
-        QF_onClockTick(); /* clock tick callback (must call QF_TICK_X()) */
+    if ((l_tick.tv_sec == 0) && (l_tick.tv_nsec == 0)) { /* no ticker? */
+        while (l_isRunning) { /* sleep until QF_stop(), see NOTE07 */
+            (void)sem_wait(&l_stopSem);
+        }
+    }
+    else {
+#ifdef QF_TICK_JITTER
+        for (i = (uint_fast8_t)0; i < (uint_fast8_t)QF_MAX_TICK_RATE; ++i) {
+            if (l_tickSrc[i].tfd < 0) { /* ticked from QF_onClockTick()? */
+                QF_jitterGrid_(i, (int64_t)l_tick.tv_sec * 1000000000
+                                  + (int64_t)l_tick.tv_nsec, (int64_t)0);
+            }
+        }
+#endif
+        while (l_isRunning) { /* the clock tick loop... */
+            QF_onClockTick(); /* clock tick callback (must call QF_TICK_X())*/
+
+            nanosleep(&l_tick, NULL); /* sleep for the # ticks, NOTE05 */
+        }
+    }
 
-        nanosleep(&l_tick, NULL); /* sleep for the number of ticks, NOTE05 */
+    /* stop the independent tick sources before cleaning up */
+    for (i = (uint_fast8_t)0; i < (uint_fast8_t)QF_MAX_TICK_RATE; ++i) {
+        if (l_tickSrc[i].tfd >= 0) {
+            struct itimerspec its;
+            QF_bzero(&its, (uint_fast16_t)sizeof(its));
+            its.it_value.tv_nsec = 1; /* expire right away */
+            l_tickSrc[i].isRunning = false;
+            (void)timerfd_settime(l_tickSrc[i].tfd, 0, &its,
+                                  (struct itimerspec *)0);
+            (void)pthread_join(l_tickSrc[i].thread, (void **)0);
+            (void)close(l_tickSrc[i].tfd);
+            l_tickSrc[i].tfd = -1;
+        }
     }
     QF_onCleanup(); /* invoke cleanup callback */
     pthread_mutex_destroy(&QF_pThreadMutex_);
@@ -110,20 +239,143 @@ int_t QF_run(void) {
 }
 /*..........................................................................*/
 void QF_setTickRate(uint32_t ticksPerSec) {
-    l_tick.tv_nsec = NANOSLEEP_NSEC_PER_SEC / ticksPerSec;
+    l_tick.tv_nsec = (ticksPerSec != (uint32_t)0)
+                     ? (NANOSLEEP_NSEC_PER_SEC / ticksPerSec)
+                     : 0; /* no QF_onClockTick() at all, see NOTE07 */
+}
+/*..........................................................................*/
+/**
+* @description
+* Drives the tick rate @p tickRate by its own periodic timerfd and thread,
+* which calls QF_TICK_X() for this rate @p ticksPerSec times per second,
+* independently of QF_onClockTick() and of the other tick rates. Calling
+* the function again for the same rate changes the period.
+*
+* @note QF_onClockTick() must not call QF_TICK_X() for the tick rates
+* driven by the independent tick sources.
+*/
+void QF_setTickRateX(uint_fast8_t const tickRate,
+                     uint32_t const ticksPerSec)
+{
+    QTickSrc * const src = &l_tickSrc[tickRate];
+    struct itimerspec its;
+
+    /** @pre the tick rate must be in range and the frequency non-zero */
+    Q_REQUIRE_ID(700, (tickRate < (uint_fast8_t)QF_MAX_TICK_RATE)
+                      && (ticksPerSec != (uint32_t)0));
+
+    if (src->tfd < 0) { /* not started yet? */
+        pthread_attr_t attr;
+
+        src->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        Q_ASSERT_ID(720, src->tfd >= 0);
+        src->isRunning = true;
+#ifdef QF_MAX_DOMAIN
+        src->domain = QF_domainId_; /* tick the domain of the caller */
+#endif
+
+        /* the tick sources run at the top "ISR-like" priorities, the faster
+        * (lower) tick rates at the higher priority, see NOTE04 and NOTE07
+        */
+        QF_threadAttrInit_(&attr);
+        QF_createThread_(&src->thread, &attr,
+                         QF_isrPrio_((tickRate < (uint_fast8_t)2)
+                                     ? tickRate : (uint_fast8_t)2),
+                         &tick_routine, (void *)src);
+        pthread_attr_destroy(&attr);
+    }
+
+    its.it_interval.tv_sec  = (time_t)(1U / ticksPerSec);
+    its.it_interval.tv_nsec = (ticksPerSec > (uint32_t)1)
+                              ? (long)(NANOSLEEP_NSEC_PER_SEC / ticksPerSec)
+                              : 0L;
+
+    /* the first tick after one period, on an absolute grid of ticks */
+    (void)clock_gettime(CLOCK_MONOTONIC, &its.it_value);
+    its.it_value.tv_sec  += its.it_interval.tv_sec;
+    its.it_value.tv_nsec += its.it_interval.tv_nsec;
+    if (its.it_value.tv_nsec >= 1000000000L) {
+        its.it_value.tv_nsec -= 1000000000L;
+        ++its.it_value.tv_sec;
+    }
+    Q_ALLEGE_ID(730, timerfd_settime(src->tfd, TFD_TIMER_ABSTIME, &its,
+                                     (struct itimerspec *)0) == 0);
+#ifdef QF_TICK_JITTER
+    QF_jitterGrid_(tickRate, (int64_t)its.it_interval.tv_sec * 1000000000
+                             + (int64_t)its.it_interval.tv_nsec,
+                   (int64_t)its.it_value.tv_sec * 1000000000
+                   + (int64_t)its.it_value.tv_nsec);
+#endif
+}
+/*..........................................................................*/
+uint32_t QF_getTickOverruns(uint_fast8_t const tickRate) {
+    /** @pre the tick rate must be in range */
+    Q_REQUIRE_ID(800, tickRate < (uint_fast8_t)QF_MAX_TICK_RATE);
+    return l_tickSrc[tickRate].nOverruns;
+}
+/*..........................................................................*/
+static void *tick_routine(void *arg) { /* the expected POSIX signature */
+    QTickSrc * const src = (QTickSrc *)arg;
+    uint_fast8_t tickRate;
+    uint64_t exp;
+
+#ifdef QF_MAX_DOMAIN
+    QF_domainId_ = src->domain; /* enter the domain of the tick source */
+#endif
+    tickRate = (uint_fast8_t)(src - &l_tickSrc[0]);
+    if ((l_rt.flags & QF_RT_PREFAULT) != 0U) {
+        rt_prefaultStack((size_t)-1); /* the whole stack */
+    }
+
+    while (src->isRunning) {
+        if (read(src->tfd, &exp, sizeof(exp)) == (ssize_t)sizeof(exp)) {
+            if (src->isRunning) {
+                /* replay the ticks missed by a late wakeup (if any), so
+                * that the time events do not fall behind, see NOTE07
+                */
+                src->nOverruns += (uint32_t)(exp - 1U);
+                for (; exp != (uint64_t)0; --exp) {
+                    QF_TICK_X(tickRate, src);
+                }
+            }
+        }
+    }
+    return (void *)0; /* return success */
 }
 /*..........................................................................*/
 void QF_stop(void) {
     l_isRunning = false; /* stop the loop in QF_run() */
+    (void)sem_post(&l_stopSem); /* async-signal-safe, see NOTE07 */
 }
 /*..........................................................................*/
 static void *thread_routine(void *arg) { /* the expected POSIX signature */
     QActive *act = (QActive *)arg;
+    QEvt const *ie;
+#ifdef QF_MAX_DOMAIN
+    QF_domainId_ = (uint8_t)QF_domainOf(act); /* enter the domain of AO */
+#endif
+#ifndef QF_STACK_WATCH /* the painted stack is resident already */
+    if ((l_rt.flags & QF_RT_PREFAULT) != 0U) {
+        rt_prefaultStack((size_t)-1); /* the whole stack */
+    }
+#endif
+    if (QF_startWait_(act->prio, &ie)) { /* the parallel startup? */
+        ao_init(act, ie); /* after the dependencies, see qf_start.c */
+        QF_startEnd_(act->prio);
+    }
     /* loop until m_thread is cleared in QActive_stop() */
     do {
         QEvt const *e = QActive_get_(act); /* wait for the event */
-        QHSM_DISPATCH(&act->super, e);     /* dispatch to the HSM */
-        QF_gc(e);    /* check if the event is garbage, and collect it if so */
+        if (e->sig != QF_CHANNEL_SIG_) {
+            QF_DISPATCH_HOOK_(e); /* e.g., measure the time-event delay */
+            QF_PERSIST_PRE_(act, e); /* journal the event */
+            QHSM_DISPATCH(&act->super, e); /* dispatch to the HSM */
+            QF_PERSIST_POST_(act); /* snapshot the AO, if due */
+            QF_gc(e); /* check if the event is garbage, and collect it */
+        }
+        else { /* doorbell of a channel, see NOTE1 in qf_channel.c */
+            QChannel_service_((QChannel *)e);
+        }
     } while (act->thread != (uint8_t)0);
     QF_remove_(act); /* remove this object from the framework */
     pthread_cond_destroy(&act->osObject); /* cleanup the condition variable */
@@ -137,7 +389,7 @@ void QActive_start_(QActive * const me, uint_fast8_t prio,
 {
     pthread_t thread;
     pthread_attr_t attr;
-    struct sched_param param;
+    QF_CRIT_STAT_
 
     /* p-threads allocate stack internally */
     Q_REQUIRE_ID(600, stkSto == (void *)0);
@@ -148,46 +400,274 @@ void QActive_start_(QActive * const me, uint_fast8_t prio,
     me->prio = (uint8_t)prio;
     QF_add_(me); /* make QF aware of this active object */
 
-    QHSM_INIT(&me->super, ie); /* take the top-most initial tran. */
+    /* initialize the AO here, unless its thread does it in parallel */
+    if (!QF_startBegin_(me, ie, l_pollFd < 0)) {
+        ao_init(me, ie);
+        QF_startEnd_(prio);
+    }
     QS_FLUSH(); /* flush the QS trace buffer to the host */
 
-    pthread_attr_init(&attr);
+    if (l_pollFd >= 0) { /* driven by an external event loop? */
+        QF_CRIT_ENTRY_();
+        me->thread = QF_POLLED_THREAD_; /* no p-thread, see NOTE06 */
+        if (me->eQueue.frontEvt != (QEvt const *)0) { /* self-posted? */
+            QF_pollSignal_(prio);
+        }
+        QF_CRIT_EXIT_();
+    }
+    else {
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 
-    /* SCHED_FIFO corresponds to real-time preemptive priority-based scheduler
-    * NOTE: This scheduling policy requires the superuser privileges
-    */
-    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        if (stkSize == 0U) {
+            /* the stack of the real-time profile or the allowed minimum */
+            stkSize = (uint_fast16_t)((l_rt.stkSize != (size_t)0)
+                                      ? l_rt.stkSize
+                                      : (size_t)PTHREAD_STACK_MIN);
+        }
+        pthread_attr_setstacksize(&attr, (size_t)stkSize);
+#ifdef QF_NUMA_MAX_NODE
+        /* NUMA placement of the AO, see NOTE5 in qf_port.h */
+        QF_numaPlace_(me, qSto, qLen, &attr, (size_t)stkSize);
+#endif
+#ifdef QF_STACK_WATCH
+        /* the painted stack with the guard pages, see NOTE10 in qf_port.h */
+        QF_stackAlloc_(prio, &attr, (size_t)stkSize);
+#endif
 
-    /* see NOTE04 */
-    param.sched_priority = prio
-                           + (sched_get_priority_max(SCHED_FIFO)
-                              - QF_MAX_ACTIVE - 3);
+        /* SCHED_FIFO corresponds to real-time preemptive priority-based
+        * scheduler, see NOTE04.
+        * NOTE: This scheduling policy requires the superuser privileges
+        */
+        QF_createThread_(&thread, &attr, QF_aoPrio_(prio),
+                         &thread_routine, me);
+        pthread_attr_destroy(&attr);
+        me->thread = (uint8_t)1;
+    }
+}
+/*..........................................................................*/
+static void ao_init(QActive * const me, QEvt const * const ie) {
+#ifdef QF_PERSIST
+    if (!QF_persistStart_(me, (uint_fast16_t)me->eQueue.end)) { /* NOTE9 */
+        QHSM_INIT(&me->super, ie); /* take the top-most initial tran. */
+    }
+    QF_persistStarted_(me);
+#else
+    QHSM_INIT(&me->super, ie); /* take the top-most initial tran. */
+#endif
+}
+/*..........................................................................*/
+void QActive_stop(QActive * const me) {
+    me->thread = (uint8_t)0; /* stop the QActive thread loop */
+}
 
-    pthread_attr_setschedparam(&attr, &param);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+/*..........................................................................*/
+void QF_setRtProfile(QFRtProfile const * const profile) {
+    l_rt = *profile;
+    l_rtFailures = (uint8_t)0;
+}
+/*..........................................................................*/
+uint_fast8_t QF_getRtFailures(void) {
+    return (uint_fast8_t)__atomic_load_n(&l_rtFailures, __ATOMIC_RELAXED);
+}
+/*..........................................................................*/
+int QF_isrPrio_(uint_fast8_t const level) {
+    return ((l_rt.isrPrio != 0)
+            ? l_rt.isrPrio
+            : sched_get_priority_max(SCHED_FIFO)) - (int)level;
+}
+/*..........................................................................*/
+int QF_aoPrio_(uint_fast8_t const prio) { /* see NOTE04 */
+    return (l_rt.aoPrio != (int (*)(uint_fast8_t const))0)
+           ? (*l_rt.aoPrio)(prio)
+           : ((int)prio + (sched_get_priority_max(SCHED_FIFO)
+                           - QF_MAX_ACTIVE - 3));
+}
+/*..........................................................................*/
+void QF_threadAttrInit_(pthread_attr_t * const attr) {
+    pthread_attr_init(attr);
+    if (l_rt.stkSize != (size_t)0) { /* the stack of the RT profile? */
+        pthread_attr_setstacksize(attr, l_rt.stkSize);
+    }
+}
+/*..........................................................................*/
+void QF_createThread_(pthread_t * const thread,
+                      pthread_attr_t * const attr, int const prio,
+                      void *(*routine)(void *), void * const arg)
+{
+    struct sched_param param;
+    int err;
 
-    if (stkSize == 0U) {
-        /* set the allowed minimum */
-        stkSize = (uint_fast16_t)PTHREAD_STACK_MIN;
+    if ((l_rt.flags & QF_RT_FIFO) != 0U) {
+        /* the p-threads inherit the policy of the creator by default */
+        pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
     }
-    pthread_attr_setstacksize(&attr, (size_t)stkSize);
+    pthread_attr_setschedpolicy(attr, SCHED_FIFO);
+    param.sched_priority = prio;
+    pthread_attr_setschedparam(attr, &param);
 
-    if (pthread_create(&thread, &attr, &thread_routine, me) != 0) {
-        /* Creating the p-thread with the SCHED_FIFO policy failed. Most
-        * probably this application has no superuser privileges, so we just
-        * fall back to the default SCHED_OTHER policy and priority 0.
+    err = pthread_create(thread, attr, routine, arg);
+    if (err != 0) {
+        /* Creating the p-thread with the SCHED_FIFO policy failed.
+        * Most probably this application has no superuser privileges,
+        * so we fall back to the default SCHED_OTHER policy and priority 0
+        * (and report it, if SCHED_FIFO was requested by the RT profile).
         */
-        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+        if ((l_rt.flags & QF_RT_FIFO) != 0U) {
+            rt_failed(QF_RT_FIFO, err);
+        }
+        pthread_attr_setinheritsched(attr, PTHREAD_INHERIT_SCHED);
+        pthread_attr_setschedpolicy(attr, SCHED_OTHER);
         param.sched_priority = 0;
-        pthread_attr_setschedparam(&attr, &param);
-        Q_ALLEGE(pthread_create(&thread, &attr, &thread_routine, me)== 0);
+        pthread_attr_setschedparam(attr, &param);
+        Q_ALLEGE_ID(920, pthread_create(thread, attr, routine, arg) == 0);
     }
-    pthread_attr_destroy(&attr);
-    me->thread = (uint8_t)1;
 }
 /*..........................................................................*/
-void QActive_stop(QActive * const me) {
-    me->thread = (uint8_t)0; /* stop the QActive thread loop */
+static void rt_failed(uint8_t const feature, int const err) {
+    (void)__atomic_fetch_or(&l_rtFailures, feature, __ATOMIC_RELAXED);
+
+    QS_BEGIN(QS_PORT_RT_FAIL, (void *)0)
+        QS_U8(0, feature); /* the QF_RT_... feature not in effect */
+        QS_I32(0, err);    /* the error number */
+    QS_END()
+    (void)err; /* avoid the compiler warning when QS is not used */
+
+    /** @post the features of the strict RT profile must be in effect */
+    Q_ENSURE_ID(910, (l_rt.flags & QF_RT_STRICT) == 0U);
+}
+/*..........................................................................*/
+static void rt_prefaultHeap(size_t const size) {
+    static bool isDone;
+    if ((!isDone) && (size != (size_t)0)) {
+        uint8_t *mem;
+        isDone = true;
+        (void)mallopt(M_TRIM_THRESHOLD, -1); /* never return the heap */
+        (void)mallopt(M_MMAP_MAX, 0);        /* no malloc() from mmap() */
+        mem = (uint8_t *)malloc(size);
+        if (mem != (uint8_t *)0) {
+            size_t i;
+            for (i = (size_t)0; i < size; i += (size_t)sysconf(_SC_PAGESIZE)) {
+                ((uint8_t volatile *)mem)[i] = (uint8_t)0;
+            }
+            free(mem); /* stays in the heap of the process, see above */
+        }
+    }
+}
+/*..........................................................................*/
+static __attribute__((noinline)) void rt_touch(size_t const size) {
+    uint8_t buf[size]; /* occupies the stack below the caller */
+    uint8_t volatile * const p = &buf[0]; /* the stores must not go away */
+    size_t i;
+    for (i = (size_t)0; i < size; i += (size_t)sysconf(_SC_PAGESIZE)) {
+        p[i] = (uint8_t)0;
+    }
+}
+/*..........................................................................*/
+static void rt_prefaultStack(size_t const size) {
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void *addr;
+        size_t stkSize;
+        if (pthread_attr_getstack(&attr, &addr, &stkSize) == 0) {
+            uint8_t here; /* the current top of the stack (grows down) */
+            size_t avail = (size_t)(&here - (uint8_t *)addr);
+            size_t reserve = 4U * (size_t)sysconf(_SC_PAGESIZE);
+            if (avail > reserve) { /* leave room for rt_touch() itself */
+                rt_touch((size < (avail - reserve))
+                         ? size : (avail - reserve));
+            }
+        }
+        pthread_attr_destroy(&attr);
+    }
+}
+
+/*..........................................................................*/
+int QF_pollInit(void) {
+    if (l_pollFd < 0) {
+        l_pollFd = eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+        Q_ASSERT_ID(710, l_pollFd >= 0);
+    }
+    return l_pollFd;
+}
+/*..........................................................................*/
+void QF_pollSignal_(uint_fast8_t const prio) { /* called in crit. section */
+    if (QPSet_isEmpty(&l_pollSet)) { /* first polled AO becoming ready? */
+        uint64_t one = 1U;
+        (void)write(l_pollFd, &one, sizeof(one)); /* make the fd readable */
+    }
+    QPSet_insert(&l_pollSet, prio);
+}
+/*..........................................................................*/
+bool QF_runOnce(void) {
+    QActive *a;
+    QEvt const *e;
+    uint_fast8_t p;
+    bool ran;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    ran = QPSet_notEmpty(&l_pollSet); /* any polled AO ready to run? */
+    if (ran) {
+        bool stopped;
+
+        QPSet_findMax(&l_pollSet, p);
+        a = QF_active_[p];
+        QF_CRIT_EXIT_();
+
+        /* perform the run-to-completion (RTC) step, like the QV kernel */
+        e = QActive_get_(a);
+        if (e->sig != QF_CHANNEL_SIG_) {
+            QF_DISPATCH_HOOK_(e); /* e.g., measure the time-event delay */
+            QF_PERSIST_PRE_(a, e); /* journal the event */
+            QHSM_DISPATCH(&a->super, e);
+            QF_PERSIST_POST_(a); /* snapshot the AO, if due */
+            QF_gc(e);
+        }
+        else { /* doorbell of a channel, see NOTE1 in qf_channel.c */
+            QChannel_service_((QChannel *)e);
+        }
+
+        QF_CRIT_ENTRY_();
+        stopped = (a->thread == (uint8_t)0); /* QActive_stop() called? */
+        if (stopped || (a->eQueue.frontEvt == (QEvt const *)0)) {
+            QPSet_remove(&l_pollSet, p);
+        }
+        QF_CRIT_EXIT_();
+
+        if (stopped) {
+            QF_remove_(a); /* remove this object from the framework */
+            pthread_cond_destroy(&a->osObject);
+        }
+    }
+    else {
+        QF_CRIT_EXIT_();
+    }
+    return ran;
+}
+/*..........................................................................*/
+uint_fast16_t QF_poll(uint_fast16_t const budget) {
+    uint_fast16_t n;
+    uint64_t cnt;
+    QF_CRIT_STAT_
+
+    /* consume the readiness before dispatching, so that no post is lost */
+    (void)read(l_pollFd, &cnt, sizeof(cnt));
+
+    for (n = (uint_fast16_t)0; n < budget; ++n) {
+        if (!QF_runOnce()) {
+            break;
+        }
+    }
+
+    QF_CRIT_ENTRY_();
+    if (QPSet_notEmpty(&l_pollSet)) { /* budget exhausted? */
+        uint64_t one = 1U;
+        (void)write(l_pollFd, &one, sizeof(one)); /* come back for more */
+    }
+    QF_CRIT_EXIT_();
+
+    return n;
 }
 
 /*****************************************************************************
@@ -231,5 +711,21 @@ void QActive_stop(QActive * const me) {
 * In some (older) Linux kernels, the POSIX nanosleep() system call might
 * deliver only 2*actual-system-tick granularity. To compensate for this,
 * you would need to reduce (by 2) the constant NANOSLEEP_NSEC_PER_SEC.
+*
+* NOTE06:
+* Polled AOs (see NOTE2 in qf_port.h) are tracked in the ready-set
+* l_pollSet, exactly as in the QV kernel. The eventfd l_pollFd is written
+* only when the set goes from empty to non-empty, so a burst of posts costs
+* only a single write() system call. QF_poll() consumes the readiness before
+* dispatching and re-signals it if the budget ran out with events pending.
+*
+* NOTE07:
+* QF_setTickRateX() gives each tick rate its own periodic timerfd and
+* thread, so that a slow housekeeping rate costs nothing between its ticks
+* and a long QF_tickX_() walk of one rate does not delay the ticks of
+* another rate. The timerfd reports the number of expirations since the
+* last read(), so the ticks missed by a late thread are replayed (and
+* counted as overruns) instead of being lost. When all tick rates are
+* driven this way, QF_setTickRate(0) makes QF_run() sleep on a semaphore
+* until QF_stop() instead of calling QF_onClockTick() periodically.
 */
-
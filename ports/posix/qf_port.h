@@ -57,6 +57,40 @@
 #define QF_MPOOL_CTR_SIZE    4
 #define QF_TIMEEVT_CTR_SIZE  4
 
+/* uncomment to let the time events expire late by their timer slack
+* (QTimeEvt_setSlack()) for coalescing the expiries of several of them
+*/
+/* #define QF_TIMEEVT_SLACK     1 */
+
+/* uncomment to keep the armed time events in per-rate arrays (SoA layout)
+* instead of linked lists, which is more cache-friendly on 64-bit hosts
+*/
+/* #define QF_TIMEEVT_SOA       1 */
+
+/* inline definitions of the smallest hot functions, see NOTE11 */
+#ifdef QF_INLINE_HOT
+    #define QF_LOG2(n_) ((uint_fast8_t)(32U - __builtin_clz(n_)))
+#endif
+
+/* define QF_SMP_LAYOUT (e.g., in the DEFINES of the Makefile) to align
+* the AOs and event queues to the cache lines, see NOTE4
+*/
+#ifdef QF_SMP_LAYOUT
+    #define QF_CACHE_LINE    64
+    #define QF_CACHE_ALIGNED __attribute__((aligned(QF_CACHE_LINE)))
+#endif
+
+/* define QF_MAX_DOMAIN (e.g., in the DEFINES of the Makefile) to run
+* several independent QF domains in one process, see NOTE3
+*/
+#ifdef QF_MAX_DOMAIN
+    #if defined(Q_SPY) && (QF_MAX_DOMAIN > 1)
+        #error "QS software tracing supports only a single QF domain"
+    #endif
+    #define QF_DOMAIN_ID_()      ((uint_fast8_t)QF_domainId_)
+    #define QF_pThreadMutex_     (QF_domainMutex_[QF_domainId_])
+#endif
+
 /* QF interrupt disable/enable, see NOTE1 */
 #define QF_INT_DISABLE()     pthread_mutex_lock(&QF_pThreadMutex_)
 #define QF_INT_ENABLE()      pthread_mutex_unlock(&QF_pThreadMutex_)
@@ -73,9 +107,44 @@
 #include "qf.h"        /* QF platform-independent public interface */
 
 void QF_setTickRate(uint32_t ticksPerSec); /* set clock tick rate */
+
+/* independent tick sources per tick rate, see NOTE07 in qf_port.c */
+void QF_setTickRateX(uint_fast8_t const tickRate,
+                     uint32_t const ticksPerSec);
+uint32_t QF_getTickOverruns(uint_fast8_t const tickRate);
 void QF_onClockTick(void); /* clock tick callback (provided in the app) */
 
+/* integration with external event loops, see NOTE2 */
+int QF_pollInit(void); /* AOs started from now on are polled, returns fd */
+bool QF_runOnce(void); /* dispatch one event to the highest-prio polled AO */
+uint_fast16_t QF_poll(uint_fast16_t const budget); /* up to budget events */
+
+/* real-time Linux profile, see NOTE6 */
+typedef struct {
+    uint8_t flags;    /*!< the QF_RT_... features to apply */
+    int isrPrio;      /*!< SCHED_FIFO prio of top ISR-like thread (0: max) */
+    int (*aoPrio)(uint_fast8_t const prio); /*!< SCHED_FIFO prio of an AO */
+    size_t stkSize;   /*!< default stack of the port threads (0: p-threads) */
+    size_t heapSize;  /*!< bytes of heap to prefault with QF_RT_PREFAULT */
+} QFRtProfile;
+
+enum QFRtFeatures {
+    QF_RT_MLOCK    = 0x01U, /*!< lock all memory with mlockall() */
+    QF_RT_PREFAULT = 0x02U, /*!< prefault the heap and the thread stacks */
+    QF_RT_PI_MUTEX = 0x04U, /*!< priority-inheritance critical section */
+    QF_RT_FIFO     = 0x08U, /*!< SCHED_FIFO for all the port threads */
+    QF_RT_STRICT   = 0x80U  /*!< assert instead of degrading silently */
+};
+
+void QF_setRtProfile(QFRtProfile const * const profile); /* before QF_init */
+uint_fast8_t QF_getRtFailures(void); /* QF_RT_... features not in effect */
+
+#ifndef QF_MAX_DOMAIN
 extern pthread_mutex_t QF_pThreadMutex_; /* mutex for QF critical section */
+#else
+extern __thread uint8_t QF_domainId_;  /* QF domain of the calling thread */
+extern pthread_mutex_t QF_domainMutex_[QF_MAX_DOMAIN]; /* one per domain */
+#endif
 
 /****************************************************************************/
 /* interface used only inside QF implementation, but not in applications */
@@ -92,15 +161,80 @@ extern pthread_mutex_t QF_pThreadMutex_; /* mutex for QF critical section */
             pthread_cond_wait(&(me_)->osObject, &QF_pThreadMutex_)
     #define QACTIVE_EQUEUE_SIGNAL_(me_) \
         Q_ASSERT_ID(410, QF_active_[(me_)->prio] != (QActive *)0); \
-        pthread_cond_signal(&(me_)->osObject)
+        (((me_)->thread == QF_POLLED_THREAD_) \
+            ? QF_pollSignal_((me_)->prio) \
+            : (((me_)->thread >= QF_XTHREAD_THREAD_) \
+                ? QXThread_queueSignal_(me_) \
+                : (void)pthread_cond_signal(&(me_)->osObject)))
+
+    /* SCHED_FIFO priority of the ISR-like thread @p level (0 the top) */
+    int QF_isrPrio_(uint_fast8_t const level);
+
+    /* SCHED_FIFO priority of the thread of the AO at @p prio */
+    int QF_aoPrio_(uint_fast8_t const prio);
+
+    /* init the attributes of a port thread (the stack of the profile) */
+    void QF_threadAttrInit_(pthread_attr_t * const attr);
+
+    /* create a port thread at the SCHED_FIFO priority @p prio, see NOTE6 */
+    void QF_createThread_(pthread_t * const thread,
+                          pthread_attr_t * const attr, int const prio,
+                          void *(*routine)(void *), void * const arg);
+
+    /* tick jitter measurement, see NOTE7 */
+    #ifdef QF_TICK_JITTER
+        #include "qf_jitter.h"
+        #define QF_TICK_HOOK_(tickRate_)  QF_jitterTick_(tickRate_)
+        #define QF_TIMEEVT_POST_HOOK_(t_) QF_jitterPost_(t_)
+        #define QF_DISPATCH_HOOK_(e_)     QF_jitterDispatch_(e_)
+    #else
+        #define QF_DISPATCH_HOOK_(e_)     ((void)0)
+    #endif
+
+    /* warm restart from snapshots and journals, see NOTE9 */
+    #ifdef QF_PERSIST
+        #include "qf_persist.h"
+        #define QF_POST_FILTER_(me_, e_)  (!QF_persistReplaying_)
+        #define QF_PERSIST_PRE_(act_, e_) QF_persistPre_((act_), (e_))
+        #define QF_PERSIST_POST_(act_)    QF_persistPost_(act_)
+    #else
+        #define QF_PERSIST_PRE_(act_, e_) ((void)0)
+        #define QF_PERSIST_POST_(act_)    ((void)0)
+    #endif
+
+    /* painted AO stacks with guard pages, see NOTE10 */
+    #ifdef QF_STACK_WATCH
+        #include "qf_stack.h"
+    #endif
+
+    /* the thread attribute of AOs driven by QF_poll(), see NOTE2 */
+    #define QF_POLLED_THREAD_     ((uint8_t)2)
+    void QF_pollSignal_(uint_fast8_t const prio);
+
+    /* the thread attribute of the extended threads (the first one in the
+    * carrier 0, followed by the other carriers), see NOTE8
+    */
+    #define QF_XTHREAD_THREAD_    ((uint8_t)3)
+    #include "qf_xthr.h"
 
     /* native QF event pool operations */
+#ifndef QF_NUMA_MAX_NODE
     #define QF_EPOOL_TYPE_  QMPool
     #define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
         QMPool_init(&(p_), poolSto_, poolSize_, evtSize_)
     #define QF_EPOOL_EVENT_SIZE_(p_)  ((p_).blockSize)
     #define QF_EPOOL_GET_(p_, e_, m_) ((e_) = (QEvt *)QMPool_get(&(p_), (m_)))
     #define QF_EPOOL_PUT_(p_, e_)     (QMPool_put(&(p_), e_))
+#else /* event pools split among NUMA nodes, see NOTE5 */
+    #include "qf_numa.h"
+    #define QF_EPOOL_TYPE_  QNumaPool
+    #define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
+        QNumaPool_init(&(p_), poolSto_, poolSize_, evtSize_)
+    #define QF_EPOOL_EVENT_SIZE_(p_)  ((p_).node[0].blockSize)
+    #define QF_EPOOL_GET_(p_, e_, m_) \
+        ((e_) = (QEvt *)QNumaPool_get(&(p_), (m_)))
+    #define QF_EPOOL_PUT_(p_, e_)     (QNumaPool_put(&(p_), e_))
+#endif
 
 #endif /* QP_IMPL */
 
@@ -132,6 +266,120 @@ extern pthread_mutex_t QF_pThreadMutex_; /* mutex for QF critical section */
 * also subject to priority inversions. However, the p-thread mutex
 * implementation, such as POSIX threads, should support the priority-
 * inheritance protocol.
+*
+* NOTE2:
+* Applications that already run their own event loop (libuv, epoll, etc.)
+* can drive QP from that loop instead of dedicating a p-thread to every AO.
+* After QF_pollInit() is called, QActive_start_() no longer creates threads
+* and AOs instead become "polled", much like in the QV kernel. The eventfd
+* returned from QF_pollInit() becomes readable whenever any polled AO has
+* events, at which point the host loop calls QF_poll() to dispatch up to
+* the given budget of events (highest-priority AO first) in its own thread.
+* QF_run() is not used in this mode, so the host loop must also call
+* QF_onStartup() and invoke QF_TICK_X() from its own timer (e.g., timerfd).
+* AOs started before QF_pollInit() keep running in their own threads.
+*
+* NOTE3:
+* With QF_MAX_DOMAIN defined, every QF object that is global in the
+* single-domain build (the active object table, event pools, time event
+* lists, subscriber lists and the critical-section mutex) gets one copy per
+* domain, selected by the thread-local QF_domainId_ of the calling thread.
+* The threads created by the port (AO threads, tick sources) inherit the
+* domain of their creator, and the threads created by the application are
+* in domain 0 until they call QF_domainEnter(). The domains thus share
+* nothing but the code, and each one is initialized and run by its own
+* QF_init()/QF_run() sequence (see QF_domainSpawn()). Events can travel
+* between the domains only through QF_domainPost(). The other services of
+* this port (fd watchers, high-resolution timers, etc.) serve domain 0.
+*
+* NOTE4:
+* With QF_SMP_LAYOUT defined (in the port and in the application), every
+* active object is aligned to the cache line, its event queue starts on
+* a line of its own (away from the state machine written by the AO thread)
+* and the queue index used only by the consumer sits on yet another line.
+* Posting from another core then touches only the lines of the queue,
+* instead of bouncing the line with the state of the receiving AO (or of
+* a neighboring AO). The storage of the queue rings can be aligned the
+* same way, for example:
+* static QEvt const *l_queueSto[N] QF_CACHE_ALIGNED;
+* The layout makes QActive and QEQueue larger and changes their alignment
+* (the AOs allocated dynamically must be aligned by the application), so
+* it is not the default. Use the pingpong example to compare the layouts.
+*
+* NOTE5:
+* With QF_NUMA_MAX_NODE defined (e.g., -DQF_NUMA_MAX_NODE=4), every event
+* pool is split into one part per NUMA node, each part bound to the memory
+* of its node, and QF_newX_() allocates events from the part local to the
+* CPU of the calling thread (falling back to the other parts only when the
+* local part is exhausted). The AOs placed with QF_numaSetCpu() run on the
+* given CPU with their stacks and queues on the node of that CPU. The
+* application code is otherwise unchanged. See qf_numa.c.
+*
+* NOTE6:
+* The real-time profile set by QF_setRtProfile() before QF_init() makes
+* the port set up the process the way real-time Linux applications do:
+* QF_RT_MLOCK locks all the present and future memory, QF_RT_PREFAULT
+* touches the given amount of heap (which is then never returned to the
+* OS) and the stacks of the AO and tick threads before they start their
+* loops, QF_RT_PI_MUTEX gives the critical-section mutex the priority-
+* inheritance protocol, and QF_RT_FIFO creates all the port threads with
+* the explicit SCHED_FIFO policy (by default the p-threads inherit the
+* policy of their creator). The priorities of the AOs come from the
+* aoPrio() callback (or from the mapping in NOTE04 in qf_port.c) and the
+* ISR-like threads (tick sources, fd watcher, etc.) get isrPrio and the
+* two priorities below it. Every feature that could not be applied, for
+* example for lack of the RT privileges, is recorded in the bitmask from
+* QF_getRtFailures() and in the QS_PORT_RT_FAIL trace record, and with
+* QF_RT_STRICT it asserts instead. See the rtlat example for validation.
+*
+* NOTE7:
+* With QF_TICK_JITTER defined (in the port and in the application), the
+* port measures how late the time events expire: the lateness of every
+* QF_tickX_() against the ideal time of the tick and the delay from
+* posting every expired time event to its dispatching in the target AO,
+* in per-rate histograms available from QF_getTickJitter() and in the
+* QS_PORT_TICK_JITTER summary records. See qf_jitter.c and the rtlat
+* example, which runs the stress scenario for the jitter reports.
+*
+* NOTE8:
+* The extended (blocking) threads of qf_xthr.h have the API of the QXK
+* kernel (QXThread_delay(), QXThread_queueGet(), QXSemaphore_wait() and
+* QXMutex_lock()), but instead of a p-thread each, they run on their own
+* stacks in a few "carrier" p-threads, which switch among them in the
+* user space. An extended thread is registered in QF at its priority like
+* an AO, so AOs post and publish events to it as usual, and its carrier
+* is recorded in the thread attribute (QF_XTHREAD_THREAD_ + carrier).
+* See qf_xthr.c.
+*
+* NOTE9:
+* With QF_PERSIST defined (in the port and in the application), the AOs
+* made persistent with QActive_persist() survive the restart of the
+* process: their threads snapshot the current state, the extended state,
+* the time events and the queue into a memory-mapped file periodically,
+* and journal every event dispatched in between. QActive_start_() of such
+* AO restores it from the file (replaying the journal) instead of taking
+* the top-most initial transition, if the file holds a valid snapshot.
+* See qf_persist.c.
+*
+* NOTE10:
+* With QF_STACK_WATCH defined (in the port and in the application), the
+* port allocates the stack of every AO thread itself, painted with a
+* pattern and with inaccessible guard pages below it (QF_STACK_GUARD_PAGES).
+* QF_getStackUsage() measures the high-water mark of a stack and
+* QF_stackCheck() measures all of them, produces the QS_PORT_STACK record
+* for every grown mark and warns about the stacks used above the threshold
+* set by QF_setStackWarning(). The measured marks are meant for shrinking
+* the stkSize of the AOs in the regular build. See qf_stack.c.
+*
+* NOTE11:
+* With QF_INLINE_HOT defined (in the port and in the application), the
+* smallest functions on the hot paths get inline definitions in the port:
+* QF_LOG2(), which QPSet_findMax() calls for every event in QF_runOnce()
+* and in QF_publish_(), becomes the GCC builtin count-leading-zeros (a
+* single instruction on most hosts) instead of the byte-lookup function.
+* Together with the amalgamated build of the port library (make AMALGAM=1,
+* see NOTE1 in the Makefile), this lets the compiler inline the hot calls
+* across the QP modules without the link-time optimization.
 */
 
 #endif /* qf_port_h */
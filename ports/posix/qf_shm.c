@@ -0,0 +1,512 @@
+/**
+* @file
+* @brief Shared-memory event bus between QP processes (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_shm.h"       /* shared-memory event bus interface */
+
+#include <fcntl.h>        /* for O_* constants */
+#include <string.h>       /* for memcpy() */
+#include <sys/mman.h>     /* for shm_open() and mmap() */
+#include <sys/stat.h>     /* for fstat() */
+#include <sys/syscall.h>  /* for SYS_futex */
+#include <linux/futex.h>  /* for FUTEX_WAIT and FUTEX_WAKE */
+#include <time.h>         /* for struct timespec */
+#include <unistd.h>       /* for ftruncate(), syscall() and usleep() */
+
+Q_DEFINE_THIS_MODULE("qf_shm")
+
+#if ((QF_SHM_RING_LEN & (QF_SHM_RING_LEN - 1U)) != 0U)
+    #error "QF_SHM_RING_LEN must be a power of 2"
+#endif
+
+/* Local types -------------------------------------------------------------*/
+enum {
+    SHM_MAGIC   = 0x42485351U, /* "QSHB" */
+    SHM_HDR_LEN = 8U,          /* the slot header (before the event) */
+    SHM_MARGIN  = 2U           /* pool blocks left to this process, NOTE4 */
+};
+
+typedef struct {          /* ring slot (event copied behind the header) */
+    uint32_t seq;         /* sequence number, see NOTE1 */
+    uint16_t len;         /* the size of the event [bytes] */
+    uint8_t  dstPrio;     /* the recipient AO (0 for publishing) */
+    uint8_t  reserved;
+    uint8_t  evt[QF_SHM_SLOT_SIZE - SHM_HDR_LEN]; /* the event itself */
+} ShmSlot;
+
+typedef struct {          /* MPSC inbox ring of a single node */
+    uint32_t head __attribute__((aligned(64))); /* producers, NOTE2 */
+    uint32_t tail __attribute__((aligned(64))); /* consumer only */
+    uint32_t futex __attribute__((aligned(64))); /* wakeup word */
+    uint32_t waiting;     /* the consumer sleeps (or is about to) */
+    ShmSlot slot[QF_SHM_RING_LEN] __attribute__((aligned(64)));
+} ShmRing;
+
+typedef struct {          /* the shared memory region of the bus */
+    uint32_t magic;       /* written last by the creator of the region */
+    uint32_t slotSize;    /* configuration checked by the other nodes... */
+    uint32_t ringLen;
+    uint32_t maxNodes;
+    ShmRing ring[QF_SHM_MAX_NODES] __attribute__((aligned(64)));
+} ShmRegion;
+
+/* Local functions ---------------------------------------------------------*/
+static bool shm_put(ShmRing * const ring, QEvt const * const e,
+                    uint_fast16_t const len, uint_fast8_t const dstPrio,
+                    uint_fast16_t const margin);
+static void *shm_receiver(void *arg);
+static void shm_deliver(QShmBus * const me, ShmSlot const * const s);
+static long shm_futex(uint32_t *addr, int op, uint32_t val,
+                      struct timespec const *timeout);
+
+static void QShmProxy_init_(QHsm * const me, QEvt const * const e);
+static void QShmProxy_dispatch_(QHsm * const me, QEvt const * const e);
+#ifdef Q_SPY
+    static bool QShmProxy_post_(QActive * const me, QEvt const * const e,
+                      uint_fast16_t const margin, void const * const sender);
+#else
+    static bool QShmProxy_post_(QActive * const me, QEvt const * const e,
+                      uint_fast16_t const margin);
+#endif
+static void QShmProxy_postLIFO_(QActive * const me, QEvt const * const e);
+
+/*..........................................................................*/
+/**
+* @description
+* The first process to open the bus creates and initializes the shared
+* memory object. The other processes wait (up to about a second) until the
+* creator has finished the initialization and then verify that the bus
+* has been configured in the same way as in this process.
+*
+* @returns 'true' if the bus could be attached and 'false' otherwise.
+*/
+bool QShmBus_open(QShmBus * const me, char const * const name,
+                  uint_fast8_t const node)
+{
+    ShmRegion *reg = (ShmRegion *)0;
+    struct stat st;
+    bool creator = true;
+    uint_fast16_t tries;
+
+    /** @pre the node must be in range */
+    Q_REQUIRE_ID(100, node < (uint_fast8_t)QF_SHM_MAX_NODES);
+
+    QF_bzero(me, (uint_fast16_t)sizeof(*me));
+    me->node = (uint8_t)node;
+
+    me->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (me->fd < 0) { /* the bus exists already? */
+        creator = false;
+        me->fd = shm_open(name, O_RDWR, 0660);
+    }
+    if (me->fd < 0) {
+        return false;
+    }
+
+    if (creator) {
+        if (ftruncate(me->fd, (off_t)sizeof(ShmRegion)) != 0) {
+            (void)close(me->fd);
+            return false;
+        }
+    }
+    else { /* wait for the creator to size the region */
+        for (tries = 0U; tries < 1000U; ++tries) {
+            if ((fstat(me->fd, &st) == 0)
+                && (st.st_size == (off_t)sizeof(ShmRegion)))
+            {
+                break;
+            }
+            usleep(1000U);
+        }
+    }
+
+    reg = (ShmRegion *)mmap((void *)0, sizeof(ShmRegion),
+                            PROT_READ | PROT_WRITE, MAP_SHARED, me->fd, 0);
+    if (reg == (ShmRegion *)MAP_FAILED) {
+        (void)close(me->fd);
+        return false;
+    }
+    me->region = reg;
+
+    if (creator) {
+        uint_fast16_t n;
+        uint_fast16_t i;
+        for (n = 0U; n < (uint_fast16_t)QF_SHM_MAX_NODES; ++n) {
+            for (i = 0U; i < (uint_fast16_t)QF_SHM_RING_LEN; ++i) {
+                reg->ring[n].slot[i].seq = (uint32_t)i;
+            }
+        }
+        reg->slotSize = (uint32_t)QF_SHM_SLOT_SIZE;
+        reg->ringLen  = (uint32_t)QF_SHM_RING_LEN;
+        reg->maxNodes = (uint32_t)QF_SHM_MAX_NODES;
+        __atomic_store_n(&reg->magic, (uint32_t)SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+    else {
+        for (tries = 0U; tries < 1000U; ++tries) {
+            if (__atomic_load_n(&reg->magic, __ATOMIC_ACQUIRE)
+                == (uint32_t)SHM_MAGIC)
+            {
+                break;
+            }
+            usleep(1000U);
+        }
+        if ((reg->magic != (uint32_t)SHM_MAGIC)
+            || (reg->slotSize != (uint32_t)QF_SHM_SLOT_SIZE)
+            || (reg->ringLen  != (uint32_t)QF_SHM_RING_LEN)
+            || (reg->maxNodes != (uint32_t)QF_SHM_MAX_NODES))
+        {
+            QShmBus_close(me); /* not initialized or configured differently */
+            return false;
+        }
+    }
+    return true;
+}
+/*..........................................................................*/
+void QShmBus_start(QShmBus * const me) {
+    pthread_attr_t attr;
+
+    /** @pre the bus must be open */
+    Q_REQUIRE_ID(200, me->region != (void *)0);
+
+    me->isRunning = (uint8_t)1;
+    QF_threadAttrInit_(&attr);
+
+    /* the receiver is an "ISR-like" thread, see NOTE04 in qf_port.c */
+    QF_createThread_(&me->thread, &attr, QF_isrPrio_(2U), &shm_receiver, me);
+    pthread_attr_destroy(&attr);
+}
+/*..........................................................................*/
+void QShmBus_close(QShmBus * const me) {
+    if (me->region != (void *)0) {
+        if (me->isRunning != (uint8_t)0) {
+            ShmRing *ring = &((ShmRegion *)me->region)->ring[me->node];
+            me->isRunning = (uint8_t)0;
+            (void)__atomic_add_fetch(&ring->futex, 1U, __ATOMIC_RELEASE);
+            (void)shm_futex(&ring->futex, FUTEX_WAKE, 1U,
+                            (struct timespec const *)0);
+            (void)pthread_join(me->thread, (void **)0);
+        }
+        (void)munmap(me->region, sizeof(ShmRegion));
+        me->region = (void *)0;
+        (void)close(me->fd);
+    }
+}
+/*..........................................................................*/
+void QShmBus_unlink(char const * const name) {
+    (void)shm_unlink(name);
+}
+
+/*..........................................................................*/
+void QShmProxy_ctor(QShmProxy * const me, QShmBus * const bus,
+                    uint_fast8_t const remoteNode,
+                    uint_fast8_t const remotePrio)
+{
+    static QActiveVtbl const vtbl = {  /* QActiveVtbl virtual table */
+        { &QShmProxy_init_,
+          &QShmProxy_dispatch_ },
+        &QActive_start_,
+        &QShmProxy_post_,
+        &QShmProxy_postLIFO_
+    };
+
+    /** @pre the remote node and AO must be in range */
+    Q_REQUIRE_ID(300, (remoteNode < (uint_fast8_t)QF_SHM_MAX_NODES)
+                      && (remotePrio <= (uint_fast8_t)QF_MAX_ACTIVE));
+
+    QActive_ctor(&me->super, Q_STATE_CAST(0)); /* superclass' ctor */
+    me->super.super.vptr = &vtbl.super; /* hook the vptr */
+    me->bus        = bus;
+    me->remoteNode = (uint8_t)remoteNode;
+    me->remotePrio = (uint8_t)remotePrio;
+}
+/*..........................................................................*/
+void QShmProxy_start(QShmProxy * const me, uint_fast8_t const prio) {
+    me->super.prio = (uint8_t)prio;
+    QF_add_(&me->super); /* make QF aware of this proxy */
+}
+/*..........................................................................*/
+static void QShmProxy_init_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+}
+/*..........................................................................*/
+static void QShmProxy_dispatch_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(400); /* events are never dispatched to a proxy */
+}
+/*..........................................................................*/
+#ifndef Q_SPY
+static bool QShmProxy_post_(QActive * const me, QEvt const * const e,
+                            uint_fast16_t const margin)
+#else
+static bool QShmProxy_post_(QActive * const me, QEvt const * const e,
+                            uint_fast16_t const margin,
+                            void const * const sender)
+#endif
+{
+    QShmProxy * const proxy = (QShmProxy *)me;
+    ShmRing *ring;
+    uint_fast16_t len;
+    bool status;
+    QF_CRIT_STAT_
+
+    /** @pre the bus must be open */
+    Q_REQUIRE_ID(500, proxy->bus->region != (void *)0);
+
+    ring = &((ShmRegion *)proxy->bus->region)->ring[proxy->remoteNode];
+    len  = (e->poolId_ != (uint8_t)0)
+           ? (uint_fast16_t)QF_EPOOL_EVENT_SIZE_(QF_pool_[e->poolId_ - 1U])
+           : (uint_fast16_t)sizeof(QEvt);
+
+    /** @pre the event must fit into a ring slot */
+    Q_REQUIRE_ID(510, len <= (uint_fast16_t)(QF_SHM_SLOT_SIZE - SHM_HDR_LEN));
+
+    status = shm_put(ring, e, len, (uint_fast8_t)proxy->remotePrio, margin);
+
+    /* assert if the event cannot be sent and dropping is not acceptable */
+    Q_ASSERT_ID(520, status || (margin != (uint_fast16_t)0));
+
+    QF_CRIT_ENTRY_();
+    QS_BEGIN_NOCRIT_((status ? QS_QF_ACTIVE_POST_FIFO
+                             : QS_QF_ACTIVE_POST_ATTEMPT),
+                     QS_priv_.aoObjFilter, me)
+        QS_TIME_();             /* timestamp */
+        QS_OBJ_(sender);        /* the sender object */
+        QS_SIG_(e->sig);        /* the signal of the event */
+        QS_OBJ_(me);            /* this proxy (recipient) */
+        QS_2U8_(e->poolId_, e->refCtr_); /* pool Id & ref Count */
+        QS_EQC_((QEQueueCtr)0); /* number of free entries (unknown) */
+        QS_EQC_((QEQueueCtr)margin); /* margin requested */
+    QS_END_NOCRIT_()
+
+    if (status) {
+        ++proxy->bus->nSent;
+    }
+
+    /* the event has been copied, so it is consumed right away, NOTE3 */
+    if (e->poolId_ != (uint8_t)0) {
+        QF_EVT_REF_CTR_INC_(e);
+    }
+    QF_CRIT_EXIT_();
+    QF_gc(e);
+
+    return status;
+}
+/*..........................................................................*/
+static void QShmProxy_postLIFO_(QActive * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(600); /* LIFO posting is meaningful only for self-posting */
+}
+
+/*..........................................................................*/
+static bool shm_put(ShmRing * const ring, QEvt const * const e,
+                    uint_fast16_t const len, uint_fast8_t const dstPrio,
+                    uint_fast16_t const margin)
+{
+    uint32_t pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    ShmSlot *s;
+
+    for (;;) { /* claim a slot, see NOTE1 */
+        uint32_t seq;
+        int32_t dif;
+
+        s = &ring->slot[pos & (uint32_t)(QF_SHM_RING_LEN - 1U)];
+        seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        dif = (int32_t)(seq - pos);
+
+        if (dif < 0) {
+            return false; /* the ring is full */
+        }
+        else if ((margin != (uint_fast16_t)0)
+                 && ((uint32_t)QF_SHM_RING_LEN - (pos
+                     - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED))
+                     <= (uint32_t)margin))
+        {
+            return false; /* not enough margin left */
+        }
+        else if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1U,
+                    false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break; /* slot claimed */
+            }
+            /* 'pos' has been updated by the failed CAS, try again */
+        }
+        else {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    s->len     = (uint16_t)len;
+    s->dstPrio = (uint8_t)dstPrio;
+    memcpy(&s->evt[0], e, len);
+    __atomic_store_n(&s->seq, pos + 1U, __ATOMIC_RELEASE); /* publish */
+
+    /* wake up the consumer only if it sleeps, see NOTE2 */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->waiting, __ATOMIC_RELAXED) != 0U) {
+        (void)__atomic_add_fetch(&ring->futex, 1U, __ATOMIC_RELEASE);
+        (void)shm_futex(&ring->futex, FUTEX_WAKE, 1U,
+                        (struct timespec const *)0);
+    }
+    return true;
+}
+/*..........................................................................*/
+static void *shm_receiver(void *arg) { /* the expected POSIX signature */
+    QShmBus * const me = (QShmBus *)arg;
+    ShmRing * const ring = &((ShmRegion *)me->region)->ring[me->node];
+
+    while (me->isRunning != (uint8_t)0) {
+        ShmSlot *s = &ring->slot[ring->tail
+                                 & (uint32_t)(QF_SHM_RING_LEN - 1U)];
+        if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)
+            == (ring->tail + 1U))
+        {
+            shm_deliver(me, s);
+
+            /* release the slot for the next lap of the producers */
+            __atomic_store_n(&s->seq, ring->tail + QF_SHM_RING_LEN,
+                             __ATOMIC_RELEASE);
+            __atomic_store_n(&ring->tail, ring->tail + 1U,
+                             __ATOMIC_RELAXED);
+        }
+        else { /* the inbox is empty, go to sleep, see NOTE2 */
+            uint32_t w = __atomic_load_n(&ring->futex, __ATOMIC_ACQUIRE);
+            __atomic_store_n(&ring->waiting, 1U, __ATOMIC_SEQ_CST);
+            if ((__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)
+                 != (ring->tail + 1U))
+                && (me->isRunning != (uint8_t)0))
+            {
+                (void)shm_futex(&ring->futex, FUTEX_WAIT, w,
+                                (struct timespec const *)0);
+            }
+            __atomic_store_n(&ring->waiting, 0U, __ATOMIC_RELAXED);
+        }
+    }
+    return (void *)0; /* return success */
+}
+/*..........................................................................*/
+static void shm_deliver(QShmBus * const me, ShmSlot const * const s) {
+    QEvt const *src = (QEvt const *)&s->evt[0];
+    uint_fast16_t const len = (uint_fast16_t)s->len; /* from the peer */
+    QEvt *e = (QEvt *)0;
+
+    /* a well-formed message for this process? see NOTE4 */
+    if ((len >= (uint_fast16_t)sizeof(QEvt))
+        && (len <= (uint_fast16_t)sizeof(s->evt))
+        && (QF_maxPool_ != (uint_fast8_t)0)
+        && (len <= QF_poolGetMaxBlockSize())
+        && ((s->dstPrio == (uint8_t)0)
+            ? ((enum_t)src->sig < QF_maxPubSignal_)
+            : ((s->dstPrio <= (uint8_t)QF_MAX_ACTIVE)
+               && (QF_active_[s->dstPrio] != (QActive *)0))))
+    {
+        e = QF_newX_(len, (uint_fast16_t)SHM_MARGIN, (enum_t)src->sig);
+    }
+
+    if (e != (QEvt *)0) {
+        /* copy the event parameters, but not the event header */
+        memcpy((uint8_t *)e + sizeof(QEvt), &s->evt[sizeof(QEvt)],
+               (size_t)len - sizeof(QEvt));
+        ++me->nRecv;
+
+        if (s->dstPrio == (uint8_t)0) {
+            QF_PUBLISH(e, me);
+        }
+        else {
+            /* QACTIVE_POST() asserts internally if the queue overflows */
+            QACTIVE_POST(QF_active_[s->dstPrio], e, me);
+        }
+    }
+    else { /* malformed or no memory for it, drop the message */
+        ++me->nDropped;
+    }
+}
+/*..........................................................................*/
+static long shm_futex(uint32_t *addr, int op, uint32_t val,
+                      struct timespec const *timeout)
+{
+    /* the futex is shared between processes, so no FUTEX_PRIVATE_FLAG */
+    return syscall(SYS_futex, addr, op, val, timeout, (uint32_t *)0, 0);
+}
+
+/*****************************************************************************
+* NOTE1:
+* The inbox ring is the bounded queue of D. Vyukov restricted to a single
+* consumer. Every slot carries a sequence number, which equals the ring
+* position for which the slot is free (to be claimed by a producer) and the
+* position plus one when the slot is full (ready for the consumer). The
+* producers claim slots with a single compare-and-swap on the head and
+* never block one another while copying their events in.
+*
+* NOTE2:
+* The head written by the producers and the tail written by the consumer
+* live in separate cache lines. The consumer announces that it is about to
+* sleep in the 'waiting' flag and re-checks the ring before calling
+* FUTEX_WAIT, while the producers check the flag only after publishing
+* their slot. With the full fences on both sides either the consumer sees
+* the new event or the producer sees the flag, so no wakeup can be lost,
+* and the producers pay for the FUTEX_WAKE system call only when the
+* consumer actually sleeps.
+*
+* NOTE3:
+* Posting an event increments its reference counter and the recipient
+* recycles it after processing. The proxy does both at once, so a fresh
+* dynamic event posted directly to the proxy is recycled here, while
+* a published event survives until QF_publish_() releases it.
+*
+* NOTE4:
+* The slots are written by the other processes, so the receiver trusts
+* nothing in them: a message of an impossible size, for an AO that is not
+* registered in this process or with a signal that cannot be published is
+* dropped. A message is also dropped when the event pools of this process
+* are (almost) empty, so that a burst from a peer can neither crash the
+* receiver nor take the last blocks from the local AOs. The dropped
+* messages are counted in nDropped of the ::QShmBus.
+*/
@@ -0,0 +1,122 @@
+/**
+* @file
+* @brief Shared-memory event bus between QP processes (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_shm_h
+#define qf_shm_h
+
+#ifndef QF_SHM_MAX_NODES
+    /*! The maximum number of processes (nodes) attached to a bus */
+    #define QF_SHM_MAX_NODES  8U
+#endif
+
+#ifndef QF_SHM_RING_LEN
+    /*! The number of slots in the inbox ring of each node (power of 2) */
+    #define QF_SHM_RING_LEN   256U
+#endif
+
+#ifndef QF_SHM_SLOT_SIZE
+    /*! The size of a ring slot, which limits the size of the events */
+    #define QF_SHM_SLOT_SIZE  256U
+#endif
+
+/*! Shared-memory event bus (one per process and bus) */
+/**
+* @description
+* The bus is a shared memory object, which contains one lock-free
+* multiple-producer, single-consumer (MPSC) inbox ring for each node
+* (process) attached to the bus. Events posted or published to the
+* ::QShmProxy objects of a process are copied straight into the inbox ring
+* of the peer process without any system call. The receiver thread of the
+* peer sleeps on a futex only when its inbox is empty, so a system call
+* is needed only to wake up an idle receiver. The receiver re-injects the
+* events into its own process with QACTIVE_POST() or QF_PUBLISH().
+*/
+typedef struct {
+    void *region;         /*!< the mapped shared memory region */
+    int fd;               /*!< the shared memory object */
+    uint8_t node;         /*!< the node of this process on the bus */
+    pthread_t thread;     /*!< the receiver thread */
+    uint8_t volatile isRunning; /*!< the receiver runs while set */
+    uint32_t volatile nRecv;    /*!< # events received from the bus */
+    uint32_t volatile nSent;    /*!< # events sent to the bus */
+    uint32_t volatile nDropped; /*!< # received messages dropped */
+} QShmBus;
+
+/*! Attach this process as node @p node to the bus called @p name */
+bool QShmBus_open(QShmBus * const me, char const * const name,
+                  uint_fast8_t const node);
+
+/*! Start the receiver thread delivering the events from the inbox */
+void QShmBus_start(QShmBus * const me);
+
+/*! Stop the receiver thread and detach from the bus */
+void QShmBus_close(QShmBus * const me);
+
+/*! Remove the named shared memory object of the bus from the system */
+void QShmBus_unlink(char const * const name);
+
+/*! Proxy of a remote active object */
+/**
+* @description
+* A proxy is registered with the local framework at a unique priority,
+* like an AO, but has no event queue or thread. Instead, events posted
+* to the proxy, or published and delivered to it by virtue of its
+* subscriptions, are sent to the AO with the priority @c remotePrio in
+* the process attached as the node @c remoteNode. A @c remotePrio of zero
+* re-publishes the events in the remote process instead.
+*
+* @note Dynamic events are sent with the block size of their event pool
+* and static events with just the ::QEvt header, because QF events carry
+* no size information.
+*/
+typedef struct {
+    QActive super;        /*!< inherits ::QActive */
+    QShmBus *bus;         /*!< the bus leading to the remote AO */
+    uint8_t remoteNode;   /*!< the node of the remote process */
+    uint8_t remotePrio;   /*!< the remote AO (0 to publish remotely) */
+} QShmProxy;
+
+/*! The "constructor" of a remote AO proxy */
+void QShmProxy_ctor(QShmProxy * const me, QShmBus * const bus,
+                    uint_fast8_t const remoteNode,
+                    uint_fast8_t const remotePrio);
+
+/*! Register the proxy with the framework at the priority @p prio */
+void QShmProxy_start(QShmProxy * const me, uint_fast8_t const prio);
+
+#endif /* qf_shm_h */
@@ -0,0 +1,204 @@
+/**
+* @file
+* @brief Async-signal-safe event posting (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#include "qf_sigpost.h"   /* async-signal-safe posting interface */
+
+#include <errno.h>        /* for errno and EINTR */
+#include <signal.h>       /* for sigfillset() and pthread_sigmask() */
+#include <sys/eventfd.h>  /* for eventfd() */
+#include <unistd.h>       /* for read() and write() */
+
+Q_DEFINE_THIS_MODULE("qf_sigpost")
+
+#if ((QF_SIGPOST_QLEN & (QF_SIGPOST_QLEN - 1U)) != 0U)
+    #error "QF_SIGPOST_QLEN must be a power of 2"
+#endif
+
+/* Local objects -----------------------------------------------------------*/
+typedef struct {          /* slot of the signal inbox, see NOTE1 */
+    uint32_t seq;         /* sequence number of the slot */
+    QActive *act;         /* the recipient (NULL for publishing) */
+    QEvt const *e;        /* the event */
+} SigSlot;
+
+static SigSlot l_inbox[QF_SIGPOST_QLEN];
+static uint32_t l_head;   /* claimed by the producers */
+static uint32_t l_tail;   /* used only by the delivery thread */
+static uint32_t l_lost;   /* # events rejected because of full inbox */
+static int l_sigFd = -1;  /* eventfd waking up the delivery thread */
+
+#ifdef Q_SPY
+static uint8_t const l_sigPoster = 0U; /* unique sender object for QS */
+#endif
+
+static void *sig_thread(void *arg);
+
+/*..........................................................................*/
+void QF_sigPostInit(void) {
+    pthread_t thread;
+    pthread_attr_t attr;
+    uint_fast16_t i;
+
+    /** @pre the service must not be initialized yet */
+    Q_REQUIRE_ID(100, l_sigFd < 0);
+
+    for (i = (uint_fast16_t)0; i < (uint_fast16_t)QF_SIGPOST_QLEN; ++i) {
+        l_inbox[i].seq = (uint32_t)i;
+    }
+    l_sigFd = eventfd(0U, EFD_CLOEXEC);
+    Q_ASSERT_ID(110, l_sigFd >= 0);
+
+    QF_threadAttrInit_(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    /* the delivery is an "ISR-like" thread, see NOTE04 in qf_port.c */
+    QF_createThread_(&thread, &attr, QF_isrPrio_(1U), &sig_thread, (void *)0);
+    pthread_attr_destroy(&attr);
+}
+/*..........................................................................*/
+bool QF_postFromSig(QActive * const act, QEvt const * const e) {
+    uint32_t pos = __atomic_load_n(&l_head, __ATOMIC_RELAXED);
+    uint64_t one = (uint64_t)1;
+    bool status = false;
+    bool done = (l_sigFd < 0); /* not initialized? */
+    int savedErrno;
+
+    while (!done) { /* claim a slot, see NOTE1 */
+        SigSlot * const s = &l_inbox[pos & (uint32_t)(QF_SIGPOST_QLEN - 1U)];
+        int32_t dif = (int32_t)(__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)
+                                - pos);
+        if (dif < 0) {
+            done = true; /* the inbox is full */
+        }
+        else if (dif == 0) {
+            if (__atomic_compare_exchange_n(&l_head, &pos, pos + 1U,
+                    false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                s->act = act;
+                s->e   = e;
+                __atomic_store_n(&s->seq, pos + 1U, __ATOMIC_RELEASE);
+                status = true;
+                done = true;
+            }
+            /* otherwise 'pos' has been updated by the failed CAS */
+        }
+        else {
+            pos = __atomic_load_n(&l_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    savedErrno = errno; /* a signal handler must preserve errno */
+    if (status) {
+        (void)write(l_sigFd, &one, sizeof(one)); /* async-signal-safe */
+    }
+    else {
+        (void)__atomic_add_fetch(&l_lost, 1U, __ATOMIC_RELAXED);
+    }
+    errno = savedErrno;
+
+    return status;
+}
+/*..........................................................................*/
+uint32_t QF_sigPostLost(void) {
+    return __atomic_load_n(&l_lost, __ATOMIC_RELAXED);
+}
+/*..........................................................................*/
+static void *sig_thread(void *arg) { /* the expected POSIX signature */
+    sigset_t set;
+    uint64_t cnt;
+
+    (void)arg;
+
+    /* the signals are handled by the other threads, see NOTE2 */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, (sigset_t *)0);
+
+    for (;;) {
+        SigSlot * const s = &l_inbox[l_tail
+                                     & (uint32_t)(QF_SIGPOST_QLEN - 1U)];
+        if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) == (l_tail + 1U)) {
+            QActive * const act = s->act;
+            QEvt const * const e = s->e;
+
+            /* release the slot before posting to free it up quickly */
+            __atomic_store_n(&s->seq, l_tail + QF_SIGPOST_QLEN,
+                             __ATOMIC_RELEASE);
+            ++l_tail;
+
+            if (act == (QActive *)0) {
+                QF_PUBLISH(e, &l_sigPoster);
+            }
+            else {
+                /* QACTIVE_POST() asserts internally if the queue overflows */
+                QACTIVE_POST(act, e, &l_sigPoster);
+            }
+        }
+        else if (read(l_sigFd, &cnt, sizeof(cnt)) < 0) {
+            Q_ASSERT_ID(510, errno == EINTR);
+        }
+        else {
+            /* woken up, check the inbox again */
+        }
+    }
+    return (void *)0; /* not reached */
+}
+
+/*****************************************************************************
+* NOTE1:
+* The inbox is a bounded lock-free queue with a sequence number per slot
+* (see also NOTE1 in qf_shm.c). A producer claims a slot with a single
+* compare-and-swap and never waits for anybody, so a signal handler that
+* interrupts a thread in the middle of posting (or in the middle of a QF
+* critical section) cannot deadlock. The eventfd counter is incremented
+* after every post and, because it is read only when the inbox appears
+* empty, a slot claimed by an interrupted producer delays only the events
+* behind it, until that producer completes its post and writes the eventfd.
+*
+* NOTE2:
+* A condition variable cannot be signaled from a signal handler, so the
+* events cannot be put straight into the AO queues (which block on their
+* condition variables). Instead, the single delivery thread of the port
+* sleeps in read() on the eventfd, which is written with the async-signal-
+* safe write(). The delivery thread blocks all signals, so the handlers
+* always run in the context of another thread.
+*/
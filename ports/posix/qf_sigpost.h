@@ -0,0 +1,81 @@
+/**
+* @file
+* @brief Async-signal-safe event posting (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_sigpost_h
+#define qf_sigpost_h
+
+#ifndef QF_SIGPOST_QLEN
+    /*! The length of the lock-free signal inbox (power of 2) */
+    #define QF_SIGPOST_QLEN  64U
+#endif
+
+/*! Start the service posting the events from signal handlers */
+/**
+* @description
+* Must be called after QF_init() and before installing any signal handler
+* (or starting any foreign thread) that uses QF_postFromSig().
+*/
+void QF_sigPostInit(void);
+
+/*! Post (or publish) an event from a signal handler or a foreign thread */
+/**
+* @description
+* This function is async-signal-safe and lock-free. It never takes the
+* QF critical section, so it can be called from signal handlers (SIGIO,
+* SIGALRM, timer_create() notifications, etc.) and from real-time threads
+* that must not block on the QF mutex. The event is handed over through
+* a lock-free inbox to the ISR-like delivery thread of the port, which
+* posts it with QACTIVE_POST() to @p act or publishes it with QF_PUBLISH()
+* if @p act is NULL, with the same overflow assertions as any other post.
+*
+* @note The event must be a static (immutable) event or a dynamic event
+* allocated beforehand outside the signal handler, because the event
+* pools cannot be used from a signal handler.
+*
+* @returns 'true' if the event has been accepted and 'false' if the inbox
+* was full, in which case the event is not delivered.
+*/
+bool QF_postFromSig(QActive * const act, QEvt const * const e);
+
+/*! Publish an event from a signal handler or a foreign thread */
+#define QF_PUBLISH_FROM_SIG(e_) (QF_postFromSig((QActive *)0, (e_)))
+
+/*! The number of events rejected because the signal inbox was full */
+uint32_t QF_sigPostLost(void);
+
+#endif /* qf_sigpost_h */
@@ -0,0 +1,231 @@
+/**
+* @file
+* @brief Stack painting and high-water measurement (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+
+#ifdef QF_STACK_WATCH     /* stack measurement configured? */
+
+#include "qf_stack.h"     /* stack measurement interface */
+
+#include <sys/mman.h>     /* for mmap(), mprotect() */
+#include <limits.h>       /* for PTHREAD_STACK_MIN */
+#include <string.h>       /* for memset() */
+#include <unistd.h>       /* for sysconf() */
+
+Q_DEFINE_THIS_MODULE("qf_stack")
+
+#define STACK_PAINT       ((uint8_t)0xA5U) /* the byte painted, see NOTE1 */
+
+typedef struct {          /* the painted stack of one AO */
+    uintptr_t const *lo;  /* the lowest word of the stack (above the guard) */
+    size_t size;          /* the usable size of the stack [bytes] */
+    size_t hiWater;       /* the high-water mark reported last [bytes] */
+    bool isWarned;        /* the warning issued already? */
+} QStack;
+
+static QStack l_stack[QF_MAX_ACTIVE + 1];
+static uint8_t l_warnPct = (uint8_t)QF_STACK_WARN_PCT;
+static QStackWarning l_onWarning;
+
+static size_t stack_measure(uintptr_t const * const lo, size_t const size);
+
+/*..........................................................................*/
+void QF_setStackWarning(uint_fast8_t const pct,
+                        QStackWarning const onWarning)
+{
+    QF_CRIT_STAT_
+
+    /** @pre the threshold must be a percentage */
+    Q_REQUIRE_ID(100, pct <= (uint_fast8_t)100);
+
+    QF_CRIT_ENTRY_();
+    l_warnPct   = (uint8_t)pct;
+    l_onWarning = onWarning;
+    QF_CRIT_EXIT_();
+}
+/*..........................................................................*/
+bool QF_getStackUsage(uint_fast8_t const prio, QStackUsage * const usage) {
+    QStack stk;
+    QF_CRIT_STAT_
+
+    /** @pre the priority must be in range */
+    Q_REQUIRE_ID(200, prio <= (uint_fast8_t)QF_MAX_ACTIVE);
+
+    QF_CRIT_ENTRY_();
+    stk = l_stack[prio];
+    QF_CRIT_EXIT_();
+
+    if (stk.lo != (uintptr_t const *)0) { /* painted by the port? */
+        usage->size = stk.size;
+        usage->used = stack_measure(stk.lo, stk.size); /* outside crit. */
+    }
+    return (stk.lo != (uintptr_t const *)0);
+}
+/*..........................................................................*/
+uint_fast8_t QF_stackCheck(void) {
+    uint_fast8_t nOver = (uint_fast8_t)0;
+    uint_fast8_t p;
+    QF_CRIT_STAT_
+
+    for (p = (uint_fast8_t)1; p <= (uint_fast8_t)QF_MAX_ACTIVE; ++p) {
+        QStackUsage usage;
+        QStackWarning onWarning;
+        uint_fast8_t pct;
+        bool isGrown;
+        bool isOver;
+        bool isWarning;
+
+        if (QF_getStackUsage(p, &usage)) { /* painted by the port? */
+            pct = (uint_fast8_t)((usage.used * 100U) / usage.size);
+
+            QF_CRIT_ENTRY_();
+            isGrown = (usage.used > l_stack[p].hiWater);
+            if (isGrown) {
+                l_stack[p].hiWater = usage.used;
+            }
+            isOver = (l_warnPct != (uint8_t)0)
+                     && (pct >= (uint_fast8_t)l_warnPct);
+            isWarning = isOver && (!l_stack[p].isWarned);
+            if (isWarning) {
+                l_stack[p].isWarned = true; /* warn only once per stack */
+            }
+            onWarning = l_onWarning;
+            QF_CRIT_EXIT_();
+
+            if (isGrown) {
+                QS_BEGIN(QS_PORT_STACK, QF_active_[p])
+                    QS_U8(0, p);                     /* the AO priority */
+                    QS_U32(0, (uint32_t)usage.size); /* the stack size */
+                    QS_U32(0, (uint32_t)usage.used); /* the high-water */
+                    QS_U8(0, pct);                   /* the usage [%] */
+                QS_END()
+            }
+            if (isOver) {
+                ++nOver;
+            }
+            if (isWarning && (onWarning != (QStackWarning)0)) {
+                (*onWarning)(p, &usage);
+            }
+        }
+    }
+    return nOver;
+}
+
+/*..........................................................................*/
+void QF_stackAlloc_(uint_fast8_t const prio,
+                    pthread_attr_t * const attr, size_t const stkSize)
+{
+    size_t const page  = (size_t)sysconf(_SC_PAGESIZE);
+    size_t const guard = (size_t)QF_STACK_GUARD_PAGES * page;
+    size_t size = (stkSize > (size_t)PTHREAD_STACK_MIN)
+                  ? stkSize : (size_t)PTHREAD_STACK_MIN;
+    uint8_t *mem;
+    QF_CRIT_STAT_
+
+    /** @pre the priority must be in range */
+    Q_REQUIRE_ID(300, prio <= (uint_fast8_t)QF_MAX_ACTIVE);
+
+    size = (size + page - 1U) & ~(page - 1U); /* whole pages */
+
+    /* the guard pages at the bottom, because the stack grows down;
+    * the stack is never freed, like the AO itself, see NOTE1
+    */
+    mem = (uint8_t *)mmap((void *)0, guard + size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    Q_ASSERT_ID(310, mem != (uint8_t *)MAP_FAILED);
+    if (guard != (size_t)0) {
+        Q_ALLEGE_ID(320, mprotect(mem, guard, PROT_NONE) == 0);
+    }
+    memset(&mem[guard], (int)STACK_PAINT, size); /* makes it resident too */
+    Q_ALLEGE_ID(330, pthread_attr_setstack(attr, &mem[guard], size) == 0);
+
+    QF_CRIT_ENTRY_();
+    l_stack[prio].lo       = (uintptr_t const *)&mem[guard];
+    l_stack[prio].size     = size;
+    l_stack[prio].hiWater  = (size_t)0;
+    l_stack[prio].isWarned = false;
+    QF_CRIT_EXIT_();
+}
+
+/****************************************************************************/
+static size_t stack_measure(uintptr_t const * const lo, size_t const size) {
+    uintptr_t const paint = ((uintptr_t)-1 / 0xFFU) * (uintptr_t)STACK_PAINT;
+    uintptr_t const volatile * const w = lo; /* written by the AO thread */
+    size_t const n = size / sizeof(uintptr_t);
+    size_t i;
+
+    /* from the bottom up to the first word touched by the AO thread */
+    for (i = (size_t)0; (i < n) && (w[i] == paint); ++i) {
+    }
+    return size - (i * sizeof(uintptr_t));
+}
+
+/*****************************************************************************
+* NOTE1:
+* The stack of every AO thread is mapped by the port with
+* QF_STACK_GUARD_PAGES inaccessible pages below it, so that a stack
+* overflow ends with SIGSEGV right away instead of silently corrupting
+* the adjacent memory, and is painted with STACK_PAINT. The high-water
+* mark is the distance from the top of the stack down to the lowest word
+* that no longer holds the paint. It includes the thread descriptor and
+* the static TLS, which glibc places at the top of the stack supplied by
+* the application, and it can underestimate the usage by the few words
+* that the deepest call happened to leave unwritten (or wrote with the
+* paint). The marks are measured only in QF_getStackUsage() and
+* QF_stackCheck(), so the application calls QF_stackCheck() periodically
+* (e.g., from a low-priority AO) and once more before it exits.
+*
+* The painting touches every page of the stack, which makes the whole
+* stack resident (and prefaulted for the real-time profile). The option is
+* meant for sizing the stacks: the measured high-water marks plus a safety
+* margin are then passed as the stkSize of QACTIVE_START() in the build
+* without QF_STACK_WATCH, in which the untouched pages of the p-thread
+* stacks never become resident. The painted stack also replaces the
+* node-local stack of an AO placed with QF_numaSetCpu().
+*/
+
+#endif /* QF_STACK_WATCH */
@@ -0,0 +1,103 @@
+/**
+* @file
+* @brief Stack painting and high-water measurement (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_stack_h
+#define qf_stack_h
+
+#ifndef QF_STACK_WARN_PCT
+    /*! The default usage [%] of a stack above which it is reported */
+    #define QF_STACK_WARN_PCT    80U
+#endif
+
+#ifndef QF_STACK_GUARD_PAGES
+    /*! The number of the inaccessible guard pages below every stack */
+    #define QF_STACK_GUARD_PAGES 1U
+#endif
+
+/*! The usage of the stack of one AO */
+typedef struct {
+    size_t size;      /*!< the usable size of the stack [bytes] */
+    size_t used;      /*!< the high-water mark of the stack [bytes] */
+} QStackUsage;
+
+/*! The callback for a stack whose usage crossed the warning threshold */
+typedef void (*QStackWarning)(uint_fast8_t const prio,
+                              QStackUsage const * const usage);
+
+/*! Set the warning threshold @p pct [%] and the callback @p onWarning */
+/**
+* @description
+* The threshold is QF_STACK_WARN_PCT by default (and 0 disables the
+* warnings). The callback (if not NULL) is invoked from QF_stackCheck()
+* once per stack, when its high-water mark first crosses the threshold.
+*/
+void QF_setStackWarning(uint_fast8_t const pct,
+                        QStackWarning const onWarning);
+
+/*! Get the usage of the stack of the AO at @p prio */
+/**
+* @description
+* Measures the high-water mark of the stack right away. Returns false
+* (and leaves @p usage untouched) if the AO has no stack painted by the
+* port, such as the AOs driven by QF_poll().
+*/
+bool QF_getStackUsage(uint_fast8_t const prio, QStackUsage * const usage);
+
+/*! Measure all the painted stacks and report the grown high-water marks */
+/**
+* @description
+* Produces the QS_PORT_STACK record for every stack whose high-water mark
+* grew since the last check and calls the warning callback for every
+* stack that crossed the threshold. Returns the number of the stacks
+* above the threshold. See NOTE1 in qf_stack.c.
+*/
+uint_fast8_t QF_stackCheck(void);
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! allocate and paint the stack of the AO at @p prio and set it in
+    * the thread attributes @p attr (called from QActive_start_())
+    */
+    void QF_stackAlloc_(uint_fast8_t const prio,
+                        pthread_attr_t * const attr, size_t const stkSize);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_stack_h */
@@ -0,0 +1,276 @@
+/**
+* @file
+* @brief Parallel dependency-aware startup of AOs (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+#include "qf_start.h"     /* parallel startup interface */
+
+#include <time.h>         /* for clock_gettime() */
+
+Q_DEFINE_THIS_MODULE("qf_start")
+
+enum {                    /* the startup states of an AO */
+    START_NONE,           /* not started */
+    START_PENDING,        /* started, the initial transition pending */
+    START_DONE            /* the initial transition completed */
+};
+
+typedef struct {          /* the startup of one AO */
+    QPSet deps;           /* the AOs initialized before this one */
+    QEvt const *ie;       /* the initial event of a deferred AO */
+    uint64_t t0;          /* the time stamp of the current phase [ns] */
+    QStartTime time;      /* the startup times */
+    uint8_t state;        /* the startup state */
+    bool isDeferred;      /* initialized in the thread of the AO? */
+} QStartAO;
+
+static QStartAO l_start[QF_MAX_ACTIVE + 1];
+static bool l_isParallel;
+static uint_fast8_t l_nDeferred; /* # deferred initial transitions pending */
+static pthread_mutex_t l_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  l_cond  = PTHREAD_COND_INITIALIZER;
+
+static bool start_isAfter(uint_fast8_t const prio, uint_fast8_t const dep);
+static bool start_depsDone(QPSet const * const deps);
+static uint64_t start_nsNow(void);
+
+/*..........................................................................*/
+void QF_startParallel(bool const enable) {
+    pthread_mutex_lock(&l_mutex);
+    l_isParallel = enable;
+    pthread_mutex_unlock(&l_mutex);
+}
+/*..........................................................................*/
+void QF_startAfter(uint_fast8_t const prio, uint_fast8_t const dep) {
+    bool isCycle;
+
+    /** @pre both priorities must be in range and different and the AO
+    * at @p prio must not be started yet
+    */
+    Q_REQUIRE_ID(100, ((uint_fast8_t)0 < prio)
+                      && (prio <= (uint_fast8_t)QF_MAX_ACTIVE)
+                      && ((uint_fast8_t)0 < dep)
+                      && (dep <= (uint_fast8_t)QF_MAX_ACTIVE)
+                      && (prio != dep)
+                      && (l_start[prio].state != (uint8_t)START_PENDING));
+
+    pthread_mutex_lock(&l_mutex);
+    isCycle = start_isAfter(dep, prio);
+    if (!isCycle) {
+        QPSet_insert(&l_start[prio].deps, dep);
+    }
+    pthread_mutex_unlock(&l_mutex);
+
+    /** @post the dependencies must not form a cycle (a deadlock) */
+    Q_ENSURE_ID(110, !isCycle);
+}
+/*..........................................................................*/
+bool QF_getStartTime(uint_fast8_t const prio, QStartTime * const t) {
+    bool isDone;
+
+    /** @pre the priority must be in range */
+    Q_REQUIRE_ID(200, prio <= (uint_fast8_t)QF_MAX_ACTIVE);
+
+    pthread_mutex_lock(&l_mutex);
+    isDone = (l_start[prio].state == (uint8_t)START_DONE);
+    if (isDone) {
+        *t = l_start[prio].time;
+    }
+    pthread_mutex_unlock(&l_mutex);
+    return isDone;
+}
+
+/*..........................................................................*/
+bool QF_startBegin_(QActive const * const act, QEvt const * const ie,
+                    bool const hasThread)
+{
+    QStartAO * const a = &l_start[act->prio];
+    bool isDeferred;
+    bool isReady;
+
+    pthread_mutex_lock(&l_mutex);
+    a->t0 = start_nsNow();
+    a->time.waitUs = 0U;
+    a->time.initUs = 0U;
+    a->state = (uint8_t)START_PENDING;
+    isDeferred = l_isParallel && hasThread;
+    a->isDeferred = isDeferred;
+    if (isDeferred) {
+        a->ie = ie;
+        ++l_nDeferred;
+    }
+    isReady = isDeferred || start_depsDone(&a->deps);
+    pthread_mutex_unlock(&l_mutex);
+
+    /** @pre in the serial startup, the AOs declared with QF_startAfter()
+    * must be started before
+    */
+    Q_REQUIRE_ID(300, isReady);
+
+    return isDeferred;
+}
+/*..........................................................................*/
+bool QF_startWait_(uint_fast8_t const prio, QEvt const ** const ie) {
+    QStartAO * const a = &l_start[prio];
+    bool isDeferred;
+
+    pthread_mutex_lock(&l_mutex);
+    isDeferred = a->isDeferred && (a->state == (uint8_t)START_PENDING);
+    if (isDeferred) {
+        uint64_t now;
+        while (!start_depsDone(&a->deps)) {
+            pthread_cond_wait(&l_cond, &l_mutex);
+        }
+        now = start_nsNow();
+        a->time.waitUs = (uint32_t)((now - a->t0) / 1000U);
+        a->t0 = now; /* the initial transition begins */
+        *ie = a->ie;
+    }
+    pthread_mutex_unlock(&l_mutex);
+    return isDeferred;
+}
+/*..........................................................................*/
+void QF_startEnd_(uint_fast8_t const prio) {
+    QStartAO * const a = &l_start[prio];
+    QStartTime t;
+
+    pthread_mutex_lock(&l_mutex);
+    a->time.initUs = (uint32_t)((start_nsNow() - a->t0) / 1000U);
+    a->state = (uint8_t)START_DONE;
+    if (a->isDeferred) {
+        --l_nDeferred;
+    }
+    t = a->time;
+    pthread_cond_broadcast(&l_cond); /* the dependents and QF_run() */
+    pthread_mutex_unlock(&l_mutex);
+
+    QS_BEGIN(QS_PORT_AO_INIT, QF_active_[prio])
+        QS_U8(0, prio);       /* the priority of the AO */
+        QS_U32(0, t.waitUs);  /* waiting for the dependencies [us] */
+        QS_U32(0, t.initUs);  /* the top-most initial transition [us] */
+    QS_END()
+    (void)t; /* avoid the compiler warning when QS is not used */
+}
+/*..........................................................................*/
+void QF_startGate_(void) {
+    pthread_mutex_lock(&l_mutex);
+    while (l_nDeferred != (uint_fast8_t)0) {
+        pthread_cond_wait(&l_cond, &l_mutex);
+    }
+    pthread_mutex_unlock(&l_mutex);
+}
+
+/****************************************************************************/
+/* does the AO at prio initialize after the AO at dep (transitively)? */
+static bool start_isAfter(uint_fast8_t const prio, uint_fast8_t const dep) {
+    QPSet todo = l_start[prio].deps;
+    QPSet seen;
+    bool isAfter = false;
+
+    QPSet_setEmpty(&seen);
+    while ((!isAfter) && QPSet_notEmpty(&todo)) {
+        uint_fast8_t p;
+        QPSet_findMax(&todo, p);
+        QPSet_remove(&todo, p);
+        if (p == dep) {
+            isAfter = true;
+        }
+        else if (!QPSet_hasElement(&seen, p)) {
+            QPSet next = l_start[p].deps;
+            QPSet_insert(&seen, p);
+            while (QPSet_notEmpty(&next)) { /* add the dependencies of p */
+                uint_fast8_t n;
+                QPSet_findMax(&next, n);
+                QPSet_remove(&next, n);
+                QPSet_insert(&todo, n);
+            }
+        }
+        else {
+            /* the dependencies of p are in the set already */
+        }
+    }
+    return isAfter;
+}
+/*..........................................................................*/
+static bool start_depsDone(QPSet const * const deps) {
+    QPSet todo = *deps;
+    bool isDone = true;
+    while (isDone && QPSet_notEmpty(&todo)) {
+        uint_fast8_t p;
+        QPSet_findMax(&todo, p);
+        QPSet_remove(&todo, p);
+        isDone = (l_start[p].state == (uint8_t)START_DONE);
+    }
+    return isDone;
+}
+/*..........................................................................*/
+static uint64_t start_nsNow(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*****************************************************************************
+* NOTE1:
+* In the parallel startup, QActive_start_() of an AO with its own p-thread
+* registers the AO (so that other AOs can post events to it right away)
+* and creates its thread, but the thread takes the top-most initial
+* transition (or restores the AO, see NOTE9 in qf_port.h) before it
+* dispatches any events, and only after the initial transitions of all
+* the AOs it has been declared to depend on with QF_startAfter() have
+* completed. The events posted to an AO before its initial transition
+* simply wait in its queue. The AOs driven by QF_poll() and the AOs
+* started in the serial startup take their initial transitions in the
+* caller of QActive_start_(), as usual.
+*
+* QF_run() waits for all the deferred initial transitions before it calls
+* QF_onStartup() (which typically starts the clock tick), so the
+* application sees the same fully-initialized system as after the serial
+* startup, only sooner. QF_startAfter() rejects the dependencies forming a
+* cycle, but an AO depending on an AO that is never started waits forever
+* (and so does QF_run()). The times of both phases of every AO are
+* available from QF_getStartTime() and in the QS_PORT_AO_INIT records.
+*/
@@ -0,0 +1,102 @@
+/**
+* @file
+* @brief Parallel dependency-aware startup of AOs (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_start_h
+#define qf_start_h
+
+/*! The startup times of one AO */
+typedef struct {
+    uint32_t waitUs;  /*!< from QActive_start_() to the dependencies [us] */
+    uint32_t initUs;  /*!< the top-most initial transition [us] */
+} QStartTime;
+
+/*! Run the initial transitions of the AOs started from now on in parallel */
+/**
+* @description
+* With @p enable set, QActive_start_() of the AOs with their own p-threads
+* no longer takes the top-most initial transition in the caller, but the
+* thread of the AO takes it, after the initial transitions of all the AOs
+* declared with QF_startAfter() have completed. QF_run() waits for all
+* these initial transitions before it calls QF_onStartup(). See NOTE1 in
+* qf_start.c.
+*/
+void QF_startParallel(bool const enable);
+
+/*! Declare that the AO at @p prio initializes after the AO at @p dep */
+/**
+* @description
+* Must be called before the AO at @p prio is started. In the serial
+* startup the AO at @p dep must simply be started before, in the parallel
+* startup it can be started in any order.
+*/
+void QF_startAfter(uint_fast8_t const prio, uint_fast8_t const dep);
+
+/*! Get the startup times of the AO at @p prio */
+/**
+* @description
+* Returns false (and leaves @p t untouched) while the initial transition
+* of the AO has not completed yet.
+*/
+bool QF_getStartTime(uint_fast8_t const prio, QStartTime * const t);
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! begin the startup of the AO @p act with the initial event @p ie,
+    * returns true when the thread of the AO takes the initial transition
+    * (which the AO with its own thread @p hasThread can)
+    */
+    bool QF_startBegin_(QActive const * const act, QEvt const * const ie,
+                        bool const hasThread);
+
+    /*! wait in the thread of the AO at @p prio for its dependencies,
+    * returns true (and the initial event @p ie) when the thread takes
+    * the initial transition
+    */
+    bool QF_startWait_(uint_fast8_t const prio, QEvt const ** const ie);
+
+    /*! end the startup of the AO at @p prio after its initial transition */
+    void QF_startEnd_(uint_fast8_t const prio);
+
+    /*! wait until all the parallel initial transitions have completed */
+    void QF_startGate_(void);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_start_h */
@@ -0,0 +1,790 @@
+/**
+* @file
+* @brief Extended (blocking) threads in user space (QF/C port to POSIX)
+* @ingroup ports
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#define QP_IMPL           /* this is QP implementation */
+#include "qf_port.h"      /* QF port */
+#include "qf_pkg.h"
+#include "qassert.h"      /* QP embedded systems-friendly assertions */
+#ifdef Q_SPY              /* QS software tracing enabled? */
+    #include "qs_port.h"  /* include QS port */
+#else
+    #include "qs_dummy.h" /* disable the QS software tracing */
+#endif /* Q_SPY */
+
+#include <sched.h>        /* for sched_yield() */
+#include <stdlib.h>       /* for malloc() and free() */
+
+/* define QF_XTHR_UCONTEXT to switch the contexts with swapcontext() also
+* on x86-64, where the port switches the stacks by itself, see NOTE2
+*/
+#if defined(QF_XTHR_UCONTEXT) || !defined(__x86_64__)
+    #define XTHR_UCONTEXT_  1
+    #include <ucontext.h> /* for makecontext() and swapcontext() */
+#endif
+
+Q_DEFINE_THIS_MODULE("qf_xthr")
+
+#ifndef XTHR_UCONTEXT_
+typedef void *QXContext;  /* the saved stack pointer, see NOTE2 */
+#else
+typedef ucontext_t QXContext;
+#endif
+
+typedef struct QXCarrierTag QXCarrier;
+
+typedef struct {          /* the port part of an extended thread */
+    QXContext ctx;        /* the context saved while not running */
+    QXCarrier *carrier;   /* the carrier p-thread of the thread */
+    QXThreadHandler handler; /* the thread-handler function */
+    QPSet *waitSet;       /* the wait set of the blocking object (or 0) */
+    void *stkSto;         /* the stack allocated by the port (or 0) */
+    uint8_t wake;         /* why the thread was unblocked (XTHR_WAKE_...) */
+    bool isBlocked;       /* switched out until unblocked */
+    bool isArmed;         /* the timeout armed and not posted, see NOTE3 */
+    bool isStale;         /* the canceled timeout still being posted */
+    bool isDone;          /* the thread-handler returned */
+} QXThreadCtx;
+
+struct QXCarrierTag {     /* the p-thread running the extended threads */
+    QXContext ctx;        /* the context of the scheduling loop */
+    QPSet readySet;       /* the extended threads ready to run */
+    pthread_cond_t cond;  /* wakes up the idle carrier */
+    QXThread *curr;       /* the running extended thread (or 0) */
+    uint32_t nSwitch;     /* the number of switches to the threads */
+    pthread_t thread;
+    bool isStarted;
+};
+
+enum {                    /* why the extended thread was unblocked */
+    XTHR_WAKE_NONE,       /* still waiting */
+    XTHR_WAKE_SIGNAL,     /* the blocking object became available */
+    XTHR_WAKE_TIMEOUT     /* the timeout expired */
+};
+
+static QXCarrier l_carrier[QF_XTHR_MAX_CARRIER];
+static QXThreadCtx *l_ctx[QF_MAX_ACTIVE + 1]; /* indexed by priority */
+static __thread QXCarrier *l_self; /* the carrier of the calling p-thread */
+
+static void QXThread_init_(QHsm * const me, QEvt const * const e);
+static void QXThread_dispatch_(QHsm * const me, QEvt const * const e);
+static void QXThread_start_(QActive * const me, uint_fast8_t prio,
+                    QEvt const *qSto[], uint_fast16_t qLen,
+                    void *stkSto, uint_fast16_t stkSize,
+                    QEvt const *ie);
+#ifndef Q_SPY
+static bool QXThread_post_(QActive * const me, QEvt const * const e,
+                    uint_fast16_t const margin);
+#else
+static bool QXThread_post_(QActive * const me, QEvt const * const e,
+                    uint_fast16_t const margin, void const * const sender);
+#endif
+static void QXThread_postLIFO_(QActive * const me, QEvt const * const e);
+
+static void *carrier_routine(void *arg);
+static void xthr_entry(void);
+static void xthr_ctxInit(QXThreadCtx * const x,
+                         void * const stk, size_t const stkSize);
+static void xthr_switch(QXContext * const from, QXContext * const to);
+static QXThread *xthr_curr(void);
+static void xthr_unblock(QXThread * const thr, uint8_t const wake);
+static uint8_t xthr_wait(QXThread * const thr, void const * const obj,
+                         QPSet * const waitSet,
+                         uint_fast16_t const nTicks,
+                         uint_fast8_t const tickRate);
+
+/*..........................................................................*/
+void QXThread_ctor(QXThread * const me,
+                   QXThreadHandler handler, uint_fast8_t tickRate)
+{
+    static QXThreadVtbl const vtbl = { /* QXThread virtual table */
+        { &QXThread_init_,       /* not used in QXThread */
+          &QXThread_dispatch_ }, /* not used in QXThread */
+        &QXThread_start_,
+        &QXThread_post_,
+        &QXThread_postLIFO_
+    };
+
+    /* the handler in place of the initial transition, see NOTE4 */
+    QActive_ctor(&me->super, Q_STATE_CAST((void (*)(void))handler));
+    me->super.super.vptr = &vtbl.super; /* set the vptr to QXThread v-table */
+    me->super.super.state.act = Q_ACTION_CAST(0); /* mark as extended thread */
+    me->super.thread = QF_XTHREAD_THREAD_; /* in the carrier 0 */
+
+    /* the private time event of the timeouts, see NOTE3 */
+    QTimeEvt_ctorX(&me->timeEvt, &me->super, (enum_t)Q_USER_SIG, tickRate);
+}
+/*..........................................................................*/
+void QXThread_setCarrier(QXThread * const me, uint_fast8_t const carrier) {
+    /** @pre the carrier must be in range and the thread not started */
+    Q_REQUIRE_ID(100, (carrier < (uint_fast8_t)QF_XTHR_MAX_CARRIER)
+                      && (me->super.prio == (uint8_t)0));
+    me->super.thread = (uint8_t)(QF_XTHREAD_THREAD_ + carrier);
+}
+/*..........................................................................*/
+uint32_t QXThread_getSwitches(uint_fast8_t const carrier) {
+    uint32_t n;
+    QF_CRIT_STAT_
+
+    Q_REQUIRE_ID(150, carrier < (uint_fast8_t)QF_XTHR_MAX_CARRIER);
+    QF_CRIT_ENTRY_();
+    n = l_carrier[carrier].nSwitch;
+    QF_CRIT_EXIT_();
+    return n;
+}
+
+/*..........................................................................*/
+static void QXThread_init_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(110);
+}
+/*..........................................................................*/
+static void QXThread_dispatch_(QHsm * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(120);
+}
+/*..........................................................................*/
+static void QXThread_start_(QActive * const me, uint_fast8_t prio,
+                    QEvt const *qSto[], uint_fast16_t qLen,
+                    void *stkSto, uint_fast16_t stkSize,
+                    QEvt const *ie)
+{
+    QXCarrier * const c = &l_carrier[me->thread - QF_XTHREAD_THREAD_];
+    QXThreadCtx *x;
+    void *stkOwn = (void *)0;
+    bool isStarted;
+    QF_CRIT_STAT_
+
+    Q_REQUIRE_ID(200, (prio <= (uint_fast8_t)QF_MAX_ACTIVE)
+        && (me->super.state.act == (QActionHandler)0));
+#ifdef QF_MAX_DOMAIN
+    /* the carriers serve the domain 0, see NOTE3 in qf_port.h */
+    Q_REQUIRE_ID(201, QF_DOMAIN_ID_() == (uint_fast8_t)0);
+#endif
+
+    (void)ie; /* parameter not referenced */
+
+    if (stkSize == (uint_fast16_t)0) {
+        stkSize = (uint_fast16_t)QF_XTHR_STACK_SIZE;
+    }
+    if (stkSto == (void *)0) { /* stack not provided? */
+        stkOwn = malloc((size_t)stkSize);
+        Q_ASSERT_ID(210, stkOwn != (void *)0);
+        stkSto = stkOwn;
+    }
+    /* the port part of the thread takes the top of the stack */
+    x = (QXThreadCtx *)(((uintptr_t)stkSto + (uintptr_t)stkSize
+                         - (uintptr_t)sizeof(QXThreadCtx))
+                        & ~(uintptr_t)63);
+    Q_ASSERT_ID(220, (uintptr_t)x > (uintptr_t)stkSto + 1024U);
+    x->carrier   = c;
+    x->handler   = (QXThreadHandler)(void (*)(void))me->super.temp.act;
+    x->waitSet   = (QPSet *)0;
+    x->stkSto    = stkOwn;
+    x->wake      = (uint8_t)XTHR_WAKE_NONE;
+    x->isBlocked = true; /* until made ready below */
+    x->isArmed   = false;
+    x->isStale   = false;
+    x->isDone    = false;
+    xthr_ctxInit(x, stkSto, (size_t)((uintptr_t)x - (uintptr_t)stkSto));
+
+    /* is storage for the queue buffer provided? */
+    if (qSto != (QEvt const **)0) {
+        QEQueue_init(&me->eQueue, qSto, qLen);
+    }
+    me->prio = (uint8_t)prio;
+    me->super.temp.obj = (QMState const *)0; /* not blocked on any object */
+    l_ctx[prio] = x;
+    QF_add_(me); /* make QF aware of this extended thread */
+
+    QF_CRIT_ENTRY_();
+    isStarted = c->isStarted;
+    if (!isStarted) {
+        c->isStarted = true;
+        QPSet_setEmpty(&c->readySet);
+        pthread_cond_init(&c->cond, 0);
+    }
+    xthr_unblock((QXThread *)me, (uint8_t)XTHR_WAKE_NONE); /* ready */
+    QF_CRIT_EXIT_();
+
+    if (!isStarted) { /* the first thread of this carrier? */
+        pthread_attr_t attr;
+        QF_threadAttrInit_(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+        /* the carrier runs at the priority of its first thread */
+        QF_createThread_(&c->thread, &attr, QF_aoPrio_(prio),
+                         &carrier_routine, c);
+        pthread_attr_destroy(&attr);
+    }
+}
+/*..........................................................................*/
+#ifndef Q_SPY
+static bool QXThread_post_(QActive * const me, QEvt const * const e,
+                           uint_fast16_t const margin)
+#else
+static bool QXThread_post_(QActive * const me, QEvt const * const e,
+                           uint_fast16_t const margin,
+                           void const * const sender)
+#endif
+{
+    bool status;
+
+    /* is it the private time event? */
+    if (e == &((QXThread *)me)->timeEvt.super) {
+        QXThreadCtx *x;
+        QF_CRIT_STAT_
+
+        QF_CRIT_ENTRY_();
+        x = l_ctx[me->prio];
+        if (x->isStale) { /* timeout canceled after expiring? */
+            x->isStale = false; /* the last trace of it, see NOTE3 */
+        }
+        else if (x->isArmed) {
+            x->isArmed = false;
+            if ((me->super.temp.obj != (QMState const *)0)
+                && (x->wake == (uint8_t)XTHR_WAKE_NONE)) /* waiting? */
+            {
+                if (x->waitSet != (QPSet *)0) {
+                    QPSet_remove(x->waitSet, me->prio);
+                }
+                xthr_unblock((QXThread *)me, (uint8_t)XTHR_WAKE_TIMEOUT);
+            }
+        }
+        else {
+            /* the time event is armed only by the thread itself */
+            Q_ERROR_ID(310);
+        }
+        QF_CRIT_EXIT_();
+        status = true;
+    }
+    /* is the event queue provided? */
+    else if (me->eQueue.end != (QEQueueCtr)0) {
+        /* the AO queue, signaled through QXThread_queueSignal_() */
+#ifndef Q_SPY
+        status = QActive_post_(me, e, margin);
+#else
+        status = QActive_post_(me, e, margin, sender);
+#endif
+    }
+    else { /* the queue is not available */
+         QF_gc(e); /* make sure the event is not leaked */
+         status = false;
+         Q_ERROR_ID(320); /* extended thread does not expect events */
+    }
+
+    return status;
+}
+/*..........................................................................*/
+static void QXThread_postLIFO_(QActive * const me, QEvt const * const e) {
+    (void)me;
+    (void)e;
+    Q_ERROR_ID(410); /* LIFO policy is not supported for extended threads */
+}
+/*..........................................................................*/
+void QXThread_queueSignal_(QActive * const me) { /* in critical section */
+    /* is this thread blocked on the queue? */
+    if ((me->super.temp.obj == (QMState const *)&me->eQueue)
+        && (l_ctx[me->prio]->wake == (uint8_t)XTHR_WAKE_NONE))
+    {
+        xthr_unblock((QXThread *)me, (uint8_t)XTHR_WAKE_SIGNAL);
+    }
+}
+
+/*..........................................................................*/
+QEvt const *QXThread_queueGet(uint_fast16_t const nTicks,
+                              uint_fast8_t const tickRate)
+{
+    QXThread * const thr = xthr_curr();
+    QEQueueCtr nFree;
+    QEvt const *e;
+    QF_CRIT_STAT_
+
+    /** @pre must be called from an extended thread, which is not blocked
+    * and which has the queue
+    */
+    Q_REQUIRE_ID(500, (thr != (QXThread *)0)
+        && (thr->super.super.temp.obj == (QMState const *)0)
+        && (thr->super.eQueue.end != (QEQueueCtr)0));
+
+    QF_CRIT_ENTRY_();
+
+    /* is the queue empty? */
+    if (thr->super.eQueue.frontEvt == (QEvt *)0) {
+        (void)xthr_wait(thr, &thr->super.eQueue, (QPSet *)0,
+                        nTicks, tickRate); /* BLOCK here */
+    }
+
+    /* is the queue not empty? */
+    if (thr->super.eQueue.frontEvt != (QEvt *)0) {
+        e = thr->super.eQueue.frontEvt; /* always remove from the front */
+        nFree= thr->super.eQueue.nFree +(QEQueueCtr)1; /* volatile into tmp */
+        thr->super.eQueue.nFree = nFree; /* update the number of free */
+
+        /* any events in the ring buffer? */
+        if (nFree <= thr->super.eQueue.end) {
+
+            /* remove event from the tail */
+            thr->super.eQueue.frontEvt =
+                QF_PTR_AT_(thr->super.eQueue.ring, thr->super.eQueue.tail);
+            if (thr->super.eQueue.tail == (QEQueueCtr)0) { /* need to wrap? */
+                thr->super.eQueue.tail = thr->super.eQueue.end;  /* wrap */
+            }
+            --thr->super.eQueue.tail;
+
+            QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_GET, QS_priv_.aoObjFilter, thr)
+                QS_TIME_();                   /* timestamp */
+                QS_SIG_(e->sig);              /* the signal of this event */
+                QS_OBJ_(&thr->super);         /* this active object */
+                QS_2U8_(e->poolId_, e->refCtr_); /* pool Id & ref Count */
+                QS_EQC_(nFree);               /* number of free entries */
+            QS_END_NOCRIT_()
+        }
+        else {
+            thr->super.eQueue.frontEvt = (QEvt const *)0; /* empty queue */
+
+            /* all entries in the queue must be free (+1 for fronEvt) */
+            Q_ASSERT_ID(520, nFree == (thr->super.eQueue.end +(QEQueueCtr)1));
+
+            QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_GET_LAST, QS_priv_.aoObjFilter, thr)
+                QS_TIME_();                   /* timestamp */
+                QS_SIG_(e->sig);              /* the signal of this event */
+                QS_OBJ_(&thr->super);         /* this active object */
+                QS_2U8_(e->poolId_, e->refCtr_); /* pool Id & ref Count */
+            QS_END_NOCRIT_()
+        }
+    }
+    else { /* the queue is still empty -- the timeout must have fired */
+         e = (QEvt const *)0;
+    }
+    QF_CRIT_EXIT_();
+
+    if (e != (QEvt const *)0) {
+        QF_DISPATCH_HOOK_(e); /* e.g., measure the time-event delay */
+    }
+    return e;
+}
+/*..........................................................................*/
+bool QXThread_delay(uint_fast16_t const nTicks, uint_fast8_t const tickRate) {
+    QXThread * const thr = xthr_curr();
+    uint8_t wake;
+    QF_CRIT_STAT_
+
+    /** @pre must be called from an extended thread, which is not blocked,
+    * for a non-zero number of ticks
+    */
+    Q_REQUIRE_ID(600, (thr != (QXThread *)0)
+        && (thr->super.super.temp.obj == (QMState const *)0)
+        && (nTicks != QXTHREAD_NO_TIMEOUT));
+
+    QF_CRIT_ENTRY_();
+    wake = xthr_wait(thr, &thr->timeEvt, (QPSet *)0,
+                     nTicks, tickRate); /* BLOCK here */
+    QF_CRIT_EXIT_();
+
+    return (bool)(wake == (uint8_t)XTHR_WAKE_TIMEOUT); /* not canceled? */
+}
+/*..........................................................................*/
+bool QXThread_delayCancel(QXThread * const me) {
+    bool wasDelayed;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    if ((me->super.super.temp.obj == (QMState const *)&me->timeEvt)
+        && (l_ctx[me->super.prio]->wake == (uint8_t)XTHR_WAKE_NONE))
+    {
+        xthr_unblock(me, (uint8_t)XTHR_WAKE_SIGNAL);
+        wasDelayed = true;
+    }
+    else {
+        wasDelayed = false;
+    }
+    QF_CRIT_EXIT_();
+
+    return wasDelayed;
+}
+
+/*..........................................................................*/
+void QXSemaphore_init(QXSemaphore * const me, uint_fast16_t count) {
+    me->count = count;
+    QPSet_setEmpty(&me->waitSet);
+}
+/*..........................................................................*/
+bool QXSemaphore_wait(QXSemaphore * const me,
+                      uint_fast16_t const nTicks,
+                      uint_fast8_t const tickRate)
+{
+    QXThread * const thr = xthr_curr();
+    bool signaled;
+    QF_CRIT_STAT_
+
+    /** @pre must be called from an extended thread, which is not blocked */
+    Q_REQUIRE_ID(700, (thr != (QXThread *)0)
+        && (thr->super.super.temp.obj == (QMState const *)0));
+
+    QF_CRIT_ENTRY_();
+    if (me->count > (uint_fast16_t)0) {
+        --me->count;
+        signaled = true;
+    }
+    else { /* the count is handed over directly by QXSemaphore_signal() */
+        signaled = (xthr_wait(thr, me, &me->waitSet, nTicks, tickRate)
+                    == (uint8_t)XTHR_WAKE_SIGNAL); /* BLOCK here */
+    }
+    QF_CRIT_EXIT_();
+
+    return signaled;
+}
+/*..........................................................................*/
+void QXSemaphore_signal(QXSemaphore * const me) {
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    if (QPSet_notEmpty(&me->waitSet)) {
+        uint_fast8_t p;
+        QPSet_findMax(&me->waitSet, p);
+        QPSet_remove(&me->waitSet, p);
+        xthr_unblock((QXThread *)QF_active_[p], (uint8_t)XTHR_WAKE_SIGNAL);
+    }
+    else {
+        ++me->count;
+    }
+    QF_CRIT_EXIT_();
+}
+
+/*..........................................................................*/
+void QXMutex_init(QXMutex * const me, uint_fast8_t prio) {
+    me->lockPrio = prio;
+    me->holder   = (uint_fast8_t)0;
+    QPSet_setEmpty(&me->waitSet);
+}
+/*..........................................................................*/
+void QXMutex_lock(QXMutex * const me) {
+    QXThread * const thr = xthr_curr();
+    QF_CRIT_STAT_
+
+    /** @pre must be called from an extended thread, which is not blocked,
+    * with the priority not above the ceiling and not holding the mutex
+    */
+    Q_REQUIRE_ID(800, (thr != (QXThread *)0)
+        && (thr->super.super.temp.obj == (QMState const *)0)
+        && ((uint_fast8_t)thr->super.prio <= me->lockPrio)
+        && (me->holder != (uint_fast8_t)thr->super.prio));
+
+    QF_CRIT_ENTRY_();
+    if (me->holder == (uint_fast8_t)0) {
+        me->holder = (uint_fast8_t)thr->super.prio;
+    }
+    else { /* the mutex is handed over directly by QXMutex_unlock() */
+        (void)xthr_wait(thr, me, &me->waitSet,
+                        QXTHREAD_NO_TIMEOUT, (uint_fast8_t)0); /* BLOCK */
+        Q_ASSERT_ID(810, me->holder == (uint_fast8_t)thr->super.prio);
+    }
+    QF_CRIT_EXIT_();
+}
+/*..........................................................................*/
+void QXMutex_unlock(QXMutex * const me) {
+    QXThread * const thr = xthr_curr();
+    QF_CRIT_STAT_
+
+    /** @pre must be called from the extended thread holding the mutex */
+    Q_REQUIRE_ID(900, (thr != (QXThread *)0)
+        && (me->holder == (uint_fast8_t)thr->super.prio));
+
+    QF_CRIT_ENTRY_();
+    if (QPSet_notEmpty(&me->waitSet)) {
+        uint_fast8_t p;
+        QPSet_findMax(&me->waitSet, p);
+        QPSet_remove(&me->waitSet, p);
+        me->holder = p;
+        xthr_unblock((QXThread *)QF_active_[p], (uint8_t)XTHR_WAKE_SIGNAL);
+    }
+    else {
+        me->holder = (uint_fast8_t)0;
+    }
+    QF_CRIT_EXIT_();
+}
+
+/*..........................................................................*/
+static void *carrier_routine(void *arg) { /* the expected POSIX signature */
+    QXCarrier * const c = (QXCarrier *)arg;
+
+    l_self = c;
+    QF_CRIT_ENTRY_(); /* the threads are switched in the crit. section */
+    for (;;) {
+        uint_fast8_t p;
+        QXThreadCtx *x;
+
+        while (QPSet_isEmpty(&c->readySet)) {
+            pthread_cond_wait(&c->cond, &QF_pThreadMutex_);
+        }
+        QPSet_findMax(&c->readySet, p);
+        QPSet_remove(&c->readySet, p);
+        x = l_ctx[p];
+        c->curr = (QXThread *)QF_active_[p];
+        ++c->nSwitch;
+
+        xthr_switch(&c->ctx, &x->ctx); /* run until it blocks or yields */
+
+        c->curr = (QXThread *)0;
+        if (x->isDone && (x->stkSto != (void *)0)) { /* own stack? */
+            free(x->stkSto); /* x itself is at the top of the stack */
+        }
+    }
+    return (void *)0;
+}
+/*..........................................................................*/
+static void xthr_entry(void) {
+    QXThread * const thr = l_self->curr;
+    QXThreadCtx * const x = l_ctx[thr->super.prio];
+    QF_CRIT_STAT_
+
+    QF_CRIT_EXIT_(); /* switched to in the critical section */
+    (*x->handler)(thr); /* the thread-handler function */
+
+    /* the thread-handler returned, remove the thread from QF */
+    QF_remove_(&thr->super);
+    QF_CRIT_ENTRY_();
+    while (x->isStale) { /* the last timeout still being posted? */
+        QF_CRIT_EXIT_();
+        (void)sched_yield();
+        QF_CRIT_ENTRY_();
+    }
+    l_ctx[thr->super.prio] = (QXThreadCtx *)0;
+    x->isDone = true;
+    xthr_switch(&x->ctx, &x->carrier->ctx); /* never returns */
+}
+/*..........................................................................*/
+static QXThread *xthr_curr(void) {
+    return (l_self != (QXCarrier *)0)
+           ? l_self->curr
+           : (QXThread *)0;
+}
+/*..........................................................................*/
+static void xthr_unblock(QXThread * const thr, uint8_t const wake) {
+    QXThreadCtx * const x = l_ctx[thr->super.prio];
+
+    x->wake = wake;
+    if (x->isBlocked) { /* already switched out? */
+        QXCarrier * const c = x->carrier;
+        x->isBlocked = false;
+        QPSet_insert(&c->readySet, thr->super.prio);
+        if (c != l_self) { /* another p-thread? */
+            pthread_cond_signal(&c->cond);
+        }
+        else if (c->curr->super.prio < thr->super.prio) {
+            /* preempt the calling lower-priority thread, see NOTE1 */
+            QPSet_insert(&c->readySet, c->curr->super.prio);
+            xthr_switch(&l_ctx[c->curr->super.prio]->ctx, &c->ctx);
+        }
+        else {
+            /* the thread will run when the caller blocks */
+        }
+    }
+}
+/*..........................................................................*/
+static uint8_t xthr_wait(QXThread * const thr, void const * const obj,
+                         QPSet * const waitSet,
+                         uint_fast16_t const nTicks,
+                         uint_fast8_t const tickRate)
+{
+    QXThreadCtx * const x = l_ctx[thr->super.prio];
+    uint8_t wake;
+
+    /* remember the blocking object */
+    thr->super.super.temp.obj = (QMState const *)obj;
+    x->waitSet = waitSet;
+    x->wake = (uint8_t)XTHR_WAKE_NONE;
+    if (waitSet != (QPSet *)0) {
+        QPSet_insert(waitSet, thr->super.prio);
+    }
+
+    if (nTicks != QXTHREAD_NO_TIMEOUT) { /* arm the timeout, see NOTE3 */
+        while (x->isStale) { /* the previous timeout still being posted? */
+            QF_CRIT_EXIT_();
+            (void)sched_yield();
+            QF_CRIT_ENTRY_();
+        }
+        /* is the time event unlinked? (otherwise the rate can't change) */
+        if ((thr->timeEvt.super.refCtr_ & (uint8_t)0x80) == (uint8_t)0) {
+            thr->timeEvt.super.refCtr_ = (uint8_t)tickRate;
+        }
+        x->isArmed = true;
+        QF_CRIT_EXIT_();
+        QTimeEvt_armX(&thr->timeEvt, (QTimeEvtCtr)nTicks, (QTimeEvtCtr)0);
+        QF_CRIT_ENTRY_();
+    }
+
+    if (x->wake == (uint8_t)XTHR_WAKE_NONE) { /* not unblocked already? */
+        x->isBlocked = true;
+        xthr_switch(&x->ctx, &x->carrier->ctx); /* BLOCK here */
+    }
+    wake = x->wake;
+    thr->super.super.temp.obj = (QMState const *)0; /* clear */
+
+    /* unblocked before the timeout? */
+    if ((wake != (uint8_t)XTHR_WAKE_TIMEOUT) && x->isArmed) {
+        bool wasArmed;
+        QF_CRIT_EXIT_();
+        wasArmed = QTimeEvt_disarm(&thr->timeEvt);
+        QF_CRIT_ENTRY_();
+        if (x->isArmed) { /* the timeout not posted in the meantime? */
+            x->isArmed = false;
+            x->isStale = !wasArmed; /* expired, but not posted yet */
+        }
+    }
+    return wake;
+}
+
+/****************************************************************************/
+#ifndef XTHR_UCONTEXT_
+
+/* switch the stacks: push the callee-saved registers (and the SSE/x87
+* control words) on the current stack, save the stack pointer in *from
+* and pop the registers of the other context from the stack @p to
+*/
+void QF_xthrSwitch_(void **from, void *to);
+__asm__(
+    ".text\n"
+    ".p2align 4\n"
+    ".globl QF_xthrSwitch_\n"
+    ".hidden QF_xthrSwitch_\n"
+    ".type QF_xthrSwitch_, @function\n"
+    "QF_xthrSwitch_:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size QF_xthrSwitch_, .-QF_xthrSwitch_\n"
+);
+
+/*..........................................................................*/
+static void xthr_ctxInit(QXThreadCtx * const x,
+                         void * const stk, size_t const stkSize)
+{
+    /* the frame popped by the first QF_xthrSwitch_() to the thread */
+    uint64_t *sp = (uint64_t *)(((uintptr_t)stk + stkSize)
+                                & ~(uintptr_t)15);
+    sp -= 2;           /* "return" to xthr_entry() as if called */
+    sp[0] = (uint64_t)(uintptr_t)&xthr_entry;
+    sp[1] = (uint64_t)0;
+    sp -= 7;           /* the control words and 6 registers */
+    sp[0] = ((uint64_t)0x037FU << 32) | (uint64_t)0x1F80U; /* defaults */
+    sp[1] = (uint64_t)0; sp[2] = (uint64_t)0; sp[3] = (uint64_t)0;
+    sp[4] = (uint64_t)0; sp[5] = (uint64_t)0; sp[6] = (uint64_t)0;
+    x->ctx = sp;
+}
+/*..........................................................................*/
+static void xthr_switch(QXContext * const from, QXContext * const to) {
+    QF_xthrSwitch_(from, *to);
+}
+
+#else /* XTHR_UCONTEXT_ */
+
+/*..........................................................................*/
+static void xthr_ctxInit(QXThreadCtx * const x,
+                         void * const stk, size_t const stkSize)
+{
+    Q_ALLEGE_ID(230, getcontext(&x->ctx) == 0);
+    x->ctx.uc_stack.ss_sp   = stk;
+    x->ctx.uc_stack.ss_size = stkSize;
+    x->ctx.uc_link          = (ucontext_t *)0; /* xthr_entry() never ends */
+    makecontext(&x->ctx, &xthr_entry, 0);
+}
+/*..........................................................................*/
+static void xthr_switch(QXContext * const from, QXContext * const to) {
+    Q_ALLEGE_ID(240, swapcontext(from, to) == 0);
+}
+
+#endif /* XTHR_UCONTEXT_ */
+
+/*****************************************************************************
+* NOTE1:
+* Every extended thread runs on its own stack in one of the carrier
+* p-threads, which is created with the first thread started in it (at the
+* SCHED_FIFO priority of that thread). The carrier switches to its highest-
+* priority ready thread and gets back when the thread blocks. The thread
+* unblocked by another thread of the same carrier with a lower priority
+* preempts it right away, but otherwise the threads in one carrier are not
+* time-sliced, so a thread computing without blocking delays the others in
+* its carrier (but not the AOs or the threads in the other carriers).
+* The threads are switched inside the critical section of QF, which every
+* blocking operation enters anyway, so the mutex just passes from one
+* thread to the next within the same p-thread.
+*
+* NOTE2:
+* On x86-64 the port switches the contexts by itself, saving only what the
+* ABI requires the callee to preserve, which takes a few nanoseconds. The
+* other architectures (or QF_XTHR_UCONTEXT) use makecontext() and
+* swapcontext(), which also switch the signal mask with a system call.
+* In both cases the thread must not leave its handler by longjmp().
+*
+* NOTE3:
+* The private time event of the thread is armed and disarmed outside of
+* the critical section, because QTimeEvt_armX() and QTimeEvt_disarm()
+* enter it themselves (which also keeps this code independent of the
+* layout of the armed time events, see QF_TIMEEVT_SOA). A timeout that
+* expired in QF_tickX_() just as the thread was unblocked is still posted
+* to the thread afterwards. Such timeout is marked stale, so that it does
+* not cut short the next wait, which cannot arm the timeout again before
+* the stale one is consumed.
+*
+* NOTE4:
+* The thread-handler is cast to the handlers of QEP through the generic
+* function pointer void (*)(void), which GCC accepts without the warning
+* about casting between incompatible function types.
+*/
@@ -0,0 +1,104 @@
+/**
+* @file
+* @brief Extended (blocking) threads in user space (QF/C port to POSIX)
+* @cond
+******************************************************************************
+* Last Updated for Version: 5.8.2
+* Date of the Last Update:  2016-12-22
+*
+*                    Q u a n t u m     L e a P s
+*                    ---------------------------
+*                    innovating embedded systems
+*
+* Copyright (C) Quantum Leaps, LLC. All rights reserved.
+*
+* This program is open source software: you can redistribute it and/or
+* modify it under the terms of the GNU General Public License as published
+* by the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Alternatively, this program may be distributed and modified under the
+* terms of Quantum Leaps commercial licenses, which expressly supersede
+* the GNU General Public License and are specifically designed for
+* licensees interested in retaining the proprietary status of their code.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact information:
+* http://www.state-machine.com
+* mailto:info@state-machine.com
+******************************************************************************
+* @endcond
+*/
+#ifndef qf_xthr_h
+#define qf_xthr_h
+
+#include "qpset.h"     /* the wait sets of the blocking objects */
+#include "qxthread.h"  /* QXThread and QXSemaphore (shared with QXK) */
+
+#ifndef QF_XTHR_MAX_CARRIER
+    /*! The maximum number of carrier p-threads of the extended threads */
+    #define QF_XTHR_MAX_CARRIER  4U
+#endif
+
+#ifndef QF_XTHR_STACK_SIZE
+    /*! The stack size of the extended threads started without a stack */
+    #define QF_XTHR_STACK_SIZE   (64U * 1024U)
+#endif
+
+/*! Run the extended thread @p me in the carrier p-thread @p carrier */
+/**
+* @description
+* The extended threads run by default in the carrier 0. Threads in the
+* same carrier share one p-thread, which switches among them in the user
+* space, while the different carriers run in parallel. Must be called
+* after QXThread_ctor() and before QXTHREAD_START(). See NOTE1 in
+* qf_xthr.c.
+*/
+void QXThread_setCarrier(QXThread * const me, uint_fast8_t const carrier);
+
+/*! The number of switches to the extended threads in the @p carrier */
+uint32_t QXThread_getSwitches(uint_fast8_t const carrier);
+
+/*! Blocking mutex of the extended threads */
+/**
+* @description
+* Unlike the QXK mutex, which locks the scheduler up to the priority
+* ceiling, this mutex blocks the extended threads that find it locked
+* (in the order of their priorities), because the threads in other
+* carriers run truly in parallel. The ceiling is kept for compatibility
+* with QXK and checked against the priorities of the lockers.
+*/
+typedef struct {
+    uint_fast8_t lockPrio; /*!< priority ceiling of the mutex */
+    uint_fast8_t holder;   /*!< priority of the holding thread (0: free) */
+    QPSet waitSet;         /*!< set of extended-threads waiting on it */
+} QXMutex;
+
+/*! The QXMutex initialization */
+void QXMutex_init(QXMutex * const me, uint_fast8_t prio);
+
+/*! QXMutex lock (blocks the calling extended thread until available) */
+void QXMutex_lock(QXMutex * const me);
+
+/*! QXMutex unlock */
+void QXMutex_unlock(QXMutex * const me);
+
+/****************************************************************************/
+/* interface used only inside QF implementation, but not in applications */
+#ifdef QP_IMPL
+
+    /*! the event queue of the extended thread @p me received an event
+    * (called from QACTIVE_EQUEUE_SIGNAL_() in a critical section)
+    */
+    void QXThread_queueSignal_(QActive * const me);
+
+#endif /* QP_IMPL */
+
+#endif /* qf_xthr_h */
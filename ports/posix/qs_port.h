@@ -60,4 +60,32 @@
 #include "qf_port.h"  /* use QS with QF */
 #include "qs.h"       /* QS platform-independent public interface */
 
+/*! QS records produced by the services of the POSIX port, see NOTE2 */
+enum QSPortRecords {
+    QS_PORT_EXEC_JOB = QS_USER + 42, /*!< an offloaded job has completed */
+    QS_PORT_RT_FAIL,             /*!< a real-time feature is not in effect */
+    QS_PORT_TICK_JITTER,         /*!< summary of the tick jitter of a rate */
+    QS_PORT_STACK,               /*!< the stack high-water mark of an AO */
+    QS_PORT_AO_INIT,             /*!< the startup times of an AO */
+    QS_PORT_TIMEEVT_ALIGN        /*!< a time event expiry was aligned */
+};
+
+/*! the record of the aligned expiries (QF_TIMEEVT_SLACK), see NOTE2 */
+#define QS_TIMEEVT_ALIGN  QS_PORT_TIMEEVT_ALIGN
+
+/*****************************************************************************
+* NOTE2:
+* The services of the POSIX port (qf_exec.c, etc.) produce their trace
+* records with the formatted user-record macros (QS_BEGIN()/QS_END()), so
+* that QSPY can display them without any changes on the host side. These
+* records occupy the top of the application-specific range (from
+* QS_USER + 42 up), so application records should be numbered from
+* QS_USER up to (QS_USER + 41). The port
+* records are subject to the global QS filter and the application-specific
+* object filter, like any other user record. The alignments of the time
+* events with timer slack are traced from the critical section of the
+* QF tick with the same format (QS_BEGIN_NOCRIT()), under the record
+* mapped to QS_TIMEEVT_ALIGN.
+*/
+
 #endif /* qs_port_h  */
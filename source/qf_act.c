@@ -50,7 +50,11 @@
 Q_DEFINE_THIS_MODULE("qf_act")
 
 /* public objects ***********************************************************/
+#ifndef QF_MAX_DOMAIN
 QActive *QF_active_[QF_MAX_ACTIVE + 1]; /* to be used by QF ports only */
+#else
+QActive *QF_domainActive_[QF_MAX_DOMAIN][QF_MAX_ACTIVE + 1];
+#endif
 
 /****************************************************************************/
 /**
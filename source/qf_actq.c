@@ -114,8 +114,19 @@ bool QActive_post_(QActive * const me, QEvt const * const e,
     QF_CRIT_ENTRY_();
     nFree = me->eQueue.nFree; /* get volatile into the temporary */
 
+    /* is the posting suppressed by the port (e.g., replaying events)? */
+    if (!QF_POST_FILTER_(me, e)) {
+        /* is it a pool event? */
+        if (e->poolId_ != (uint8_t)0) {
+            QF_EVT_REF_CTR_INC_(e);   /* as if posted... */
+        }
+        QF_CRIT_EXIT_();
+
+        QF_gc(e); /* ...and consumed right away */
+        status = true; /* event considered delivered */
+    }
     /* margin available? */
-    if (nFree > (QEQueueCtr)margin) {
+    else if (nFree > (QEQueueCtr)margin) {
 
         QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_POST_FIFO, QS_priv_.aoObjFilter, me)
             QS_TIME_();               /* timestamp */
@@ -203,6 +214,17 @@ void QActive_postLIFO_(QActive * const me, QEvt const * const e) {
     QF_CRIT_ENTRY_();
     nFree = me->eQueue.nFree; /* get volatile into the temporary */
 
+    /* is the posting suppressed by the port (e.g., replaying events)? */
+    if (!QF_POST_FILTER_(me, e)) {
+        /* is it a pool event? */
+        if (e->poolId_ != (uint8_t)0) {
+            QF_EVT_REF_CTR_INC_(e);  /* as if posted... */
+        }
+        QF_CRIT_EXIT_();
+        QF_gc(e); /* ...and consumed right away */
+        return;
+    }
+
     /* the queue must be able to accept the event (cannot overflow) */
     Q_ASSERT_ID(210, nFree != (QEQueueCtr)0);
 
@@ -51,8 +51,13 @@ Q_DEFINE_THIS_MODULE("qf_dyn")
 
 
 /* Package-scope objects ****************************************************/
+#ifndef QF_MAX_DOMAIN
 QF_EPOOL_TYPE_ QF_pool_[QF_MAX_EPOOL]; /* allocate the event pools */
 uint_fast8_t QF_maxPool_; /* number of initialized event pools */
+#else
+QF_EPOOL_TYPE_ QF_domainPool_[QF_MAX_DOMAIN][QF_MAX_EPOOL];
+uint_fast8_t QF_domainMaxPool_[QF_MAX_DOMAIN];
+#endif
 
 /****************************************************************************/
 #ifdef Q_EVT_CTOR  /* Provide the constructor for the ::QEvt class? */
@@ -89,6 +89,8 @@
 
 /* package-scope objects ****************************************************/
 
+#ifndef QF_MAX_DOMAIN
+
 /*! heads of linked lists of time events, one for every clock tick rate */
 extern QTimeEvt QF_timeEvtHead_[QF_MAX_TICK_RATE];
 
@@ -97,6 +99,39 @@ extern uint_fast8_t QF_maxPool_;     /*!< # of initialized event pools */
 extern QSubscrList *QF_subscrList_;  /*!< the subscriber list array */
 extern enum_t QF_maxPubSignal_;      /*!< the maximum published signal */
 
+#else /* independent QF domains, one copy of the objects per domain */
+
+extern QTimeEvt QF_domainTimeEvtHead_[QF_MAX_DOMAIN][QF_MAX_TICK_RATE];
+extern QF_EPOOL_TYPE_ QF_domainPool_[QF_MAX_DOMAIN][QF_MAX_EPOOL];
+extern uint_fast8_t QF_domainMaxPool_[QF_MAX_DOMAIN];
+extern QSubscrList *QF_domainSubscrList_[QF_MAX_DOMAIN];
+extern enum_t QF_domainMaxPubSignal_[QF_MAX_DOMAIN];
+
+/* the objects of the domain of the calling thread */
+#define QF_timeEvtHead_  (QF_domainTimeEvtHead_[QF_DOMAIN_ID_()])
+#define QF_pool_         (QF_domainPool_[QF_DOMAIN_ID_()])
+#define QF_maxPool_      (QF_domainMaxPool_[QF_DOMAIN_ID_()])
+#define QF_subscrList_   (QF_domainSubscrList_[QF_DOMAIN_ID_()])
+#define QF_maxPubSignal_ (QF_domainMaxPubSignal_[QF_DOMAIN_ID_()])
+
+#endif /* QF_MAX_DOMAIN */
+
+/* optional hooks of the QF port into the time management */
+#ifndef QF_TICK_HOOK_
+    /*! called at the beginning of every QF_tickX_() */
+    #define QF_TICK_HOOK_(tickRate_)  ((void)0)
+#endif
+#ifndef QF_TIMEEVT_POST_HOOK_
+    /*! called in QF_tickX_() before the expired time event is posted */
+    #define QF_TIMEEVT_POST_HOOK_(t_) ((void)0)
+#endif
+
+/* optional filter of the QF port on posting events to AOs */
+#ifndef QF_POST_FILTER_
+    /*! false if the event @p e_ must not be posted to @p me_ */
+    #define QF_POST_FILTER_(me_, e_)  (true)
+#endif
+
 /*! structure representing a free block in the Native QF Memory Pool */
 typedef struct QFreeBlock {
     struct QFreeBlock * volatile next;
@@ -51,8 +51,13 @@ Q_DEFINE_THIS_MODULE("qf_ps")
 
 
 /* Package-scope objects ****************************************************/
+#ifndef QF_MAX_DOMAIN
 QSubscrList *QF_subscrList_;
 enum_t QF_maxPubSignal_;
+#else
+QSubscrList *QF_domainSubscrList_[QF_MAX_DOMAIN];
+enum_t QF_domainMaxPubSignal_[QF_MAX_DOMAIN];
+#endif
 
 /****************************************************************************/
 /**
@@ -50,8 +50,21 @@
 Q_DEFINE_THIS_MODULE("qf_time")
 
 /* Package-scope objects ****************************************************/
+#ifndef QF_MAX_DOMAIN
 QTimeEvt QF_timeEvtHead_[QF_MAX_TICK_RATE]; /* heads of time event lists */
+#else
+QTimeEvt QF_domainTimeEvtHead_[QF_MAX_DOMAIN][QF_MAX_TICK_RATE];
+#endif
+
+#ifdef QF_TIMEEVT_SLACK
+static QTimeEvtCtr QTimeEvt_align_(QTimeEvt * const me,
+                                   QTimeEvtCtr const nTicks,
+                                   uint_fast8_t const tickRate);
+static QTimeEvtCtr QTimeEvt_reload_(QTimeEvt * const me,
+                                    uint_fast8_t const tickRate);
+#endif
 
+#ifndef QF_TIMEEVT_SOA /* linked lists of time events */
 /****************************************************************************/
 /**
 * @description
@@ -78,10 +91,14 @@ void QF_tickX_(uint_fast8_t const tickRate, void const * const sender)
     QTimeEvt *prev = &QF_timeEvtHead_[tickRate];
     QF_CRIT_STAT_
 
+    QF_TICK_HOOK_(tickRate); /* e.g., measure the tick jitter */
+
     QF_CRIT_ENTRY_();
 
+    ++prev->ctr; /* count the ticks at this rate, see NOTE2 */
+
     QS_BEGIN_NOCRIT_(QS_QF_TICK, (void *)0, (void *)0)
-        QS_TEC_((QTimeEvtCtr)(++prev->ctr)); /* tick ctr */
+        QS_TEC_(prev->ctr);                  /* tick ctr */
         QS_U8_((uint8_t)tickRate);           /* tick rate */
     QS_END_NOCRIT_()
 
@@ -125,7 +142,12 @@ void QF_tickX_(uint_fast8_t const tickRate, void const * const sender)
 
                 /* periodic time evt? */
                 if (t->interval != (QTimeEvtCtr)0) {
+#ifdef QF_TIMEEVT_SLACK
+                    /* rearm the time event (with the slack, if any) */
+                    t->ctr = QTimeEvt_reload_(t, tickRate);
+#else
                     t->ctr = t->interval; /* rearm the time event */
+#endif
                     prev = t; /* advance to this time event */
                 }
                 /* one-shot time event: automatically disarm */
@@ -152,6 +174,7 @@ void QF_tickX_(uint_fast8_t const tickRate, void const * const sender)
 
                 QF_CRIT_EXIT_(); /* exit critical section before posting */
 
+                QF_TIMEEVT_POST_HOOK_(t);
                 /* QACTIVE_POST() asserts internally if the queue overflows */
                 QACTIVE_POST(act, &t->super, sender);
             }
@@ -178,6 +201,19 @@ void QF_tickX_(uint_fast8_t const tickRate, void const * const sender)
 * The QF_CRIT_EXIT_NOP() macro contains minimal code required
 * to prevent such merging of critical sections in QF ports,
 * in which it can occur.
+*
+* NOTE2:
+* The counter of the list head of every tick rate counts the ticks at this
+* rate. A time event armed with the counter at N for nTicks expires in the
+* tick when the counter reaches N + nTicks. With timer slack, the expiry
+* is postponed to the tick within [N + nTicks, N + nTicks + slack], which
+* is a multiple of the largest power of 2 that fits into the slack. So,
+* time events with comparable slack expire in the same ticks and their
+* events are posted in one batch, instead of each of them in a different
+* tick. Time events with zero slack are not affected. A periodic time event
+* is re-loaded for the tick of its requested expiry plus the interval (not
+* from the tick it actually expired in), so every expiry is at most slack
+* ticks late against the nominal schedule.
 */
 
 
@@ -210,6 +246,7 @@ bool QF_noTimeEvtsActiveX(uint_fast8_t const tickRate) {
     }
     return inactive;
 }
+#endif /* QF_TIMEEVT_SOA */
 
 /****************************************************************************/
 /**
@@ -235,9 +272,17 @@ void QTimeEvt_ctorX(QTimeEvt * const me, QActive * const act,
     Q_REQUIRE_ID(300, (sig >= (enum_t)Q_USER_SIG)
         && (tickRate < (uint_fast8_t)QF_MAX_TICK_RATE));
 
+#ifdef QF_TIMEEVT_SOA
+    me->slot      = (uint16_t)0;
+#else
     me->next      = (QTimeEvt *)0;
+#endif
     me->ctr       = (QTimeEvtCtr)0;
     me->interval  = (QTimeEvtCtr)0;
+#ifdef QF_TIMEEVT_SLACK
+    me->slack     = (QTimeEvtCtr)0;
+    me->due       = (QTimeEvtCtr)0;
+#endif
     me->super.sig = (QSignal)sig;
 
     /* For backwards compatibility with QTimeEvt_ctor(), the active object
@@ -262,6 +307,7 @@ void QTimeEvt_ctorX(QTimeEvt * const me, QActive * const act,
     me->super.refCtr_ = (uint8_t)tickRate;
 }
 
+#ifndef QF_TIMEEVT_SOA /* linked lists of time events */
 /****************************************************************************/
 /**
 * @description
@@ -306,7 +352,11 @@ void QTimeEvt_armX(QTimeEvt * const me,
                       && (me->super.sig >= (QSignal)Q_USER_SIG));
 
     QF_CRIT_ENTRY_();
+#ifdef QF_TIMEEVT_SLACK
+    me->ctr = QTimeEvt_align_(me, nTicks, tickRate);
+#else
     me->ctr = nTicks;
+#endif
     me->interval = interval;
 
     /* is the time event unlinked?
@@ -462,7 +512,12 @@ bool QTimeEvt_rearm(QTimeEvt * const me, QTimeEvtCtr const nTicks) {
     else {
         isArmed = true;
     }
+#ifdef QF_TIMEEVT_SLACK
+    /* re-load the tick counter (shift the phasing) */
+    me->ctr = QTimeEvt_align_(me, nTicks, tickRate);
+#else
     me->ctr = nTicks; /* re-load the tick counter (shift the phasing) */
+#endif
 
     QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_REARM, QS_priv_.teObjFilter, me)
         QS_TIME_();            /* timestamp */
@@ -511,3 +566,437 @@ QTimeEvtCtr QTimeEvt_ctr(QTimeEvt const * const me) {
     QF_CRIT_EXIT_();
     return ret;
 }
+#endif /* QF_TIMEEVT_SOA */
+
+#ifdef QF_TIMEEVT_SOA /* arrays of armed time events, see NOTE3 */
+/****************************************************************************/
+/*! armed time events of one tick rate in the "structure of arrays" layout */
+typedef struct {
+    QTimeEvtCtr ctr[QF_TIMEEVT_SOA_MAX]; /*!< down-counters of time events */
+    QTimeEvt   *te[QF_TIMEEVT_SOA_MAX];  /*!< the armed time events */
+    uint_fast16_t n;                     /*!< number of armed time events */
+} QTimeEvtArr;
+
+#ifndef QF_MAX_DOMAIN
+static QTimeEvtArr l_timeEvtArr[QF_MAX_TICK_RATE];
+#else
+static QTimeEvtArr l_domainTimeEvtArr[QF_MAX_DOMAIN][QF_MAX_TICK_RATE];
+#define l_timeEvtArr (l_domainTimeEvtArr[QF_DOMAIN_ID_()])
+#endif
+
+static void QTimeEvtArr_append_(QTimeEvtArr * const arr, QTimeEvt * const te,
+                                QTimeEvtCtr const ctr);
+static void QTimeEvtArr_remove_(QTimeEvtArr * const arr,
+                                uint_fast16_t const i);
+
+/****************************************************************************/
+#ifndef Q_SPY
+void QF_tickX_(uint_fast8_t const tickRate)
+#else
+void QF_tickX_(uint_fast8_t const tickRate, void const * const sender)
+#endif
+{
+    QTimeEvtArr * const arr = &l_timeEvtArr[tickRate];
+    QTimeEvt *fired[QF_TIMEEVT_SOA_MAX]; /* time events expired in this tick */
+    uint_fast16_t nFired = (uint_fast16_t)0;
+    uint_fast16_t i;
+    QF_CRIT_STAT_
+
+    QF_TICK_HOOK_(tickRate); /* e.g., measure the tick jitter */
+
+    QF_CRIT_ENTRY_();
+
+    ++QF_timeEvtHead_[tickRate].ctr; /* count the ticks at this rate */
+
+    QS_BEGIN_NOCRIT_(QS_QF_TICK, (void *)0, (void *)0)
+        QS_TEC_(QF_timeEvtHead_[tickRate].ctr); /* tick ctr */
+        QS_U8_((uint8_t)tickRate);              /* tick rate */
+    QS_END_NOCRIT_()
+
+    /* decrement all armed down-counters in one tight pass, see NOTE3 */
+    for (i = (uint_fast16_t)0; i < arr->n; ++i) {
+        --arr->ctr[i];
+    }
+
+    /* collect the expired time events... */
+    i = (uint_fast16_t)0;
+    while (i < arr->n) {
+        if (arr->ctr[i] == (QTimeEvtCtr)0) {
+            QTimeEvt * const t = arr->te[i];
+
+            fired[nFired] = t;
+            ++nFired;
+
+            QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_POST, QS_priv_.teObjFilter, t)
+                QS_TIME_();                /* timestamp */
+                QS_OBJ_(t);                /* the time event object */
+                QS_SIG_(t->super.sig);     /* signal of this time event */
+                QS_OBJ_(t->act);           /* the target AO */
+                QS_U8_((uint8_t)tickRate); /* tick rate */
+            QS_END_NOCRIT_()
+
+            /* periodic time evt? */
+            if (t->interval != (QTimeEvtCtr)0) {
+#ifdef QF_TIMEEVT_SLACK
+                /* rearm the time event (with the slack, if any) */
+                arr->ctr[i] = QTimeEvt_reload_(t, tickRate);
+#else
+                arr->ctr[i] = t->interval; /* rearm the time event */
+#endif
+                ++i;
+            }
+            /* one-shot time event: automatically disarm */
+            else {
+                QTimeEvtArr_remove_(arr, i);
+                /* do NOT advance i, the last entry has been moved here */
+
+                QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_AUTO_DISARM,
+                                 QS_priv_.teObjFilter, t)
+                    QS_OBJ_(t);                /* this time event object */
+                    QS_OBJ_(t->act);           /* the target AO */
+                    QS_U8_((uint8_t)tickRate); /* tick rate */
+                QS_END_NOCRIT_()
+            }
+        }
+        else {
+            ++i;
+        }
+    }
+    QF_CRIT_EXIT_();
+
+    /* post the expired time events outside the critical section */
+    for (i = (uint_fast16_t)0; i < nFired; ++i) {
+        QF_TIMEEVT_POST_HOOK_(fired[i]);
+        /* QACTIVE_POST() asserts internally if the queue overflows */
+        QACTIVE_POST((QActive *)fired[i]->act, &fired[i]->super, sender);
+    }
+}
+
+/*****************************************************************************
+* NOTE3:
+* With QF_TIMEEVT_SOA defined, the armed time events of every tick rate are
+* kept in a fixed array instead of the linked list. The down-counters are
+* stored contiguously, separately from the time event objects, so the
+* per-tick pass touches a single dense array of counters (which compilers
+* readily vectorize) instead of chasing a pointer into a different cache
+* line for every armed time event. The time event objects themselves are
+* touched only when they expire.
+*
+* An armed time event stores its index in the array in the 'slot' member.
+* Disarming removes the time event immediately, by moving the last entry
+* into the vacated slot, so in this layout a time event is armed if and only
+* if it is linked (bit 7 of refCtr_ set). The whole tick is processed in a
+* single critical section, which is bounded by QF_TIMEEVT_SOA_MAX, and the
+* expired time events are posted after exiting the critical section.
+*/
+
+/****************************************************************************/
+/*! @description See the linked-list version of QF_noTimeEvtsActiveX() */
+bool QF_noTimeEvtsActiveX(uint_fast8_t const tickRate) {
+
+    /*! @pre the tick rate must be in range */
+    Q_REQUIRE_ID(200, tickRate < (uint_fast8_t)QF_MAX_TICK_RATE);
+
+    return l_timeEvtArr[tickRate].n == (uint_fast16_t)0;
+}
+
+/****************************************************************************/
+/*! @description See the linked-list version of QTimeEvt_armX() */
+void QTimeEvt_armX(QTimeEvt * const me,
+                   QTimeEvtCtr const nTicks, QTimeEvtCtr const interval)
+{
+    uint_fast8_t tickRate = (uint_fast8_t)me->super.refCtr_
+                                & (uint_fast8_t)0x7F;
+    QF_CRIT_STAT_
+
+    /** @pre the host AO must be valid, time evnet must be disarmed,
+    * number of clock ticks cannot be zero, and the signal must be valid.
+    */
+    Q_REQUIRE_ID(400, (me->act != (void *)0)
+                      && ((me->super.refCtr_ & (uint8_t)0x80) == (uint8_t)0)
+                      && (nTicks != (QTimeEvtCtr)0)
+                      && (tickRate < (uint_fast8_t)QF_MAX_TICK_RATE)
+                      && (me->super.sig >= (QSignal)Q_USER_SIG));
+
+    QF_CRIT_ENTRY_();
+    me->interval = interval;
+#ifdef QF_TIMEEVT_SLACK
+    QTimeEvtArr_append_(&l_timeEvtArr[tickRate], me,
+                        QTimeEvt_align_(me, nTicks, tickRate));
+#else
+    QTimeEvtArr_append_(&l_timeEvtArr[tickRate], me, nTicks);
+#endif
+
+    QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_ARM, QS_priv_.teObjFilter, me)
+        QS_TIME_();                /* timestamp */
+        QS_OBJ_(me);               /* this time event object */
+        QS_OBJ_(me->act);          /* the active object */
+        QS_TEC_(nTicks);           /* the number of ticks */
+        QS_TEC_(interval);         /* the interval */
+        QS_U8_((uint8_t)tickRate); /* tick rate */
+    QS_END_NOCRIT_()
+
+    QF_CRIT_EXIT_();
+}
+
+/****************************************************************************/
+/*! @description See the linked-list version of QTimeEvt_disarm() */
+bool QTimeEvt_disarm(QTimeEvt * const me) {
+    uint_fast8_t tickRate = (uint_fast8_t)me->super.refCtr_
+                            & (uint_fast8_t)0x7F;
+    bool wasArmed;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+
+    /* is the time evt running? */
+    if ((me->super.refCtr_ & (uint8_t)0x80) != (uint8_t)0) {
+        wasArmed = true;
+
+        QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_DISARM, QS_priv_.teObjFilter, me)
+            QS_TIME_();            /* timestamp */
+            QS_OBJ_(me);           /* this time event object */
+            QS_OBJ_(me->act);      /* the target AO */
+            QS_TEC_(l_timeEvtArr[tickRate].ctr[me->slot]); /* # ticks */
+            QS_TEC_(me->interval); /* the interval */
+            QS_U8_((uint8_t)tickRate); /* tick rate */
+        QS_END_NOCRIT_()
+
+        QTimeEvtArr_remove_(&l_timeEvtArr[tickRate],
+                            (uint_fast16_t)me->slot);
+    }
+    /* the time event was already not running */
+    else {
+        wasArmed = false;
+
+        QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_DISARM_ATTEMPT,
+                         QS_priv_.teObjFilter, me)
+            QS_TIME_();            /* timestamp */
+            QS_OBJ_(me);           /* this time event object */
+            QS_OBJ_(me->act);      /* the target AO */
+            QS_U8_((uint8_t)tickRate); /* tick rate */
+        QS_END_NOCRIT_()
+
+    }
+    QF_CRIT_EXIT_();
+    return wasArmed;
+}
+
+/****************************************************************************/
+/*! @description See the linked-list version of QTimeEvt_rearm() */
+bool QTimeEvt_rearm(QTimeEvt * const me, QTimeEvtCtr const nTicks) {
+    uint_fast8_t tickRate = (uint_fast8_t)me->super.refCtr_
+                            & (uint_fast8_t)0x7F;
+    QTimeEvtCtr ctr;
+    bool isArmed;
+    QF_CRIT_STAT_
+
+    /** @pre AO must be valid, tick rate must be in range, nTicks must not
+    * be zero, and the signal of this time event must be valid
+    */
+    Q_REQUIRE_ID(600, (me->act != (void *)0)
+                      && (tickRate < (uint_fast8_t)QF_MAX_TICK_RATE)
+                      && (nTicks != (QTimeEvtCtr)0)
+                      && (me->super.sig >= (QSignal)Q_USER_SIG));
+
+    QF_CRIT_ENTRY_();
+#ifdef QF_TIMEEVT_SLACK
+    ctr = QTimeEvt_align_(me, nTicks, tickRate);
+#else
+    ctr = nTicks;
+#endif
+
+    /* is the time evt not running? */
+    if ((me->super.refCtr_ & (uint8_t)0x80) == (uint8_t)0) {
+        isArmed = false;
+        QTimeEvtArr_append_(&l_timeEvtArr[tickRate], me, ctr);
+    }
+    /* the time event is armed */
+    else {
+        isArmed = true;
+        /* re-load the tick counter (shift the phasing) */
+        l_timeEvtArr[tickRate].ctr[me->slot] = ctr;
+    }
+
+    QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_REARM, QS_priv_.teObjFilter, me)
+        QS_TIME_();            /* timestamp */
+        QS_OBJ_(me);           /* this time event object */
+        QS_OBJ_(me->act);      /* the target AO */
+        QS_TEC_(ctr);          /* the number of ticks */
+        QS_TEC_(me->interval); /* the interval */
+        QS_2U8_((uint8_t)tickRate,
+                ((isArmed != false) ? (uint8_t)1 : (uint8_t)0));
+    QS_END_NOCRIT_()
+
+    QF_CRIT_EXIT_();
+    return isArmed;
+}
+
+/****************************************************************************/
+/*! @description See the linked-list version of QTimeEvt_ctr() */
+QTimeEvtCtr QTimeEvt_ctr(QTimeEvt const * const me) {
+    uint_fast8_t tickRate = (uint_fast8_t)me->super.refCtr_
+                            & (uint_fast8_t)0x7F;
+    QTimeEvtCtr ret;
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    if ((me->super.refCtr_ & (uint8_t)0x80) != (uint8_t)0) {
+        ret = l_timeEvtArr[tickRate].ctr[me->slot];
+    }
+    else {
+        ret = (QTimeEvtCtr)0;
+    }
+
+    QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_CTR, QS_priv_.teObjFilter, me)
+        QS_TIME_();              /* timestamp */
+        QS_OBJ_(me);             /* this time event object */
+        QS_OBJ_(me->act);        /* the target AO */
+        QS_TEC_(ret);            /* the current counter */
+        QS_TEC_(me->interval);   /* the interval */
+        QS_U8_((uint8_t)tickRate); /* tick rate */
+    QS_END_NOCRIT_()
+
+    QF_CRIT_EXIT_();
+    return ret;
+}
+
+/****************************************************************************/
+/*! append a time event to the array (must be called in critical section) */
+static void QTimeEvtArr_append_(QTimeEvtArr * const arr, QTimeEvt * const te,
+                                QTimeEvtCtr const ctr)
+{
+    uint_fast16_t const n = arr->n;
+
+    /* the array of armed time events must not overflow */
+    Q_ASSERT_ID(710, n < (uint_fast16_t)QF_TIMEEVT_SOA_MAX);
+
+    arr->ctr[n] = ctr;
+    arr->te[n]  = te;
+    arr->n      = n + (uint_fast16_t)1;
+    te->slot    = (uint16_t)n;
+    te->super.refCtr_ |= (uint8_t)0x80; /* mark as linked (armed) */
+}
+
+/****************************************************************************/
+/*! remove a time event from the array (must be called in critical section) */
+static void QTimeEvtArr_remove_(QTimeEvtArr * const arr,
+                                uint_fast16_t const i)
+{
+    uint_fast16_t const last = arr->n - (uint_fast16_t)1;
+
+    arr->te[i]->super.refCtr_ &= (uint8_t)0x7F; /* mark as unlinked */
+
+    /* move the last entry into the vacated slot */
+    if (i != last) {
+        arr->ctr[i] = arr->ctr[last];
+        arr->te[i]  = arr->te[last];
+        arr->te[i]->slot = (uint16_t)i;
+    }
+    arr->n = last;
+}
+
+#endif /* QF_TIMEEVT_SOA */
+
+#ifdef QF_TIMEEVT_SLACK
+/****************************************************************************/
+/**
+* @description
+* Allows the time event to expire up to @p slack clock ticks later than
+* requested, so that QF can align its expiry with the expiries of other
+* time events (see NOTE2). For example, a timeout that tolerates +10%
+* of imprecision would set the slack to one tenth of its number of ticks.
+* The slack applies from the next arming, rearming, or periodic re-load
+* of the time event. The zero slack (default) keeps the exact expiry.
+*
+* @param[in,out] me     pointer (see @ref oop)
+* @param[in]     slack  number of clock ticks the time event may be late
+*/
+void QTimeEvt_setSlack(QTimeEvt * const me, QTimeEvtCtr const slack) {
+    QF_CRIT_STAT_
+
+    /** @pre the slack must be less than half of the counter range */
+    Q_REQUIRE_ID(800, slack < (QTimeEvtCtr)((QTimeEvtCtr)~(QTimeEvtCtr)0
+                                            >> 1));
+    QF_CRIT_ENTRY_();
+    me->slack = slack;
+    QF_CRIT_EXIT_();
+}
+
+/****************************************************************************/
+/**
+* @description
+* Computes the number of ticks to the aligned expiry of the time event
+* (see NOTE2). Must be called from a critical section.
+*/
+static QTimeEvtCtr QTimeEvt_align_(QTimeEvt * const me,
+                                   QTimeEvtCtr const nTicks,
+                                   uint_fast8_t const tickRate)
+{
+    QTimeEvtCtr n = nTicks;
+
+    /* the requested expiry, for the periodic re-load */
+    me->due = (QTimeEvtCtr)(QF_timeEvtHead_[tickRate].ctr + nTicks);
+
+    /* any slack and no overflow of the counter? */
+    if ((me->slack != (QTimeEvtCtr)0)
+        && (nTicks <= (QTimeEvtCtr)((QTimeEvtCtr)~(QTimeEvtCtr)0
+                                    - me->slack)))
+    {
+        QTimeEvtCtr const now = QF_timeEvtHead_[tickRate].ctr;
+        QTimeEvtCtr const first = (QTimeEvtCtr)(now + nTicks);
+        QTimeEvtCtr step = (QTimeEvtCtr)1;
+
+        /* the largest power of 2, which does not exceed (slack + 1) */
+        while ((QTimeEvtCtr)((QTimeEvtCtr)(step << 1) - (QTimeEvtCtr)1)
+               <= me->slack)
+        {
+            step = (QTimeEvtCtr)(step << 1);
+        }
+
+        /* round the expiry up to the multiple of the step */
+        n = (QTimeEvtCtr)((QTimeEvtCtr)((QTimeEvtCtr)(first + step
+                                                      - (QTimeEvtCtr)1)
+                          & (QTimeEvtCtr)~(QTimeEvtCtr)(step
+                                                        - (QTimeEvtCtr)1))
+                          - now);
+
+#ifdef QS_TIMEEVT_ALIGN /* the QS port provides the record? */
+        QS_BEGIN_NOCRIT(QS_TIMEEVT_ALIGN, me->act)
+            QS_OBJ(me);                   /* this time event object */
+            QS_OBJ(me->act);              /* the target AO */
+            QS_U32(0, nTicks);            /* the requested number of ticks */
+            QS_U32(0, n);                 /* the aligned number of ticks */
+            QS_U8(0, (uint8_t)tickRate);  /* tick rate */
+        QS_END_NOCRIT()
+#endif
+    }
+    return n;
+}
+
+/****************************************************************************/
+/**
+* @description
+* Computes the number of ticks to the next expiry of the periodic time
+* event, which has just expired, from its requested expiry (see NOTE2).
+* Must be called from a critical section.
+*/
+static QTimeEvtCtr QTimeEvt_reload_(QTimeEvt * const me,
+                                    uint_fast8_t const tickRate)
+{
+    /* the ticks the time event expired after its requested expiry */
+    QTimeEvtCtr const late = (QTimeEvtCtr)(QF_timeEvtHead_[tickRate].ctr
+                                           - me->due);
+    QTimeEvtCtr n;
+
+    /* the next requested expiry still ahead? */
+    if (late < me->interval) {
+        n = QTimeEvt_align_(me, (QTimeEvtCtr)(me->interval - late),
+                            tickRate);
+    }
+    else { /* the interval is shorter than the alignment, start over */
+        n = QTimeEvt_align_(me, me->interval, tickRate);
+    }
+    return n;
+}
+#endif /* QF_TIMEEVT_SLACK */
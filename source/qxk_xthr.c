@@ -52,6 +52,11 @@
     #error "Source file included in a project NOT based on the QXK kernel"
 #endif /* qxk_h */
 
+/* the blocking timeouts of extended threads link the time events directly */
+#ifdef QF_TIMEEVT_SOA
+    #error "QF_TIMEEVT_SOA is not supported with the QXK kernel"
+#endif /* QF_TIMEEVT_SOA */
+
 Q_DEFINE_THIS_MODULE("qxk_xthr")
 
 /****************************************************************************/